@@ -0,0 +1,671 @@
+/*******************************************************************************
+***  Benchmarks for the graph library
+***
+***  Usage:
+***     ./dist/bench_graph [benchmark] [scale] [edge factor] [csv|json]
+***
+***  benchmark:
+***     pagerank    PageRank iterations per second on an RMAT graph
+***     load        Time to save and reload an RMAT graph (mapped and rebuilt) and
+***                 the memory freed by shrinking the rebuilt graph to fit
+***     edgelist    Parse rate of an RMAT graph written as a text edge list
+***     insert      Edges added, then removed, per second from all threads at once
+***     msbfs       Hop distance sums from 256 sources; one BFS each vs multi-source
+***     path        Point to point queries; bidirectional search vs a full BFS
+***     compressed  Bytes per edge and BFS rate of the compressed adjacency vs the graph
+***     centrality  Betweenness from 256 sampled sources and closeness centrality
+***     mst         Minimum spanning forest using Kruskal and Boruvka
+***     cores       Triangles per vertex and core numbers of an RMAT graph
+***     bitmatrix   Bytes per edge, BFS rate and triangle count of a bit matrix on
+***                 a dense random graph (use a scale of 16 or less)
+***     partition   Label propagation into 16 parts of an RMAT graph, with the
+***                 edges cut and the balance, and the subgraph of one part
+***     log         Bytes and time to record 1% of the edges added and removed in
+***                 the change log vs saving a new snapshot, and replay time
+***     suite       Insert, remove, BFS and DFS rates and memory per edge for each
+***                 generator at scale - 4, scale - 2 and scale using 1, 2, 4, ...
+***                 threads; written as csv (default) or json
+***
+***  The graph has 2^scale vertices and edge factor * 2^scale edges. Compile
+***  using `make bench` (add CCFLAGS=-fopenmp to use threads)
+*******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined (_OPENMP)
+    #include <omp.h>
+#endif
+#include "../src/timing.h"
+#include "../src/graph.h"
+
+
+/* Private Functions */
+static unsigned long long __rand_next(unsigned long long* state);
+static void __bench_pagerank(unsigned int scale, unsigned int edge_factor);
+static void __bench_load(unsigned int scale, unsigned int edge_factor);
+static void __bench_edge_list(unsigned int scale, unsigned int edge_factor);
+static void __bench_insert(unsigned int scale, unsigned int edge_factor);
+static void __bench_msbfs(unsigned int scale, unsigned int edge_factor);
+static bool __sum_depth(vertex_t v, void* data);
+static void __bench_path(unsigned int scale, unsigned int edge_factor);
+static void __bench_compressed(unsigned int scale, unsigned int edge_factor);
+static void __bench_centrality(unsigned int scale, unsigned int edge_factor);
+static void __bench_mst(unsigned int scale, unsigned int edge_factor);
+static void __bench_cores(unsigned int scale, unsigned int edge_factor);
+static void __bench_bitmatrix(unsigned int scale, unsigned int edge_factor);
+static void __bench_partition(unsigned int scale, unsigned int edge_factor);
+static void __bench_log(unsigned int scale, unsigned int edge_factor);
+static void __bench_suite(unsigned int scale, unsigned int edge_factor, bool json);
+static void __suite_run(const char* name, graph_t gen, int threads, bool json, bool* first);
+static bool __sum_out_degree(vertex_t v, void* data);
+
+
+int main(int argc, char const *argv[]) {
+    const char* benchmark = (argc > 1) ? argv[1] : "pagerank";
+    unsigned int scale = (argc > 2) ? (unsigned int)atoi(argv[2]) : 18;
+    unsigned int edge_factor = (argc > 3) ? (unsigned int)atoi(argv[3]) : 16;
+
+    if (strcmp(benchmark, "suite") == 0) {
+        __bench_suite(scale, edge_factor, argc > 4 && strcmp(argv[4], "json") == 0);
+        return 0;
+    }
+
+    #if defined (_OPENMP)
+        printf("threads: %d\n", omp_get_max_threads());
+    #else
+        printf("threads: 1\n");
+    #endif
+
+    if (strcmp(benchmark, "pagerank") == 0) {
+        __bench_pagerank(scale, edge_factor);
+    } else if (strcmp(benchmark, "load") == 0) {
+        __bench_load(scale, edge_factor);
+    } else if (strcmp(benchmark, "edgelist") == 0) {
+        __bench_edge_list(scale, edge_factor);
+    } else if (strcmp(benchmark, "insert") == 0) {
+        __bench_insert(scale, edge_factor);
+    } else if (strcmp(benchmark, "msbfs") == 0) {
+        __bench_msbfs(scale, edge_factor);
+    } else if (strcmp(benchmark, "path") == 0) {
+        __bench_path(scale, edge_factor);
+    } else if (strcmp(benchmark, "compressed") == 0) {
+        __bench_compressed(scale, edge_factor);
+    } else if (strcmp(benchmark, "centrality") == 0) {
+        __bench_centrality(scale, edge_factor);
+    } else if (strcmp(benchmark, "mst") == 0) {
+        __bench_mst(scale, edge_factor);
+    } else if (strcmp(benchmark, "cores") == 0) {
+        __bench_cores(scale, edge_factor);
+    } else if (strcmp(benchmark, "bitmatrix") == 0) {
+        __bench_bitmatrix(scale, edge_factor);
+    } else if (strcmp(benchmark, "partition") == 0) {
+        __bench_partition(scale, edge_factor);
+    } else if (strcmp(benchmark, "log") == 0) {
+        __bench_log(scale, edge_factor);
+    } else {
+        printf("Unknown benchmark: %s\n", benchmark);
+        return 1;
+    }
+    return 0;
+}
+
+
+static void __bench_pagerank(unsigned int scale, unsigned int edge_factor) {
+    Timing t;
+    timing_start(&t);
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    timing_end(&t);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges built in %f seconds\n", g_num_vertices(g), g_num_edges(g), t.timing_double);
+
+    timing_start(&t);
+    graph_csr_t c = g_csr_init(g);
+    timing_end(&t);
+    printf("frozen in %f seconds\n", t.timing_double);
+
+    unsigned int iterations;
+    timing_start(&t);
+    double* pr = g_csr_pagerank(c, 0.85, 1e-9, 100, &iterations);
+    timing_end(&t);
+    printf("pagerank: %u iterations in %f seconds; %f iterations/sec; %f edges/sec\n",
+        iterations, t.timing_double, iterations / t.timing_double,
+        ((double)iterations * g_csr_num_edges(c)) / t.timing_double);
+
+    free(pr);
+    g_csr_free(c);
+    g_free(g);
+}
+
+
+static void __bench_load(unsigned int scale, unsigned int edge_factor) {
+    const char* filename = "./bench_graph.bin";
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), g_num_edges(g));
+
+    timing_start(&t);
+    g_save(g, filename);
+    timing_end(&t);
+    printf("saved in %f seconds\n", t.timing_double);
+    g_free(g);
+
+    timing_start(&t);
+    graph_csr_t c = g_csr_load(filename);
+    timing_end(&t);
+    printf("mapped frozen graph in %f seconds\n", t.timing_double);
+    g_csr_free(c);
+
+    timing_start(&t);
+    g = g_load(filename);
+    timing_end(&t);
+    printf("rebuilt graph in %f seconds\n", t.timing_double);
+
+    graph_stats_t stats;
+    g_stats(g, &stats);
+    printf("memory: %zu bytes, %zu unused\n", stats.bytes_total, stats.bytes_wasted);
+    timing_start(&t);
+    size_t freed = g_shrink_to_fit(g);
+    timing_end(&t);
+    printf("shrunk by %zu bytes in %f seconds\n", freed, t.timing_double);
+    g_free(g);
+    remove(filename);
+}
+
+
+static void __bench_edge_list(unsigned int scale, unsigned int edge_factor) {
+    const char* filename = "./bench_graph.txt";
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), g_num_edges(g));
+
+    FILE* fp = fopen(filename, "w");
+    unsigned int i;
+    fprintf(fp, "# rmat scale %u, edge factor %u\n", scale, edge_factor);
+    for (i = 0; i < g_num_edges(g); ++i) {
+        edge_t e = g_edge_get(g, i);
+        fprintf(fp, GRAPH_ID_FORMAT "\t" GRAPH_ID_FORMAT "\t%.3f\n", g_edge_src(e), g_edge_dest(e), 1.0 + (i % 1000) / 1000.0);
+    }
+    long bytes = ftell(fp);
+    fclose(fp);
+    g_free(g);
+
+    double* weights;
+    timing_start(&t);
+    g = g_load_edge_list(filename, NULL, &weights);
+    timing_end(&t);
+    printf("parsed " GRAPH_ID_FORMAT " edges in %f seconds; %f MB/sec; %f edges/sec\n", g_num_edges(g), t.timing_double,
+        (bytes / (1024.0 * 1024.0)) / t.timing_double, g_num_edges(g) / t.timing_double);
+
+    free(weights);
+    g_free(g);
+    remove(filename);
+}
+
+
+static void __bench_insert(unsigned int scale, unsigned int edge_factor) {
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t n = g_num_vertices(g), m = g_num_edges(g);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", n, m);
+
+    /* replay the same edges, skewed degrees and all, using single inserts */
+    graph_id_t* src = (graph_id_t*)malloc(m * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc(m * sizeof(graph_id_t));
+    int i;
+    for (i = 0; i < (int)m; ++i) {
+        edge_t e = g_edge_get(g, i);
+        src[i] = g_edge_src(e);
+        dest[i] = g_edge_dest(e);
+    }
+    g_free(g);
+
+    g = g_init();  /* start small to include growing the edge table */
+    for (i = 0; i < (int)n; ++i)
+        g_vertex_add(g, NULL);
+
+    timing_start(&t);
+    #pragma omp parallel for schedule(static, 1024)
+    for (i = 0; i < (int)m; ++i)
+        g_edge_add(g, src[i], dest[i], NULL);
+    timing_end(&t);
+    printf("inserted " GRAPH_ID_FORMAT " edges in %f seconds; %f edges/sec\n", g_num_edges(g), t.timing_double, m / t.timing_double);
+
+    timing_start(&t);
+    #pragma omp parallel for schedule(static, 1024)
+    for (i = 0; i < (int)m; i += 2) {
+        edge_t e = g_edge_remove(g, i);
+        if (e != NULL)
+            g_edge_free(e);
+    }
+    timing_end(&t);
+    printf("removed half in %f seconds; %f edges/sec\n", t.timing_double, (m / 2) / t.timing_double);
+
+    free(src);
+    free(dest);
+    g_free(g);
+}
+
+
+static void __bench_msbfs(unsigned int scale, unsigned int edge_factor) {
+    const unsigned int num_sources = 256;
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), g_num_edges(g));
+
+    graph_id_t sources[256];
+    unsigned int i;
+    unsigned long long state = 99, sums[256], total = 0;
+    for (i = 0; i < num_sources; ++i)
+        sources[i] = (graph_id_t)(__rand_next(&state) % g_num_vertices(g));
+
+    /*  one search per source; the callback only counts the vertices since
+        the traversal does not track the depth */
+    graph_workspace_t w = g_workspace_init(g);
+    timing_start(&t);
+    for (i = 0; i < num_sources; ++i)
+        g_breadth_first_visit(g, g_vertex_get(g, sources[i]), w, __sum_depth, &total);
+    timing_end(&t);
+    printf("single source: %u searches in %f seconds; %f searches/sec\n", num_sources, t.timing_double, num_sources / t.timing_double);
+    g_workspace_free(w);
+
+    timing_start(&t);
+    g_multi_source_bfs_sums(g, sources, num_sources, sums, NULL);
+    timing_end(&t);
+    printf("multi source: %u searches in %f seconds; %f searches/sec\n", num_sources, t.timing_double, num_sources / t.timing_double);
+
+    g_free(g);
+}
+
+static bool __sum_depth(vertex_t v, void* data) {
+    (void)v;
+    ++*(unsigned long long*)data;
+    return true;
+}
+
+static void __bench_path(unsigned int scale, unsigned int edge_factor) {
+    const unsigned int num_queries = 1000;
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), g_num_edges(g));
+
+    graph_id_t len;
+    unsigned int i, found = 0;
+    unsigned long long state = 99, total = 0, visited = 0;
+    graph_workspace_t w = g_workspace_init(g);
+    timing_start(&t);
+    for (i = 0; i < num_queries; ++i) {
+        graph_id_t src = (graph_id_t)(__rand_next(&state) % g_num_vertices(g));
+        graph_id_t dst = (graph_id_t)(__rand_next(&state) % g_num_vertices(g));
+        graph_id_t* path = g_shortest_path_alt(g, src, dst, w, &len);
+        found += (path != NULL);
+        total += len;
+        free(path);
+    }
+    timing_end(&t);
+    printf("bidirectional: %u queries (%u found, %f average length) in %f seconds; %f queries/sec\n", num_queries, found, (found == 0) ? 0.0 : (double)total / found, t.timing_double, num_queries / t.timing_double);
+
+    /* a full search from each source for comparison */
+    state = 99;
+    timing_start(&t);
+    for (i = 0; i < num_queries; ++i) {
+        graph_id_t src = (graph_id_t)(__rand_next(&state) % g_num_vertices(g));
+        __rand_next(&state);
+        g_breadth_first_visit(g, g_vertex_get(g, src), w, __sum_depth, &visited);
+    }
+    timing_end(&t);
+    printf("full bfs: %u queries in %f seconds; %f queries/sec\n", num_queries, t.timing_double, num_queries / t.timing_double);
+
+    g_workspace_free(w);
+    g_free(g);
+}
+
+
+static void __bench_compressed(unsigned int scale, unsigned int edge_factor) {
+    const unsigned int num_searches = 16;
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t m = g_num_edges(g), n = g_num_vertices(g), i;
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges; %f bytes per edge\n", n, m, (double)g_memory_usage(g) / m);
+
+    timing_start(&t);
+    graph_compressed_t c = g_compressed_init(g);
+    timing_end(&t);
+    printf("compressed in %f seconds; %f bytes per edge\n", t.timing_double, (double)g_compressed_memory_usage(c) / m);
+
+    graph_id_t* res = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_workspace_t w = g_workspace_init(g);
+    unsigned long long state = 99, visited = 0;
+    timing_start(&t);
+    for (i = 0; i < num_searches; ++i)
+        visited += g_breadth_first_traverse_alt(g, g_vertex_get(g, (graph_id_t)(__rand_next(&state) % n)), w, res, n);
+    timing_end(&t);
+    printf("graph bfs: %f edges/sec (%llu visited)\n", (double)m * num_searches / t.timing_double, visited);
+
+    state = 99;
+    visited = 0;
+    timing_start(&t);
+    for (i = 0; i < num_searches; ++i)
+        visited += g_compressed_breadth_first_traverse(c, (graph_id_t)(__rand_next(&state) % n), w, res, n);
+    timing_end(&t);
+    printf("compressed bfs: %f edges/sec (%llu visited)\n", (double)m * num_searches / t.timing_double, visited);
+
+    g_workspace_free(w);
+    free(res);
+    g_compressed_free(c);
+    g_free(g);
+}
+
+static void __bench_centrality(unsigned int scale, unsigned int edge_factor) {
+    const unsigned int num_samples = 256;
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), g_num_edges(g));
+
+    timing_start(&t);
+    double* bc = g_betweenness_centrality(g, num_samples, 99);
+    timing_end(&t);
+    printf("betweenness: %u sources in %f seconds; %f sources/sec\n", num_samples, t.timing_double, num_samples / t.timing_double);
+    free(bc);
+
+    timing_start(&t);
+    double* cc = g_closeness_centrality(g);
+    timing_end(&t);
+    printf("closeness: " GRAPH_ID_FORMAT " sources in %f seconds; %f sources/sec\n", g_num_vertices(g), t.timing_double, g_num_vertices(g) / t.timing_double);
+    free(cc);
+    g_free(g);
+}
+
+static void __bench_mst(unsigned int scale, unsigned int edge_factor) {
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t m = g_num_edges(g), i, num;
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), m);
+
+    double* weights = (double*)malloc(m * sizeof(double));
+    unsigned long long state = 99;
+    for (i = 0; i < m; ++i)
+        weights[i] = (double)(__rand_next(&state) % 1000);
+
+    double total;
+    timing_start(&t);
+    graph_id_t* ids = g_kruskal_alt(g, weights, &num, &total);
+    timing_end(&t);
+    printf("kruskal: " GRAPH_ID_FORMAT " edges, weight %.0f, in %f seconds\n", num, total, t.timing_double);
+    free(ids);
+
+    timing_start(&t);
+    ids = g_boruvka_alt(g, weights, &num, &total);
+    timing_end(&t);
+    printf("boruvka: " GRAPH_ID_FORMAT " edges, weight %.0f, in %f seconds\n", num, total, t.timing_double);
+    free(ids);
+
+    free(weights);
+    g_free(g);
+}
+
+static void __bench_cores(unsigned int scale, unsigned int edge_factor) {
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t m = g_num_edges(g);
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", g_num_vertices(g), m);
+
+    unsigned long long total;
+    timing_start(&t);
+    unsigned long long* counts = g_triangles(g, &total);
+    timing_end(&t);
+    printf("triangles: %llu in %f seconds; %f edges/sec\n", total, t.timing_double, m / t.timing_double);
+    free(counts);
+
+    unsigned int max_core;
+    timing_start(&t);
+    unsigned int* core = g_core_numbers(g, &max_core);
+    timing_end(&t);
+    printf("cores: max core %u in %f seconds; %f edges/sec\n", max_core, t.timing_double, m / t.timing_double);
+    free(core);
+    g_free(g);
+}
+
+static void __bench_bitmatrix(unsigned int scale, unsigned int edge_factor) {
+    const unsigned int num_searches = 16;
+    Timing t;
+    unsigned int n = 1u << scale, i;
+    graph_t g = g_generate_erdos_renyi(n, edge_factor * n, 12345);
+    unsigned int m = g_num_edges(g);
+    printf("erdos-renyi graph: %u vertices, %u edges; %f bytes per edge\n", n, m, (double)g_memory_usage(g) / m);
+
+    timing_start(&t);
+    graph_bitmatrix_t b = g_bitmatrix_init(g, false);
+    timing_end(&t);
+    if (b == NULL) {
+        printf("too many vertices for a bit matrix\n");
+        g_free(g);
+        return;
+    }
+    printf("bit matrix in %f seconds; %f bytes per edge\n", t.timing_double, (double)g_bitmatrix_memory_usage(b) / m);
+
+    graph_id_t* res = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_workspace_t w = g_workspace_init(g);
+    unsigned long long state = 99, visited = 0;
+    timing_start(&t);
+    for (i = 0; i < num_searches; ++i)
+        visited += g_breadth_first_traverse_alt(g, g_vertex_get(g, (graph_id_t)(__rand_next(&state) % n)), w, res, n);
+    timing_end(&t);
+    printf("graph bfs: %f edges/sec (%llu visited)\n", (double)m * num_searches / t.timing_double, visited);
+
+    state = 99;
+    timing_start(&t);
+    for (i = 0; i < num_searches; ++i)
+        free(g_bitmatrix_bfs(b, (graph_id_t)(__rand_next(&state) % n)));
+    timing_end(&t);
+    printf("bit matrix bfs: %f edges/sec\n", (double)m * num_searches / t.timing_double);
+    g_workspace_free(w);
+    free(res);
+    g_bitmatrix_free(b);
+
+    b = g_bitmatrix_init(g, true);
+    timing_start(&t);
+    unsigned long long triangles = g_bitmatrix_triangles(b);
+    timing_end(&t);
+    printf("bit matrix triangles: %llu in %f seconds\n", triangles, t.timing_double);
+    g_bitmatrix_free(b);
+    g_free(g);
+}
+
+static void __bench_partition(unsigned int scale, unsigned int edge_factor) {
+    const graph_id_t num_parts = 16;
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t n = g_num_vertices(g), m = g_num_edges(g), i, num = 0;
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", n, m);
+
+    size_t cut;
+    double balance;
+    timing_start(&t);
+    graph_id_t* parts = g_partition(g, num_parts, &cut, &balance);
+    timing_end(&t);
+    printf("partition: " GRAPH_ID_FORMAT " parts in %f seconds; %f edges/sec\n", num_parts, t.timing_double, m / t.timing_double);
+    printf("    %f of the edges cut (%f dealing out the ids); balance %f\n", (double)cut / m, 1.0 - 1.0 / num_parts, balance);
+
+    graph_id_t* ids = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    for (i = 0; i < n; ++i) {
+        if (parts[i] == 0)
+            ids[num++] = i;
+    }
+    timing_start(&t);
+    graph_t sub = g_subgraph(g, ids, num);
+    timing_end(&t);
+    printf("subgraph of part 0: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges in %f seconds\n", g_num_vertices(sub), g_num_edges(sub), t.timing_double);
+    g_free_alt(sub, false);
+    free(ids);
+    free(parts);
+    g_free(g);
+}
+
+static void __bench_log(unsigned int scale, unsigned int edge_factor) {
+    const char* snapshot = "./bench_graph.bin";
+    const char* filename = "./bench_graph.log";
+    Timing t;
+    graph_t g = g_generate_rmat(scale, edge_factor, 12345);
+    graph_id_t n = g_num_vertices(g), m = g_num_edges(g), num = m / 100, i;
+    printf("rmat graph: " GRAPH_ID_FORMAT " vertices, " GRAPH_ID_FORMAT " edges\n", n, m);
+
+    timing_start(&t);
+    graph_log_t l = g_log_open(g, snapshot, filename);
+    timing_end(&t);
+    if (l == NULL) {
+        printf("unable to start the log\n");
+        g_free(g);
+        return;
+    }
+    printf("snapshot: %f seconds\n", t.timing_double);
+
+    /* add and remove 1% of the edges, half of the changes each */
+    unsigned long long state = 99;
+    timing_start(&t);
+    for (i = 0; i < num; ++i)
+        g_edge_add(g, (graph_id_t)(__rand_next(&state) % n), (graph_id_t)(__rand_next(&state) % n), NULL);
+    for (i = 0; i < num; ++i)
+        g_edge_free(g_edge_remove(g, (graph_id_t)(__rand_next(&state) % m)));
+    g_log_flush(l);
+    timing_end(&t);
+    size_t size = g_log_size(l);
+    printf("log: " GRAPH_ID_FORMAT " changes in %f seconds; %f bytes per change\n", 2 * num, t.timing_double, (double)size / (2 * num));
+    g_log_close(l);
+
+    timing_start(&t);
+    graph_t r = g_log_load(snapshot, filename);
+    timing_end(&t);
+    printf("load and replay: " GRAPH_ID_FORMAT " edges in %f seconds\n", g_num_edges(r), t.timing_double);
+    g_free(r);
+    g_free(g);
+    remove(snapshot);
+    remove(filename);
+}
+
+static void __bench_suite(unsigned int scale, unsigned int edge_factor, bool json) {
+    int max_threads = 1, threads;
+    #if defined (_OPENMP)
+        max_threads = omp_get_max_threads();
+    #endif
+
+    if (json)
+        printf("[\n");
+    else
+        printf("generator,vertices,edges,threads,vertex_inserts_per_sec,edge_inserts_per_sec,edge_removes_per_sec,bfs_edges_per_sec,dfs_edges_per_sec,bytes_per_edge\n");
+
+    bool first = true;
+    unsigned int s = (scale >= 8) ? scale - 4 : 4;
+    for (; s <= scale; s += 2) {
+        unsigned int n = 1u << s, side = 1u << (s / 2);
+        graph_t gens[4];
+        const char* names[4] = {"erdos_renyi", "rmat", "grid", "power_law"};
+        gens[0] = g_generate_erdos_renyi(n, n * edge_factor, 12345);
+        gens[1] = g_generate_rmat(s, edge_factor, 12345);
+        gens[2] = g_generate_grid(side, n / side);
+        gens[3] = g_generate_power_law(n, edge_factor, 12345);
+
+        int k;
+        for (k = 0; k < 4; ++k) {
+            for (threads = 1; threads <= max_threads; threads *= 2)
+                __suite_run(names[k], gens[k], threads, json, &first);
+            if (max_threads & (max_threads - 1))  /* not a power of 2 */
+                __suite_run(names[k], gens[k], max_threads, json, &first);
+            g_free(gens[k]);
+        }
+    }
+    if (json)
+        printf("\n]\n");
+}
+
+/*  replay the edges of the generated graph into a new graph, timing each step,
+    and print a row of the results */
+static void __suite_run(const char* name, graph_t gen, int threads, bool json, bool* first) {
+    #if defined (_OPENMP)
+        omp_set_num_threads(threads);
+    #endif
+    Timing t;
+    int n = (int)g_num_vertices(gen), m = (int)g_num_edges(gen), i;
+    graph_id_t* src = (graph_id_t*)malloc(m * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc(m * sizeof(graph_id_t));
+    for (i = 0; i < m; ++i) {
+        edge_t e = g_edge_get(gen, i);
+        src[i] = g_edge_src(e);
+        dest[i] = g_edge_dest(e);
+    }
+
+    graph_t g = g_init();
+    timing_start(&t);
+    #pragma omp parallel for schedule(static, 1024)
+    for (i = 0; i < n; ++i)
+        g_vertex_add_alt(g, i, NULL);
+    timing_end(&t);
+    double vertex_rate = n / t.timing_double;
+
+    timing_start(&t);
+    #pragma omp parallel for schedule(static, 1024)
+    for (i = 0; i < m; ++i)
+        g_edge_add(g, src[i], dest[i], NULL);
+    timing_end(&t);
+    double edge_rate = m / t.timing_double;
+    double bytes_per_edge = (double)g_memory_usage(g) / m;
+
+    /* a search from each of 16 vertices, spread over the threads */
+    double rates[2];
+    int d;
+    for (d = 0; d < 2; ++d) {
+        unsigned long long scanned = 0;
+        timing_start(&t);
+        #pragma omp parallel reduction(+:scanned)
+        {
+            graph_workspace_t w = g_workspace_init(g);
+            int j;
+            #pragma omp for schedule(dynamic, 1)
+            for (j = 0; j < 16; ++j) {
+                vertex_t v = g_vertex_get(g, (graph_id_t)(((unsigned long long)j * 2654435761u) % n));
+                if (d == 0)
+                    g_breadth_first_visit(g, v, w, __sum_out_degree, &scanned);
+                else
+                    g_depth_first_visit(g, v, w, __sum_out_degree, &scanned);
+            }
+            g_workspace_free(w);
+        }
+        timing_end(&t);
+        rates[d] = scanned / t.timing_double;
+    }
+
+    timing_start(&t);
+    #pragma omp parallel for schedule(static, 1024)
+    for (i = 0; i < m; ++i)
+        g_edge_free(g_edge_remove(g, i));
+    timing_end(&t);
+    double remove_rate = m / t.timing_double;
+
+    if (json) {
+        printf("%s  {\"generator\": \"%s\", \"vertices\": %d, \"edges\": %d, \"threads\": %d, "
+            "\"vertex_inserts_per_sec\": %.0f, \"edge_inserts_per_sec\": %.0f, \"edge_removes_per_sec\": %.0f, "
+            "\"bfs_edges_per_sec\": %.0f, \"dfs_edges_per_sec\": %.0f, \"bytes_per_edge\": %.2f}",
+            *first ? "" : ",\n", name, n, m, threads, vertex_rate, edge_rate, remove_rate, rates[0], rates[1], bytes_per_edge);
+    } else {
+        printf("%s,%d,%d,%d,%.0f,%.0f,%.0f,%.0f,%.0f,%.2f\n", name, n, m, threads, vertex_rate, edge_rate, remove_rate, rates[0], rates[1], bytes_per_edge);
+    }
+    fflush(stdout);
+    *first = false;
+
+    free(src);
+    free(dest);
+    g_free(g);
+}
+
+static bool __sum_out_degree(vertex_t v, void* data) {
+    *(unsigned long long*)data += g_vertex_num_edges_out(v);
+    return true;
+}
+
+/* xorshift64* */
+static unsigned long long __rand_next(unsigned long long* state) {
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
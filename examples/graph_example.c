@@ -38,7 +38,7 @@ int main(int argc, char const *argv[]) {
 
     graph_t g = g_init();
     vertex_t v;
-    unsigned int i;
+    graph_id_t i;
 
     /* add the vertices */
     __add_city_as_vertex(g, (char*)"New York", 40.7128, 74.0060);
@@ -72,19 +72,19 @@ int main(int argc, char const *argv[]) {
     __add_highway_as_edge(g, 6, 10, 735);   /* SLC - SF */
 
     printf("Breadth First Traverse; starting at New York: \n");
-    unsigned int size, len;
-    unsigned int* bfs = g_breadth_first_traverse(g, g_vertex_get(g, 0), &size);
-    unsigned int* dfs = g_depth_first_traverse(g, g_vertex_get(g, 0), &len);
-    printf("Size: %u\n", size);
+    graph_id_t size, len;
+    graph_id_t* bfs = g_breadth_first_traverse(g, g_vertex_get(g, 0), &size);
+    graph_id_t* dfs = g_depth_first_traverse(g, g_vertex_get(g, 0), &len);
+    printf("Size: " GRAPH_ID_FORMAT "\n", size);
     for (i = 0; i < size; i++) {
-        printf("%d, ", bfs[i]);
+        printf(GRAPH_ID_FORMAT ", ", bfs[i]);
     }
     printf("\n\n\n");
 
     printf("Depth First Traverse: starting from New York: \n");
-    printf("Size: %u\n", len);
+    printf("Size: " GRAPH_ID_FORMAT "\n", len);
     for (i = 0; i < size; i++) {
-        printf("%d, ", dfs[i]);
+        printf(GRAPH_ID_FORMAT ", ", dfs[i]);
     }
     printf("\n\n\n");
 
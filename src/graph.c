@@ -6,8 +6,20 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>         /* memcmp, memcpy, memset, strchr */
+#include <stdint.h>
+#include <math.h>           /* INFINITY */
 #include "graph.h"
 
+#if defined(__WIN32__) || defined(_WIN32) || defined(__WIN64__) || defined(_WIN64)
+    #define GRAPH_NO_MMAP
+#else
+    #include <sys/mman.h>   /* mmap */
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 
 #if defined (_OPENMP)
     #include <omp.h>  /* not sure this is actually needed! */
@@ -17,6 +29,14 @@
     #define ATOMIC_ADD_FETCH(i)     (__atomic_add_fetch(&(i), 1, __ATOMIC_SEQ_CST))
     #define ATOMIC_FETCH_ADD(i)     (__atomic_fetch_add(&(i), 1, __ATOMIC_SEQ_CST))
     #define ATOMIC_SUB_FETCH(i)     (__atomic_sub_fetch(&(i), 1, __ATOMIC_SEQ_CST))
+    #define ATOMIC_CAS(p, e, d)     (__atomic_compare_exchange((p), (e), (d), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    #define NUM_THREADS()           (omp_get_max_threads())
+    #define THREAD_NUM()            (omp_get_thread_num())
+    #define ATOMIC_LOAD(i)          (__atomic_load_n(&(i), __ATOMIC_ACQUIRE))
+    #define ATOMIC_READ(i, v)       (__atomic_load(&(i), &(v), __ATOMIC_ACQUIRE))
+    #define ATOMIC_STORE(i, v)      (__atomic_store_n(&(i), (v), __ATOMIC_RELEASE))
+    #define SPIN_LOCK(l)            while (__atomic_test_and_set(&(l), __ATOMIC_ACQUIRE)) { }
+    #define SPIN_UNLOCK(l)          (__atomic_clear(&(l), __ATOMIC_RELEASE))
 #else
     #define ATOMIC
     #define CRITICAL
@@ -24,40 +44,365 @@
     #define ATOMIC_ADD_FETCH(i)     (++(i))
     #define ATOMIC_FETCH_ADD(i)     ((i)++)
     #define ATOMIC_SUB_FETCH(i)     (--(i))
+    #define ATOMIC_CAS(p, e, d)     ((*(p) == *(e)) ? (*(p) = *(d), true) : (*(e) = *(p), false))
+    #define NUM_THREADS()           (1)
+    #define THREAD_NUM()            (0)
+    #define ATOMIC_LOAD(i)          (i)
+    #define ATOMIC_READ(i, v)       ((v) = (i))
+    #define ATOMIC_STORE(i, v)      ((i) = (v))
+    #define SPIN_LOCK(l)
+    #define SPIN_UNLOCK(l)
 #endif
 
-typedef struct __graph {
-    unsigned int num_verts;
-    unsigned int num_edges;
-    unsigned int _max_verts;
-    unsigned int _max_edges;
-    unsigned int _prev_vert_id;
-    unsigned int _prev_edge_id;
-    vertex_t* verts;
+/*  the vertex and edge tables are split into segments that double in size and
+    are never moved once allocated, so that growing them never invalidates what
+    another thread is reading or writing; 33 segments cover every 32 bit id and
+    64 every 64 bit one but GRAPH_INVALID_ID */
+#if defined (GRAPH_64BIT_IDS)
+    #define GRAPH_SEGMENTS 64
+#else
+    #define GRAPH_SEGMENTS 33
+#endif
+
+/* kinds of memory waiting for the readers that may see it to finish */
+#define RETIRED_BLOCK   0
+#define RETIRED_EDGE    1
+#define RETIRED_VERTEX  2
+
+/*  published, never modified copy of the edges of a vertex; the edges are in
+    the same allocation, right after the block */
+typedef struct __edge_block {
+    unsigned int num;
     edge_t* edges;
+} EdgeBlock;
+
+/* dense array of typed values indexed by vertex or edge id */
+typedef struct __prop_column {
+    char* name;
+    unsigned int type;      /* GRAPH_PROP_* */
+    size_t size;            /* number of values allocated */
+    void* values;
+} PropColumn;
+
+typedef struct __prop_list {
+    PropColumn* columns;
+    graph_id_t num;
+} PropList;
+
+typedef struct __retired {
+    void* ptr;
+    unsigned int kind;                  /* RETIRED_* */
+    bool free_metadata;
+    unsigned long long epoch;           /* global epoch when it was retired */
+} Retired;
+
+typedef struct __graph {
+    graph_id_t num_verts;
+    graph_id_t num_edges;
+    unsigned int _segment_shift;    /* the first segment holds 2^shift ids */
+    graph_id_t _prev_vert_id;
+    graph_id_t _prev_edge_id;
+    vertex_t* verts[GRAPH_SEGMENTS];
+    edge_t* edges[GRAPH_SEGMENTS];
+    unsigned int _index_mode;       /* GRAPH_EDGE_INDEX_* */
+    bool _index_lock;
+    size_t _index_size;             /* power of 2 */
+    size_t _index_count;
+    edge_t* _index;                 /* open addressing on (src, dest) */
+    bool _snapshots;                /* publish edge blocks for lock free readers */
+    bool _retire_lock;
+    unsigned long long _epoch;
+    unsigned long long _readers[GRAPH_MAX_READERS];  /* epoch pinned by each reader; 0 if free */
+    Retired* _retired;
+    size_t _num_retired;
+    size_t _max_retired;
+    PropList _vertex_props;
+    PropList _edge_props;
+    graph_log_t _log;               /* records the changes if not NULL */
 } Graph;
 
 typedef struct __vertex_node {
-    unsigned int id;
+    graph_id_t id;
     unsigned int num_edges_in;
     unsigned int num_edges_out;
     unsigned int _max_edges;
+    unsigned int _max_edges_in;
+    bool _lock;      /* guards edges and edges_in when adding and removing in parallel */
     void* metadata;  /* use this to hold name, other wanted information, etc */
     edge_t* edges;
+    edge_t* edges_in;
+    EdgeBlock* _snapshot;       /* the edges seen by readers when using snapshots */
+    EdgeBlock* _snapshot_in;
 } Vertex;
 
 typedef struct __edge_node{
-    unsigned int id;
-    unsigned int src;
-    unsigned int dest;
+    graph_id_t id;
+    graph_id_t src;
+    graph_id_t dest;
     void* metadata;
 } Edge;
 
+typedef struct __graph_csr {
+    graph_id_t num_verts;     /* number of vertex ids, including removed ones */
+    graph_id_t num_edges;
+    unsigned char* exists;
+    graph_id_t* offsets;      /* edges out of v are at offsets[v] to offsets[v + 1] */
+    graph_id_t* targets;
+    graph_id_t* edge_ids;
+    graph_id_t* in_offsets;   /* edges into v are at in_offsets[v] to in_offsets[v + 1] */
+    graph_id_t* sources;
+    graph_id_t* in_edge_ids;
+    graph_id_t num_edge_ids;  /* number of edge ids, used for the metadata */
+    const uint64_t* vertex_metadata_offsets;
+    const unsigned char* vertex_metadata;
+    const uint64_t* edge_metadata_offsets;
+    const unsigned char* edge_metadata;
+    void* _mapped;              /* set if loaded from a file; all arrays point into it */
+    size_t _mapped_size;
+} CSR;
+
+/*  on disk format; the header is followed by each of the arrays of the frozen
+    graph, each starting on an 8 byte boundary, so that it can be used as-is
+    once mapped into memory */
+#define GRAPH_FILE_MAGIC "CUGRAPH"
+#define GRAPH_FILE_VERSION 1
+#define GRAPH_FILE_BYTE_ORDER 0x01020304
+#define GRAPH_FILE_VERTEX_METADATA 0x01
+#define GRAPH_FILE_EDGE_METADATA 0x02
+
+typedef struct __graph_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t id_bytes;
+    uint32_t byte_order;
+    uint64_t num_verts;
+    uint64_t num_edges;
+    uint64_t num_edge_ids;
+    uint64_t reserved[2];
+} GraphFileHeader;
+
+/*  change log format; the header is followed by the records, each an
+    operation code and then the ids as varints: the vertex or edge id, and
+    for an added edge its source and destination. If the flags say so, the
+    metadata of added vertices or edges follows as its length plus one (0 if
+    there is none) and its bytes */
+#define GRAPH_LOG_MAGIC "CUGRLOG"
+#define GRAPH_LOG_VERSION 1
+#define GRAPH_LOG_BUFFER 65536          /* bytes of records held before writing */
+#define GRAPH_LOG_VERTEX_ADD 1
+#define GRAPH_LOG_VERTEX_REMOVE 2
+#define GRAPH_LOG_EDGE_ADD 3
+#define GRAPH_LOG_EDGE_REMOVE 4
+
+typedef struct __graph_log_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;         /* GRAPH_FILE_*_METADATA */
+    uint32_t id_bytes;
+    uint32_t reserved;
+} GraphLogHeader;
+
+typedef struct __graph_log {
+    graph_t g;
+    char* snapshot;
+    char* filename;
+    FILE* fp;
+    g_metadata_serialize_t vertex_metadata;
+    g_metadata_serialize_t edge_metadata;
+    unsigned int flags;
+    size_t compact_bytes;
+    size_t written;         /* bytes in the file */
+    unsigned char* buf;     /* records not yet written */
+    size_t size;
+    size_t max;
+    bool ok;                /* false once writing a record failed */
+    bool _lock;
+} GraphLog;
+
+/* a record read back from a change log; metadata points into the log */
+typedef struct __log_record {
+    unsigned char op;
+    graph_id_t id;
+    graph_id_t src;
+    graph_id_t dest;
+    const unsigned char* metadata;
+    size_t len;
+} LogRecord;
+
+/* growable list of ids used as scratch space by the algorithms */
+typedef struct __id_list {
+    graph_id_t* ids;
+    graph_id_t size;
+    graph_id_t _max;
+} IdList;
+
+/* edge with its weight, for the spanning tree algorithms */
+typedef struct __weighted_edge {
+    double weight;
+    graph_id_t id;
+    graph_id_t src;
+    graph_id_t dest;
+} WeightedEdge;
+
+/* an explicit edge id and where it is in a batch, to find the repeated ids */
+typedef struct __batch_id {
+    graph_id_t id;
+    size_t index;
+} BatchId;
+
+/* edges parsed from one chunk of an edge list */
+typedef struct __edge_list_chunk {
+    IdList src;
+    IdList dest;
+    double* weights;
+    graph_id_t _max_weights;
+    const char* start;
+    const char* end;
+    bool failed;
+} EdgeListChunk;
+
+typedef struct __graph_compressed {
+    graph_id_t num_verts;
+    graph_id_t num_edges;
+    uint64_t* offsets;          /* the list out of v starts at bytes[offsets[v]] */
+    unsigned char* bytes;       /* per vertex: degree, then the gaps between sorted ids */
+    uint64_t* in_offsets;
+    unsigned char* in_bytes;
+} Compressed;
+
+typedef struct __graph_bitmatrix {
+    graph_id_t num_verts;
+    unsigned int words;         /* 64 bit words in each row */
+    bool undirected;            /* edges are set in both directions */
+    uint64_t* rows;             /* bit dest of row src is set for an edge src -> dest */
+} BitMatrix;
+
+typedef struct __graph_workspace {
+    graph_id_t size;      /* number of vertex ids covered */
+    unsigned int epoch;     /* number of the current traversal */
+    unsigned int* visited;  /* epoch in which each vertex was last reached */
+    graph_id_t* ids;      /* queue or stack of vertex ids */
+    graph_id_t* pos;      /* next edge to follow for each entry of the stack */
+} Workspace;
+
+/* caller buffer being filled by a traversal */
+typedef struct __visit_buffer {
+    graph_id_t* res;
+    graph_id_t len;
+    graph_id_t size;
+} VisitBuffer;
+
+/* vertex id with its degree, for sorting */
+typedef struct __vertex_degree {
+    graph_id_t degree;
+    graph_id_t id;
+} VertexDegree;
+
+/* d-ary min heap of vertex ids, keyed on an external array, with decrease key */
+typedef struct __dary_heap {
+    graph_id_t* heap;
+    graph_id_t* pos;      /* location of each vertex id in the heap */
+    graph_id_t size;
+    const double* keys;
+} DaryHeap;
+
 /* private functions */
-static void __traverse_depth_first(graph_t g, unsigned int* res, char* bitarray, unsigned int* size);
-static void __graph_vertices_grow(graph_t g, unsigned int id);
-static void __graph_edges_grow(graph_t g, unsigned int id);
+static bool __workspace_begin(graph_workspace_t w, graph_id_t n);
+static void* __prop(PropList* l, const char* name, unsigned int type, size_t needed);
+static bool __prop_remove(PropList* l, const char* name);
+static void __props_free(PropList* l);
+static bool __props_permute(PropList* l, const graph_id_t* map, graph_id_t n, graph_id_t num);
+static size_t __prop_value_size(unsigned int type);
+static unsigned int __degree_bucket(unsigned int degree);
+static void __snapshot_publish(graph_t g, vertex_t v, bool in);
+static void __retire(graph_t g, void* ptr, unsigned int kind, bool free_metadata);
+static size_t __reclaim(graph_t g, bool all);
+static bool __visit_buffer(vertex_t v, void* data);
+static graph_id_t* __path_build(graph_workspace_t w, graph_id_t a, graph_id_t b, graph_id_t* len);
+static bool __multi_source_bfs(graph_t g, const graph_id_t* sources, graph_id_t num_sources, graph_id_t* dist, unsigned long long* sums, graph_id_t* reached);
+static graph_id_t __lowest_bit(uint64_t x);
+static unsigned int __popcount(uint64_t x);
+static graph_t __generated_graph(graph_id_t n, const graph_id_t* src, const graph_id_t* dest, size_t m);
+static uint64_t __rand_next(uint64_t* state);
+static double __rand_double(uint64_t* state);
+static void __graph_vertices_grow(graph_t g, graph_id_t id);
+static void __graph_edges_grow(graph_t g, graph_id_t id);
+static graph_id_t __segment(graph_t g, graph_id_t id, graph_id_t* offset);
+static size_t __segment_size(graph_t g, graph_id_t k);
+static vertex_t* __vertex_slot(graph_t g, graph_id_t id);
+static edge_t* __edge_slot(graph_t g, graph_id_t id);
+static vertex_t __vertex_at(graph_t g, graph_id_t id);
+static edge_t __edge_at(graph_t g, graph_id_t id);
+static size_t __index_hash(graph_id_t src, graph_id_t dest);
+static bool __index_build(graph_t g, size_t size);
+static void __index_insert(graph_t g, edge_t e);
+static void __index_remove(graph_t g, edge_t e);
+static edge_t __index_find(graph_t g, graph_id_t src, graph_id_t dest);
+static graph_id_t __sorted_lower_bound(vertex_t v, graph_id_t dest);
+static void __sort_edges(vertex_t v);
+static int __compare_edges(const void* a, const void* b);
 static void __vertex_edges_grow(vertex_t v_src, unsigned int outs);
+static void __vertex_edges_reserve(vertex_t v, unsigned int size);
+static void __vertex_edges_in_reserve(vertex_t v, unsigned int size);
+static unsigned int __doubled(unsigned int size);
+static size_t __edges_add_batch(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, const graph_id_t* edge_ids, size_t n);
+static bool __edges_skip_used_ids(graph_t g, const graph_id_t* edge_ids, size_t n, bool* skip);
+static int __compare_batch_ids(const void* a, const void* b);
+static bool __write_padded(FILE* fp, const void* data, size_t bytes);
+static bool __write_metadata(FILE* fp, void** metadata, graph_id_t num, g_metadata_serialize_t serialize);
+static size_t __pad8(size_t bytes);
+static const unsigned char* __file_section(const unsigned char* data, size_t size, size_t* pos, size_t bytes);
+static bool __metadata_offsets_valid(const uint64_t* offsets, size_t num, size_t available);
+static bool __csr_valid(graph_csr_t c);
+static void __log_record(graph_log_t l, unsigned char op, graph_id_t id, graph_id_t src, graph_id_t dest, void* metadata);
+static bool __log_write(graph_log_t l);
+static bool __log_restart(graph_log_t l);
+static size_t __log_check(const unsigned char* data, size_t size, GraphLogHeader* h, size_t* num_edges);
+static const unsigned char* __log_read(const unsigned char* p, const unsigned char* end, unsigned int flags, LogRecord* r);
+static bool __log_replay_edges(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, const graph_id_t* ids, size_t num);
+static unsigned char* __log_encode(unsigned char* p, uint64_t x);
+static const unsigned char* __log_decode(const unsigned char* p, const unsigned char* end, uint64_t* x);
+static bool __map_file(const char* filename, unsigned char** data, size_t* size);
+static void __unmap_file(void* data, size_t size);
+static void __parse_edge_list(EdgeListChunk* chunk, bool weighted, graph_id_t base);
+static const char* __parse_uint(const char* p, const char* end, graph_id_t* val);
+static const char* __parse_double(const char* p, const char* end, double* val);
+static bool __id_list_push(IdList* l, graph_id_t id);
+static graph_id_t __uf_find(graph_id_t* parent, graph_id_t x);
+static void __uf_union(graph_id_t* parent, graph_id_t a, graph_id_t b);
+static graph_t __condensation(graph_t g, const graph_id_t* comps, graph_id_t num_components);
+static double __edge_weight(edge_t e, g_edge_weight_t weight, const double* weights);
+static void __brandes(graph_csr_t c, graph_id_t s, graph_id_t* dist, double* sigma, double* delta, graph_id_t* order, double* scores);
+static WeightedEdge* __weighted_edges(graph_t g, g_edge_weight_t weight, const double* weights, size_t* num);
+static bool __sort_weighted(WeightedEdge* edges, size_t num);
+static void __radix_weighted(WeightedEdge* edges, WeightedEdge* tmp, size_t num);
+static unsigned int __weighted_digit(const WeightedEdge* e, unsigned int pass);
+static void __merge_weighted(const WeightedEdge* a, size_t num_a, const WeightedEdge* b, size_t num_b, WeightedEdge* out);
+static int __compare_weighted(const void* a, const void* b);
+static graph_id_t* __kruskal(graph_t g, g_edge_weight_t weight, const double* weights, graph_id_t* num_edges, double* total);
+static graph_id_t* __boruvka(graph_t g, g_edge_weight_t weight, const double* weights, graph_id_t* num_edges, double* total);
+static graph_id_t* __undirected_adjacency(graph_t g, size_t* offsets, unsigned int* degrees);
+static bool __props_gather(PropList* dst, const PropList* src, const graph_id_t* from, size_t num);
+static graph_id_t __intersect(const graph_id_t* a, graph_id_t num_a, const graph_id_t* b, graph_id_t num_b, unsigned long long* found);
+static graph_id_t __lower_bound(const graph_id_t* a, graph_id_t lo, graph_id_t num, graph_id_t val);
+static graph_id_t* __order_breadth_first(graph_t g, bool rcm);
+static int __compare_degree(const void* a, const void* b);
+static bool __compressed_side(graph_id_t n, const graph_id_t* adj_offsets, graph_id_t* adj, uint64_t** offsets, unsigned char** bytes);
+static bool __compressed_bucket(graph_id_t n, const graph_id_t* key, const graph_id_t* val, size_t num_edges, graph_id_t* adj_offsets, graph_id_t* adj);
+static int __compare_ids(const void* a, const void* b);
+static size_t __varint_size(graph_id_t x);
+static unsigned char* __varint_encode(unsigned char* p, graph_id_t x);
+static const unsigned char* __varint_decode(const unsigned char* p, graph_id_t* x);
+static unsigned int __bits_and_count(const uint64_t* a, const uint64_t* b, unsigned int from, unsigned int words);
+static void __heap_push(DaryHeap* h, graph_id_t id);
+static graph_id_t __heap_pop(DaryHeap* h);
+static void __heap_sift_up(DaryHeap* h, graph_id_t i);
+static void __heap_sift_down(DaryHeap* h, graph_id_t i);
+static double* __dijkstra(graph_t g, vertex_t v, g_edge_weight_t weight, const double* weights, graph_id_t** previous);
+static double* __delta_stepping(graph_t g, vertex_t v, g_edge_weight_t weight, const double* weights, double delta, graph_id_t** previous);
+static bool __delta_relax(graph_t g, const IdList* frontier, double* dist, g_edge_weight_t weight, const double* weights, double delta, bool light, IdList* updates);
+static graph_id_t* __shortest_path_tree(graph_t g, graph_id_t src, const double* dist, g_edge_weight_t weight, const double* weights);
 
 /*******************************************************************************
 *   Graph Properties / Functions
@@ -75,18 +420,42 @@ graph_t g_init_alt(unsigned int size) {
     g->num_verts = 0;
     g->_prev_vert_id = 0;
     g->_prev_edge_id = 0;
-    g->_max_verts = size;
-    g->_max_edges = size;
 
-    g->verts = (vertex_t*)calloc(g->_max_verts, sizeof(vertex_t));
-    g->edges = (edge_t*)calloc(g->_max_edges, sizeof(edge_t));
+    /* round the first segment up to a power of 2 */
+    g->_segment_shift = 0;
+    while (g->_segment_shift < 31 && (1u << g->_segment_shift) < size)
+        ++g->_segment_shift;
 
-    unsigned int i;
-    for (i = 0; i < g->_max_edges; ++i) {
-        g->verts[i] = NULL;
-        g->edges[i] = NULL;
-    }
+    g->_index_mode = GRAPH_EDGE_INDEX_NONE;
+    g->_index_lock = false;
+    g->_index_size = 0;
+    g->_index_count = 0;
+    g->_index = NULL;
+
+    g->_snapshots = false;
+    g->_retire_lock = false;
+    g->_epoch = 1;
+    g->_retired = NULL;
+    g->_num_retired = 0;
+    g->_max_retired = 0;
+    g->_vertex_props.columns = NULL;
+    g->_vertex_props.num = 0;
+    g->_edge_props.columns = NULL;
+    g->_edge_props.num = 0;
 
+    graph_id_t k;
+    for (k = 0; k < GRAPH_MAX_READERS; ++k)
+        g->_readers[k] = 0;
+    for (k = 0; k < GRAPH_SEGMENTS; ++k) {
+        g->verts[k] = NULL;
+        g->edges[k] = NULL;
+    }
+    __graph_vertices_grow(g, 0);
+    __graph_edges_grow(g, 0);
+    if (g->verts[0] == NULL || g->edges[0] == NULL) {
+        g_free(g);
+        return NULL;
+    }
     return g;
 }
 
@@ -95,81 +464,227 @@ void g_free(graph_t g) {
 }
 
 void g_free_alt(graph_t g, bool free_metadata) {
-    unsigned int i;
-    for (i = 0; i < g->_max_edges; ++i) {
-        edge_t e = g->edges[i];
-        if (e == NULL)
+    graph_id_t k;
+    size_t i;
+    __reclaim(g, true);
+    free(g->_retired);
+    g->_retired = NULL;
+    __props_free(&g->_vertex_props);
+    __props_free(&g->_edge_props);
+    for (k = 0; k < GRAPH_SEGMENTS; ++k) {
+        if (g->edges[k] == NULL)
             continue;
-        g_edge_free_alt(e, free_metadata);
+        for (i = 0; i < __segment_size(g, k); ++i) {
+            edge_t e = g->edges[k][i];
+            if (e == NULL)
+                continue;
+            g_edge_free_alt(e, free_metadata);
+        }
+        free(g->edges[k]);
+        g->edges[k] = NULL;
     }
-    free(g->edges);
 
-    for (i = 0; i < g->_max_verts; ++i) {
-        vertex_t v = g->verts[i];
-        if (v == NULL)
+    for (k = 0; k < GRAPH_SEGMENTS; ++k) {
+        if (g->verts[k] == NULL)
             continue;
-        g_vertex_free_alt(v, free_metadata);
+        for (i = 0; i < __segment_size(g, k); ++i) {
+            vertex_t v = g->verts[k][i];
+            if (v == NULL)
+                continue;
+            g_vertex_free_alt(v, free_metadata);
+        }
+        free(g->verts[k]);
+        g->verts[k] = NULL;
     }
-    free(g->verts);
 
+    free(g->_index);
+    g->_index = NULL;
     g->num_verts = 0;
     g->num_edges = 0;
-    g->_max_verts = 0;
-    g->_max_edges = 0;
     g->_prev_vert_id = 0;
     g->_prev_edge_id = 0;
-    g->verts = NULL;
-    g->edges = NULL;
 
     free(g);
 }
 
-unsigned int g_num_vertices(graph_t g) {
+graph_id_t g_num_vertices(graph_t g) {
     return g->num_verts;
 }
 
-unsigned int g_num_edges(graph_t g) {
+graph_id_t g_num_edges(graph_t g) {
     return g->num_edges;
 }
 
-unsigned int g_vertices_inserted(graph_t g) {
+size_t g_memory_usage(graph_t g) {
+    graph_stats_t stats;
+    g_stats(g, &stats);
+    return stats.bytes_total;
+}
+
+void g_stats(graph_t g, graph_stats_t* stats) {
+    memset(stats, 0, sizeof(graph_stats_t));
+    stats->bytes_graph = sizeof(Graph) + g->_max_retired * sizeof(Retired);
+    stats->bytes_wasted = (g->_max_retired - g->_num_retired) * sizeof(Retired);
+    stats->bytes_index = g->_index_size * sizeof(edge_t);
+    stats->bytes_edges = (size_t)g->num_edges * sizeof(Edge);
+    stats->vertex_holes = g->_prev_vert_id - g->num_verts;
+    stats->edge_holes = g->_prev_edge_id - g->num_edges;
+
+    graph_id_t k;
+    for (k = 0; k < 2; ++k) {
+        const PropList* l = (k == 0) ? &g->_vertex_props : &g->_edge_props;
+        size_t used = (k == 0) ? g->_prev_vert_id : g->_prev_edge_id;
+        graph_id_t i;
+        for (i = 0; i < l->num; ++i) {
+            size_t width = __prop_value_size(l->columns[i].type);
+            stats->bytes_props += sizeof(PropColumn) + l->columns[i].size * width;
+            if (l->columns[i].size > used)
+                stats->bytes_wasted += (l->columns[i].size - used) * width;
+        }
+    }
+
+    size_t slots = 0;
+    for (k = 0; k < GRAPH_SEGMENTS; ++k) {
+        if (g->verts[k] != NULL)
+            slots += __segment_size(g, k);
+        if (g->edges[k] != NULL)
+            slots += __segment_size(g, k);
+    }
+    stats->bytes_tables = slots * sizeof(void*);
+    stats->bytes_wasted += (slots - g->num_verts - g->num_edges) * sizeof(void*);
+
+    size_t i;
+    for (i = 0; i < g->_prev_vert_id; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        if (v == NULL)
+            continue;
+        stats->bytes_vertices += sizeof(Vertex);
+        stats->bytes_edge_lists += ((size_t)v->_max_edges + v->_max_edges_in) * sizeof(edge_t);
+        stats->bytes_wasted += ((size_t)(v->_max_edges - v->num_edges_out) + (v->_max_edges_in - v->num_edges_in)) * sizeof(edge_t);
+        if (v->_snapshot != NULL)
+            stats->bytes_snapshots += sizeof(EdgeBlock) + v->_snapshot->num * sizeof(edge_t);
+        if (v->_snapshot_in != NULL)
+            stats->bytes_snapshots += sizeof(EdgeBlock) + v->_snapshot_in->num * sizeof(edge_t);
+
+        if (v->num_edges_out > stats->max_degree_out)
+            stats->max_degree_out = v->num_edges_out;
+        if (v->num_edges_in > stats->max_degree_in)
+            stats->max_degree_in = v->num_edges_in;
+        ++stats->degree_out[__degree_bucket(v->num_edges_out)];
+        ++stats->degree_in[__degree_bucket(v->num_edges_in)];
+    }
+    stats->bytes_total = stats->bytes_graph + stats->bytes_tables + stats->bytes_vertices + stats->bytes_edges +
+                         stats->bytes_edge_lists + stats->bytes_snapshots + stats->bytes_index + stats->bytes_props;
+}
+
+size_t g_shrink_to_fit(graph_t g) {
+    size_t before = g_memory_usage(g);
+
+    /*  keep at least one slot out of each vertex since the list out doubles
+        when it grows; the list in is allocated again on the first edge in */
+    graph_id_t i;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i = 0; i < g->_prev_vert_id; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        if (v == NULL)
+            continue;
+        graph_id_t size = (v->num_edges_out > 0) ? v->num_edges_out : 1;
+        if (size < v->_max_edges) {
+            edge_t* tmp = (edge_t*)realloc(v->edges, size * sizeof(edge_t));
+            if (tmp != NULL) {
+                v->edges = tmp;
+                v->_max_edges = size;
+            }
+        }
+        if (v->num_edges_in == 0) {
+            free(v->edges_in);
+            v->edges_in = NULL;
+            v->_max_edges_in = 0;
+        } else if (v->num_edges_in < v->_max_edges_in) {
+            edge_t* tmp = (edge_t*)realloc(v->edges_in, v->num_edges_in * sizeof(edge_t));
+            if (tmp != NULL) {
+                v->edges_in = tmp;
+                v->_max_edges_in = v->num_edges_in;
+            }
+        }
+    }
+
+    /*  segments past the last id are empty and are allocated again if needed;
+        the first is always kept */
+    graph_id_t offset, k, last_vert = __segment(g, g->_prev_vert_id, &offset);
+    if (offset == 0 && last_vert > 0)
+        --last_vert;
+    graph_id_t last_edge = __segment(g, g->_prev_edge_id, &offset);
+    if (offset == 0 && last_edge > 0)
+        --last_edge;
+    for (k = 1; k < GRAPH_SEGMENTS; ++k) {
+        if (k > last_vert) {
+            free(g->verts[k]);
+            g->verts[k] = NULL;
+        }
+        if (k > last_edge) {
+            free(g->edges[k]);
+            g->edges[k] = NULL;
+        }
+    }
+
+    if (g->_num_retired == 0) {
+        free(g->_retired);
+        g->_retired = NULL;
+        g->_max_retired = 0;
+    } else if (g->_num_retired < g->_max_retired) {
+        Retired* tmp = (Retired*)realloc(g->_retired, g->_num_retired * sizeof(Retired));
+        if (tmp != NULL) {
+            g->_retired = tmp;
+            g->_max_retired = g->_num_retired;
+        }
+    }
+
+    for (k = 0; k < 2; ++k) {
+        PropList* l = (k == 0) ? &g->_vertex_props : &g->_edge_props;
+        size_t used = (k == 0) ? g->_prev_vert_id : g->_prev_edge_id;
+        if (used == 0)
+            used = 1;
+        for (i = 0; i < l->num; ++i) {
+            PropColumn* c = &l->columns[i];
+            if (used >= c->size)
+                continue;
+            void* tmp = realloc(c->values, used * __prop_value_size(c->type));
+            if (tmp != NULL) {
+                c->values = tmp;
+                c->size = used;
+            }
+        }
+    }
+    return before - g_memory_usage(g);
+}
+
+graph_id_t g_vertices_inserted(graph_t g) {
     return g->_prev_vert_id;
 }
 
-vertex_t g_vertex_get(graph_t g, unsigned int id) {
-    if (id > g->_prev_vert_id)
+vertex_t g_vertex_get(graph_t g, graph_id_t id) {
+    if (id >= ATOMIC_LOAD(g->_prev_vert_id))
         return NULL;
-    return g->verts[id];
+    return __vertex_at(g, id);
 }
 
-edge_t g_edge_get(graph_t g, unsigned int id) {
-    if (id > g->_prev_edge_id)
+edge_t g_edge_get(graph_t g, graph_id_t id) {
+    if (id >= ATOMIC_LOAD(g->_prev_edge_id))
         return NULL;
-    return g->edges[id];
+    return __edge_at(g, id);
 }
 
 vertex_t g_vertex_add(graph_t g, void* metadata) {
-    unsigned int id = ATOMIC_FETCH_ADD(g->_prev_vert_id);
+    graph_id_t id = ATOMIC_FETCH_ADD(g->_prev_vert_id);
     return g_vertex_add_alt(g, id, metadata);
 }
 
-vertex_t g_vertex_add_alt(graph_t g, unsigned int id, void* metadata) {
-    /* check if mixed adding by id and add and clobbered the other */
-    if (id >= g->_max_verts) {
-        CRITICAL
-        {
-            __graph_vertices_grow(g, id);
-        }
-    } else if (/*id < g->_max_verts &&*/ g->verts[id] != NULL) {
+vertex_t g_vertex_add_alt(graph_t g, graph_id_t id, void* metadata) {
+    __graph_vertices_grow(g, id);
+    vertex_t* slot = __vertex_slot(g, id);
+    if (slot == NULL || ATOMIC_LOAD(*slot) != NULL)
         return NULL;
-    }
-
-    CRITICAL
-    {
-        if (id > g->_prev_vert_id) {
-            g->_prev_vert_id = id + 1;
-        }
-    }
 
     vertex_t v = (vertex_t)calloc(1, sizeof(Vertex));
     if (v == NULL)
@@ -181,92 +696,357 @@ vertex_t g_vertex_add_alt(graph_t g, unsigned int id, void* metadata) {
     v->edges = (edge_t*)calloc(v->_max_edges, sizeof(edge_t));
     v->num_edges_out = 0;
     v->num_edges_in = 0;
-    g->verts[id] = v;
+    v->_max_edges_in = 0;  /* allocated on the first edge in */
+    v->edges_in = NULL;
+    v->_snapshot = NULL;
+    v->_snapshot_in = NULL;
+    v->_lock = false;
+
+    /* check if mixed adding by id and add and clobbered the other */
+    vertex_t expected = NULL;
+    if (!ATOMIC_CAS(slot, &expected, &v)) {
+        free(v->edges);
+        free(v);
+        return NULL;
+    }
+
+    graph_id_t prev = ATOMIC_LOAD(g->_prev_vert_id), next = id + 1;
+    while (prev < next && !ATOMIC_CAS(&g->_prev_vert_id, &prev, &next)) { }
     ATOMIC_ADD_FETCH(g->num_verts);
+    if (g->_log != NULL)
+        __log_record(g->_log, GRAPH_LOG_VERTEX_ADD, id, 0, 0, metadata);
     return v;
 }
 
-vertex_t g_vertex_remove(graph_t g, unsigned int id) {
+vertex_t g_vertex_remove(graph_t g, graph_id_t id) {
     return g_vertex_remove_alt(g, id, true);
 }
 
-vertex_t g_vertex_remove_alt(graph_t g, unsigned int id, bool free_edge_metadata) {
-    if (id > g->_prev_vert_id || g->verts[id] == NULL)
+vertex_t g_vertex_remove_alt(graph_t g, graph_id_t id, bool free_edge_metadata) {
+    if (id >= g->_prev_vert_id || __vertex_at(g, id) == NULL)
         return NULL;
-    vertex_t v = g->verts[id];
+    vertex_t v = __vertex_at(g, id);
 
-    /* need to find all the edges that include this vertex and remove them */
-    unsigned int i;
-    for (i = 0; i <= g->_prev_edge_id; ++i) {
-        edge_t e = g->edges[i];
-        if (e == NULL)
-            continue;
-        if (e->src == id || e->dest == id) {
-            e = g_edge_remove(g, i);
-            g_edge_free_alt(e, free_edge_metadata);
-        }
-    }
+    /* remove all the edges out of and into this vertex */
+    while (v->num_edges_out > 0)
+        g_edge_retire(g, g_edge_remove(g, v->edges[v->num_edges_out - 1]->id), free_edge_metadata);
+    while (v->num_edges_in > 0)
+        g_edge_retire(g, g_edge_remove(g, v->edges_in[v->num_edges_in - 1]->id), free_edge_metadata);
 
     /* remove the vertex from the graph */
-    g->verts[id] = NULL;
+    *__vertex_slot(g, id) = NULL;
     ATOMIC_SUB_FETCH(g->num_verts);
+    if (g->_log != NULL)
+        __log_record(g->_log, GRAPH_LOG_VERTEX_REMOVE, id, 0, 0, NULL);
 
     return v;
 }
 
-edge_t g_edge_add(graph_t g, unsigned int src, unsigned int dest, void* metadata) {
+edge_t g_edge_add(graph_t g, graph_id_t src, graph_id_t dest, void* metadata) {
     /*  some tests to make sure src and dest are valid;
         need to make sure they are still present too */
-    if (src > g->_prev_vert_id || dest > g->_prev_vert_id || g->verts[src] == NULL || g->verts[dest] == NULL)
+    graph_id_t num_verts = ATOMIC_LOAD(g->_prev_vert_id);
+    if (src >= num_verts || dest >= num_verts)
+        return NULL;
+    vertex_t v_src = __vertex_at(g, src);
+    vertex_t v_dest = __vertex_at(g, dest);
+    if (v_src == NULL || v_dest == NULL)
         return NULL;
 
     edge_t e = (edge_t)calloc(1, sizeof(Edge));
     if (e == NULL)
         return NULL;
 
-    unsigned int id = ATOMIC_FETCH_ADD(g->_prev_edge_id);
-    if (id >= g->_max_edges) {
-        CRITICAL_EDGE
-        {
-            __graph_edges_grow(g, id);
-        }
+    /*  reserve the slot for the id before the edge is linked in, so that it
+        is never reachable from its vertices but not by its id */
+    graph_id_t id = ATOMIC_FETCH_ADD(g->_prev_edge_id);
+    __graph_edges_grow(g, id);
+    edge_t* slot = __edge_slot(g, id);
+    if (slot == NULL) {
+        free(e);
+        return NULL;
     }
     e->id = id;
     e->src = src;
     e->dest = dest;
     e->metadata = metadata;
 
-    /* need to increment the in and out information for the vertices */
-    vertex_t v_src = g->verts[src];
-    unsigned int outs = ATOMIC_FETCH_ADD(v_src->num_edges_out);
-    if (outs >= v_src->_max_edges) {
-        CRITICAL_EDGE
-        {
-            __vertex_edges_grow(v_src, outs);
-        }
+    /*  the source and destination are locked one at a time to append to
+        their edges out and in */
+    SPIN_LOCK(v_src->_lock);
+    if (v_src->num_edges_out >= v_src->_max_edges)
+        __vertex_edges_grow(v_src, v_src->num_edges_out);
+    if (g->_index_mode == GRAPH_EDGE_INDEX_SORTED) {
+        /* the new edge has the largest id so it goes after any to the same dest */
+        graph_id_t pos = __sorted_lower_bound(v_src, dest + 1);
+        memmove(&v_src->edges[pos + 1], &v_src->edges[pos], (v_src->num_edges_out - pos) * sizeof(edge_t));
+        v_src->edges[pos] = e;
+        ++v_src->num_edges_out;
+    } else {
+        v_src->edges[v_src->num_edges_out++] = e;
     }
+    if (g->_snapshots)
+        __snapshot_publish(g, v_src, false);
+    SPIN_UNLOCK(v_src->_lock);
 
-    v_src->edges[outs] = e;
-    ATOMIC_ADD_FETCH(g->verts[dest]->num_edges_in);
+    SPIN_LOCK(v_dest->_lock);
+    if (v_dest->num_edges_in >= v_dest->_max_edges_in)
+        __vertex_edges_in_reserve(v_dest, (v_dest->_max_edges_in == 0) ? 4 : __doubled(v_dest->_max_edges_in));
+    v_dest->edges_in[v_dest->num_edges_in++] = e;
+    if (g->_snapshots)
+        __snapshot_publish(g, v_dest, true);
+    SPIN_UNLOCK(v_dest->_lock);
     ATOMIC_ADD_FETCH(g->num_edges);
-    g->edges[id] = e;
+    ATOMIC_STORE(*slot, e);
+
+    if (g->_index_mode == GRAPH_EDGE_INDEX_HASH) {
+        SPIN_LOCK(g->_index_lock);
+        __index_insert(g, e);
+        SPIN_UNLOCK(g->_index_lock);
+    }
+    if (g->_log != NULL)
+        __log_record(g->_log, GRAPH_LOG_EDGE_ADD, id, src, dest, metadata);
 
     return e;
 }
 
-edge_t g_edge_remove(graph_t g, unsigned int id) {
-    if (id > g->_prev_edge_id || g->edges[id] == NULL)
+size_t g_edges_add_batch(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, size_t n) {
+    graph_id_t base = g->_prev_edge_id, i;
+    size_t m = __edges_add_batch(g, src, dest, metadata, NULL, n);
+    if (g->_log != NULL && m > 0) {
+        /* the edges added have the ids after base */
+        for (i = base; i < g->_prev_edge_id; ++i) {
+            edge_t e = __edge_at(g, i);
+            __log_record(g->_log, GRAPH_LOG_EDGE_ADD, i, e->src, e->dest, e->metadata);
+        }
+    }
+    return m;
+}
+
+static size_t __edges_add_batch(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, const graph_id_t* edge_ids, size_t n) {
+    if (n == 0)
+        return 0;
+
+    /*  first pass: skip the edges that cannot be added, then count the out
+        degree of each source vertex for the rest; the counts are stored
+        shifted by one to become offsets */
+    graph_id_t num_verts = g->_prev_vert_id;
+    graph_id_t* offsets = (graph_id_t*)calloc(num_verts + 1, sizeof(graph_id_t));
+    bool* skip = (bool*)calloc(n, sizeof(bool));
+    if (offsets == NULL || skip == NULL) {
+        free(offsets);
+        free(skip);
+        return 0;
+    }
+
+    size_t i, m = 0;
+    for (i = 0; i < n; ++i)
+        skip[i] = (src[i] >= num_verts || dest[i] >= num_verts || __vertex_at(g, src[i]) == NULL || __vertex_at(g, dest[i]) == NULL);
+    if (edge_ids != NULL && __edges_skip_used_ids(g, edge_ids, n, skip) == false) {
+        free(offsets);
+        free(skip);
+        return 0;
+    }
+    for (i = 0; i < n; ++i) {
+        if (skip[i])
+            continue;
+        ++offsets[src[i] + 1];
+        ++m;
+    }
+
+    /* the ids handed out must not run into GRAPH_INVALID_ID */
+    if (m == 0 || m >= GRAPH_INVALID_ID || (edge_ids == NULL && m >= GRAPH_INVALID_ID - g->_prev_edge_id)) {
+        free(offsets);
+        free(skip);
+        return 0;
+    }
+
+    size_t* order = (size_t*)malloc(m * sizeof(size_t));
+    graph_id_t* ids = (graph_id_t*)malloc(m * sizeof(graph_id_t));
+    edge_t* edges = (edge_t*)calloc(m, sizeof(edge_t));
+    if (order == NULL || ids == NULL || edges == NULL) {
+        free(order);
+        free(ids);
+        free(edges);
+        free(offsets);
+        free(skip);
+        return 0;
+    }
+
+    graph_id_t v;
+    for (v = 0; v < num_verts; ++v)
+        offsets[v + 1] += offsets[v];
+
+    /*  second pass: bucket the batch by source vertex, keeping the input order
+        within each bucket; ids are handed out in input order unless they are
+        provided. Once done, offsets[v] holds the end of the bucket for v (and
+        the start of v + 1) */
+    graph_id_t base = g->_prev_edge_id;
+    graph_id_t rank = 0, next_id = base;
+    for (i = 0; i < n; ++i) {
+        if (skip[i])
+            continue;
+        graph_id_t slot = offsets[src[i]]++;
+        order[slot] = i;
+        ids[slot] = (edge_ids == NULL) ? base + rank++ : edge_ids[i];
+        if (ids[slot] >= next_id)
+            next_id = ids[slot] + 1;
+    }
+    free(skip);
+
+    /*  allocate every edge, and the edge table for them, before the graph is
+        changed so that running out of memory leaves it as it was */
+    bool ok = true;
+    for (i = 0; i < m && ok; ++i) {
+        edges[i] = (edge_t)calloc(1, sizeof(Edge));
+        ok = edges[i] != NULL;
+    }
+    if (ok) {
+        __graph_edges_grow(g, next_id - 1);
+        ok = __edge_slot(g, next_id - 1) != NULL;
+    }
+    if (!ok) {
+        for (i = 0; i < m; ++i)
+            free(edges[i]);
+        free(order);
+        free(ids);
+        free(edges);
+        free(offsets);
+        return 0;
+    }
+    g->_prev_edge_id = next_id;
+
+    /* each source vertex is owned by a single thread */
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (v = 0; v < num_verts; ++v) {
+        graph_id_t start = (v == 0) ? 0 : offsets[v - 1];
+        graph_id_t end = offsets[v];
+        if (start == end)
+            continue;
+
+        vertex_t v_src = __vertex_at(g, v);
+        __vertex_edges_reserve(v_src, v_src->num_edges_out + (end - start));
+
+        graph_id_t j;
+        for (j = start; j < end; ++j) {
+            size_t k = order[j];
+            edge_t e = edges[j];
+            e->id = ids[j];
+            e->src = v;
+            e->dest = dest[k];
+            e->metadata = (metadata == NULL) ? NULL : metadata[k];
+
+            v_src->edges[v_src->num_edges_out++] = e;
+            *__edge_slot(g, e->id) = e;
+        }
+        if (g->_index_mode == GRAPH_EDGE_INDEX_SORTED)
+            __sort_edges(v_src);
+        if (g->_snapshots)
+            __snapshot_publish(g, v_src, false);
+    }
+    g->num_edges += m;
+
+    /*  reuse the offsets to count the edges into each vertex so the in lists
+        are sized once before the edges are appended in parallel */
+    for (v = 0; v < num_verts; ++v)
+        offsets[v] = 0;
+    for (i = 0; i < m; ++i)
+        ++offsets[edges[i]->dest];
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (v = 0; v < num_verts; ++v) {
+        if (offsets[v] == 0)
+            continue;
+        vertex_t v_dest = __vertex_at(g, v);
+        __vertex_edges_in_reserve(v_dest, v_dest->num_edges_in + offsets[v]);
+    }
+
+    graph_id_t k;
+    #pragma omp parallel for
+    for (k = 0; k < m; ++k) {
+        edge_t e = edges[k];
+        vertex_t v_dest = __vertex_at(g, e->dest);
+        v_dest->edges_in[ATOMIC_FETCH_ADD(v_dest->num_edges_in)] = e;
+    }
+
+    if (g->_snapshots) {
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (v = 0; v < num_verts; ++v) {
+            if (offsets[v] != 0)
+                __snapshot_publish(g, __vertex_at(g, v), true);
+        }
+    }
+
+    if (g->_index_mode == GRAPH_EDGE_INDEX_HASH) {
+        for (i = 0; i < m; ++i)
+            __index_insert(g, edges[i]);
+    }
+
+    free(order);
+    free(ids);
+    free(edges);
+    free(offsets);
+    return m;
+}
+
+static bool __edges_skip_used_ids(graph_t g, const graph_id_t* edge_ids, size_t n, bool* skip) {
+    /*  an explicit id cannot replace an edge that is in the graph, and only the
+        first edge in the batch with a given id is kept; sorting by id, then
+        by place in the batch, puts the one to keep first among its repeats */
+    BatchId* sorted = (BatchId*)malloc((n + 1) * sizeof(BatchId));
+    if (sorted == NULL)
+        return false;
+    size_t i, num = 0;
+    for (i = 0; i < n; ++i) {
+        if (skip[i])
+            continue;
+        sorted[num].id = edge_ids[i];
+        sorted[num++].index = i;
+    }
+    qsort(sorted, num, sizeof(BatchId), __compare_batch_ids);
+    for (i = 0; i < num; ++i) {
+        graph_id_t id = sorted[i].id;
+        if (id == GRAPH_INVALID_ID || (id < g->_prev_edge_id && __edge_at(g, id) != NULL) || (i > 0 && sorted[i - 1].id == id))
+            skip[sorted[i].index] = true;
+    }
+    free(sorted);
+    return true;
+}
+
+static int __compare_batch_ids(const void* a, const void* b) {
+    const BatchId* x = (const BatchId*)a;
+    const BatchId* y = (const BatchId*)b;
+    if (x->id != y->id)
+        return (x->id > y->id) - (x->id < y->id);
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+edge_t g_edge_remove(graph_t g, graph_id_t id) {
+    if (id >= ATOMIC_LOAD(g->_prev_edge_id))
+        return NULL;
+    edge_t* slot = __edge_slot(g, id);
+    edge_t e = (slot == NULL) ? NULL : ATOMIC_LOAD(*slot);
+    edge_t none = NULL;
+    /* only one of several threads removing the same edge gets it */
+    if (e == NULL || !ATOMIC_CAS(slot, &e, &none))
         return NULL;
-    edge_t e = g->edges[id];
-    g->edges[id] = NULL;
     ATOMIC_SUB_FETCH(g->num_edges);
 
     /*  find the correct location in the src and set to NULL
         but move the last one to fill it's spot */
-    vertex_t v = g->verts[e->src];
-    CRITICAL_EDGE
-    {
-        unsigned int i;
+    vertex_t v = __vertex_at(g, e->src);
+    SPIN_LOCK(v->_lock);
+    graph_id_t i;
+    if (g->_index_mode == GRAPH_EDGE_INDEX_SORTED) {
+        /* keep the order; shift everything after it down one */
+        for (i = __sorted_lower_bound(v, e->dest); i < v->num_edges_out; ++i) {
+            if (e == v->edges[i]) {
+                memmove(&v->edges[i], &v->edges[i + 1], (v->num_edges_out - i - 1) * sizeof(edge_t));
+                v->edges[v->num_edges_out - 1] = NULL;
+                break;
+            }
+        }
+    } else {
         for (i = 0; i < v->num_edges_out; ++i) {
             if (e == v->edges[i]) {
                 v->edges[i] = v->edges[v->num_edges_out - 1];
@@ -275,16 +1055,104 @@ edge_t g_edge_remove(graph_t g, unsigned int id) {
             }
         }
     }
-    ATOMIC_SUB_FETCH(v->num_edges_out);
-    ATOMIC_SUB_FETCH((g->verts[e->dest])->num_edges_in);
+    --v->num_edges_out;
+    if (g->_snapshots)
+        __snapshot_publish(g, v, false);
+    SPIN_UNLOCK(v->_lock);
+
+    v = __vertex_at(g, e->dest);
+    SPIN_LOCK(v->_lock);
+    for (i = 0; i < v->num_edges_in; ++i) {
+        if (e == v->edges_in[i]) {
+            v->edges_in[i] = v->edges_in[v->num_edges_in - 1];
+            v->edges_in[v->num_edges_in - 1] = NULL;
+            break;
+        }
+    }
+    --v->num_edges_in;
+    if (g->_snapshots)
+        __snapshot_publish(g, v, true);
+    SPIN_UNLOCK(v->_lock);
+
+    if (g->_index_mode == GRAPH_EDGE_INDEX_HASH) {
+        SPIN_LOCK(g->_index_lock);
+        __index_remove(g, e);
+        SPIN_UNLOCK(g->_index_lock);
+    }
+    if (g->_log != NULL)
+        __log_record(g->_log, GRAPH_LOG_EDGE_REMOVE, id, 0, 0, NULL);
+    return e;
+}
+
+edge_t g_edge_find(graph_t g, graph_id_t src, graph_id_t dest) {
+    if (src >= ATOMIC_LOAD(g->_prev_vert_id))
+        return NULL;
+    vertex_t v = __vertex_at(g, src);
+    if (v == NULL)
+        return NULL;
+
+    if (g->_index_mode == GRAPH_EDGE_INDEX_HASH) {
+        SPIN_LOCK(g->_index_lock);
+        edge_t e = __index_find(g, src, dest);
+        SPIN_UNLOCK(g->_index_lock);
+        return e;
+    }
+
+    /* edges added or removed at the same time may grow or shift the list */
+    edge_t e = NULL;
+    graph_id_t i;
+    SPIN_LOCK(v->_lock);
+    if (g->_index_mode == GRAPH_EDGE_INDEX_SORTED) {
+        i = __sorted_lower_bound(v, dest);
+        if (i < v->num_edges_out && v->edges[i]->dest == dest)
+            e = v->edges[i];
+    } else {
+        for (i = 0; i < v->num_edges_out; ++i) {
+            if (v->edges[i]->dest == dest) {
+                e = v->edges[i];
+                break;
+            }
+        }
+    }
+    SPIN_UNLOCK(v->_lock);
     return e;
 }
 
+bool g_edge_index(graph_t g, unsigned int mode) {
+    if (mode > GRAPH_EDGE_INDEX_SORTED)
+        return false;
+
+    if (mode == GRAPH_EDGE_INDEX_HASH) {
+        if (g->_index_mode != GRAPH_EDGE_INDEX_HASH && !__index_build(g, 16))
+            return false;
+    } else {
+        free(g->_index);
+        g->_index = NULL;
+        g->_index_size = 0;
+        g->_index_count = 0;
+    }
+
+    if (mode == GRAPH_EDGE_INDEX_SORTED && g->_index_mode != GRAPH_EDGE_INDEX_SORTED) {
+        graph_id_t i;
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (i = 0; i < g->_prev_vert_id; ++i) {
+            vertex_t v = __vertex_at(g, i);
+            if (v == NULL)
+                continue;
+            __sort_edges(v);
+            if (g->_snapshots)
+                __snapshot_publish(g, v, false);
+        }
+    }
+    g->_index_mode = mode;
+    return true;
+}
+
 
 /*******************************************************************************
 *   Vertex Properties / Functions
 *******************************************************************************/
-unsigned int g_vertex_id(vertex_t v) {
+graph_id_t g_vertex_id(vertex_t v) {
     return v->id;
 }
 
@@ -310,6 +1178,12 @@ edge_t g_vertex_edge(vertex_t v, unsigned int idx) {
     return v->edges[idx];
 }
 
+edge_t g_vertex_edge_in(vertex_t v, unsigned int idx) {
+    if (idx >= v->num_edges_in)
+        return NULL;
+    return v->edges_in[idx];
+}
+
 void g_vertex_free(vertex_t v) {
     g_vertex_free_alt(v, true);
 }
@@ -319,12 +1193,19 @@ void g_vertex_free_alt(vertex_t v, bool free_metadata) {
     v->num_edges_in = 0;
     v->num_edges_out = 0;
     v->_max_edges = 0;
+    v->_max_edges_in = 0;
     free(v->edges);
+    free(v->edges_in);
+    free(v->_snapshot);
+    free(v->_snapshot_in);
     if (free_metadata == true)
         free(v->metadata);
 
     v->metadata = NULL;
     v->edges = NULL;
+    v->edges_in = NULL;
+    v->_snapshot = NULL;
+    v->_snapshot_in = NULL;
     free(v);
 }
 
@@ -332,15 +1213,15 @@ void g_vertex_free_alt(vertex_t v, bool free_metadata) {
 *   Edge Properties / Functions
 *******************************************************************************/
 
-unsigned int g_edge_id(edge_t e) {
+graph_id_t g_edge_id(edge_t e) {
     return e->id;
 }
 
-unsigned int g_edge_src(edge_t e) {
+graph_id_t g_edge_src(edge_t e) {
     return e->src;
 }
 
-unsigned int g_edge_dest(edge_t e) {
+graph_id_t g_edge_dest(edge_t e) {
     return e->dest;
 }
 
@@ -368,128 +1249,4821 @@ void g_edge_free_alt(edge_t e, bool free_metadata) {
     free(e);
 }
 
-
 /*******************************************************************************
-*   traversals
+*   property columns
 *******************************************************************************/
-#define SET_BIT(A,k)        (A[((k) / 8)] |=  (1 << ((k) % 8)))
-#define CHECK_BIT(A, k)     (A[((k) / 8)] &   (1 << ((k) % 8)))
-#define CEILING(n,d)  ((n / d) + (n % d > 0))
-unsigned int* g_breadth_first_traverse(graph_t g, vertex_t v, unsigned int* size) {
-    *size = 0;
-    unsigned int* ret = (unsigned int*)calloc(g_num_vertices(g), sizeof(unsigned int));
-    /* we will use a bitarray to track which vertices have been visited */
-    char* bitarray = (char*)calloc(CEILING(g_vertices_inserted(g), 8), sizeof(char));
-    unsigned int id = g_vertex_id(v);
-    SET_BIT(bitarray, id);
+void* g_vertex_prop(graph_t g, const char* name, unsigned int type) {
+    return __prop(&g->_vertex_props, name, type, g->_prev_vert_id);
+}
 
-    int cur_pos = 0, pos = 0;
-    ret[pos++] = id;
+void* g_edge_prop(graph_t g, const char* name, unsigned int type) {
+    return __prop(&g->_edge_props, name, type, g->_prev_edge_id);
+}
 
-    edge_t e;
-    unsigned int i;
-    while (cur_pos != pos) {  /* this signifies that we have hit the end */
-        vertex_t ver = g_vertex_get(g, ret[cur_pos]);
-        g_iterate_edges(ver, e, i) {
-            id = g_edge_dest(e);
-            if (CHECK_BIT(bitarray, id) != 0)
-                continue;  /* already visited */
-            SET_BIT(bitarray, id);
-            ret[pos++] = id;
-        }
-        ++cur_pos;
-    }
+double* g_vertex_prop_double(graph_t g, const char* name) {
+    return (double*)g_vertex_prop(g, name, GRAPH_PROP_DOUBLE);
+}
 
-    free(bitarray);
-    *size = pos;
-    return ret;
+double* g_edge_prop_double(graph_t g, const char* name) {
+    return (double*)g_edge_prop(g, name, GRAPH_PROP_DOUBLE);
 }
 
+long long* g_vertex_prop_int(graph_t g, const char* name) {
+    return (long long*)g_vertex_prop(g, name, GRAPH_PROP_INT);
+}
 
-unsigned int* g_depth_first_traverse(graph_t g, vertex_t v, unsigned int* size) {
-    *size = 0;
-    unsigned int* ret = (unsigned int*)calloc(g_num_vertices(g), sizeof(unsigned int));
-    char* bitarray = (char*)calloc(CEILING(g_vertices_inserted(g), 8), sizeof(char));
-    unsigned int id = g_vertex_id(v);
-    SET_BIT(bitarray, id);
-    ret[0] = id;
-    *size = *size + 1;
-    __traverse_depth_first(g, ret, bitarray, size);
-    free(bitarray);
-    return ret;
+long long* g_edge_prop_int(graph_t g, const char* name) {
+    return (long long*)g_edge_prop(g, name, GRAPH_PROP_INT);
 }
 
+unsigned int* g_vertex_prop_uint(graph_t g, const char* name) {
+    return (unsigned int*)g_vertex_prop(g, name, GRAPH_PROP_UINT);
+}
 
-static void __traverse_depth_first(graph_t g, unsigned int* res, char* bitarray, unsigned int* size) {
-    vertex_t v = g_vertex_get(g, res[*size - 1]);
-    // cppcheck-suppress variableScope
-    edge_t e;
-    unsigned int i, id;
-    g_iterate_edges(v, e, i) {
-        id = g_edge_dest(e);
-        if (CHECK_BIT(bitarray, id) != 0)
-            continue;  /* already visited */
-        SET_BIT(bitarray, id);
-        res[*size] = id;
-        *size = *size + 1;
-        __traverse_depth_first(g, res, bitarray, size);
-    }
+unsigned int* g_edge_prop_uint(graph_t g, const char* name) {
+    return (unsigned int*)g_edge_prop(g, name, GRAPH_PROP_UINT);
 }
 
-static void __graph_vertices_grow(graph_t g, unsigned int id) {
-    /*  in parallel code, the work may have been done by another thread, so
-        it should be checked one more time */
-    if (id < g->_max_verts)
-        return;
+graph_id_t* g_vertex_prop_id(graph_t g, const char* name) {
+    return (graph_id_t*)g_vertex_prop(g, name, GRAPH_PROP_ID);
+}
+
+graph_id_t* g_edge_prop_id(graph_t g, const char* name) {
+    return (graph_id_t*)g_edge_prop(g, name, GRAPH_PROP_ID);
+}
+
+bool g_vertex_prop_remove(graph_t g, const char* name) {
+    return __prop_remove(&g->_vertex_props, name);
+}
+
+bool g_edge_prop_remove(graph_t g, const char* name) {
+    return __prop_remove(&g->_edge_props, name);
+}
+
+/* find or add the column, making sure it holds at least needed values */
+static void* __prop(PropList* l, const char* name, unsigned int type, size_t needed) {
+    size_t width = __prop_value_size(type);
+    if (width == 0 || name == NULL)
+        return NULL;
+
+    PropColumn* c = NULL;
+    graph_id_t i;
+    for (i = 0; i < l->num; ++i) {
+        if (strcmp(l->columns[i].name, name) == 0) {
+            c = &l->columns[i];
+            break;
+        }
+    }
+    if (c == NULL) {
+        PropColumn* tmp = (PropColumn*)realloc(l->columns, (l->num + 1) * sizeof(PropColumn));
+        if (tmp == NULL)
+            return NULL;
+        l->columns = tmp;
+        size_t len = strlen(name) + 1;
+        char* copy = (char*)malloc(len);
+        if (copy == NULL)
+            return NULL;
+        memcpy(copy, name, len);
+        c = &l->columns[l->num++];
+        c->name = copy;
+        c->type = type;
+        c->size = 0;
+        c->values = NULL;
+    } else if (c->type != type) {
+        return NULL;
+    }
 
-    /*  need to expand the verts!
-        NOTE: ensure that we are growing enough to capture idx and
-        not just double... */
-    unsigned int new_num_verts = g->_max_verts * 2;
-    while (new_num_verts < id) {
-        new_num_verts *= 2;
+    /* grow by doubling so adding a few ids at a time stays cheap */
+    if (needed > c->size || c->values == NULL) {
+        size_t size = (c->size * 2 > needed) ? c->size * 2 : needed;
+        if (size == 0)
+            size = 1;
+        void* tmp = realloc(c->values, size * width);
+        if (tmp == NULL)
+            return NULL;
+        memset((char*)tmp + c->size * width, 0, (size - c->size) * width);
+        c->values = tmp;
+        c->size = size;
+    }
+    return c->values;
+}
+
+static bool __prop_remove(PropList* l, const char* name) {
+    graph_id_t i;
+    for (i = 0; i < l->num; ++i) {
+        if (strcmp(l->columns[i].name, name) != 0)
+            continue;
+        free(l->columns[i].name);
+        free(l->columns[i].values);
+        l->columns[i] = l->columns[--l->num];
+        return true;
     }
+    return false;
+}
 
-    vertex_t* tmp = (vertex_t*)realloc(g->verts, new_num_verts * sizeof(vertex_t));
-    g->verts = tmp;
+static void __props_free(PropList* l) {
+    graph_id_t i;
+    for (i = 0; i < l->num; ++i) {
+        free(l->columns[i].name);
+        free(l->columns[i].values);
+    }
+    free(l->columns);
+    l->columns = NULL;
+    l->num = 0;
+}
 
-    /* ensure everything in the new memory space is NULL if not used */
-    unsigned int i;
-    for (i = g->_max_verts; i < new_num_verts; ++i) {
-        g->verts[i] = NULL;
+/* move the values of every column to the new ids; nothing changes on failure */
+static bool __props_permute(PropList* l, const graph_id_t* map, graph_id_t n, graph_id_t num) {
+    void** values = (void**)malloc((l->num + 1) * sizeof(void*));
+    if (values == NULL)
+        return false;
+    graph_id_t i, k;
+    for (k = 0; k < l->num; ++k) {
+        values[k] = calloc(num + 1, __prop_value_size(l->columns[k].type));
+        if (values[k] == NULL) {
+            while (k > 0)
+                free(values[--k]);
+            free(values);
+            return false;
+        }
+    }
+    for (k = 0; k < l->num; ++k) {
+        PropColumn* c = &l->columns[k];
+        size_t width = __prop_value_size(c->type);
+        for (i = 0; i < n && i < c->size; ++i) {
+            if (map[i] != GRAPH_INVALID_ID)
+                memcpy((char*)values[k] + (size_t)map[i] * width, (char*)c->values + (size_t)i * width, width);
+        }
+        free(c->values);
+        c->values = values[k];
+        c->size = num + 1;
     }
-    g->_max_verts = new_num_verts;
+    free(values);
+    return true;
 }
 
-static void __graph_edges_grow(graph_t g, unsigned int id) {
-    /*  in parallel code, the work may have been done by another thread, so
-        it should be checked one more time */
-    if (id < g->_max_edges)
-        return;
+static size_t __prop_value_size(unsigned int type) {
+    if (type == GRAPH_PROP_DOUBLE)
+        return sizeof(double);
+    if (type == GRAPH_PROP_INT)
+        return sizeof(long long);
+    if (type == GRAPH_PROP_UINT)
+        return sizeof(unsigned int);
+    if (type == GRAPH_PROP_ID)
+        return sizeof(graph_id_t);
+    return 0;
+}
 
-    /* need to expand the edges! */
-    unsigned int new_num_edges = g->_max_edges * 2; /* double */
-    edge_t* tmp = (edge_t*)realloc(g->edges, new_num_edges * sizeof(edge_t));
-    g->edges = tmp;
+/*******************************************************************************
+*   snapshot reads
+*******************************************************************************/
+bool g_snapshots_enable(graph_t g, bool enable) {
+    graph_id_t i;
+    if (!enable) {
+        g->_snapshots = false;
+        __reclaim(g, true);
+        for (i = 0; i < g->_prev_vert_id; ++i) {
+            vertex_t v = __vertex_at(g, i);
+            if (v == NULL)
+                continue;
+            free(v->_snapshot);
+            free(v->_snapshot_in);
+            v->_snapshot = NULL;
+            v->_snapshot_in = NULL;
+        }
+        return true;
+    }
+    if (g->_snapshots)
+        return true;
 
-    /* ensure everything in the new memory space is NULL if not used */
-    unsigned int i;
-    for (i = g->_prev_edge_id - 1; i < new_num_edges; ++i) {
-        g->edges[i] = NULL;
+    g->_snapshots = true;
+    for (i = 0; i < g->_prev_vert_id; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        if (v == NULL)
+            continue;
+        __snapshot_publish(g, v, false);
+        __snapshot_publish(g, v, true);
+        if ((v->num_edges_out > 0 && v->_snapshot == NULL) || (v->num_edges_in > 0 && v->_snapshot_in == NULL)) {
+            g_snapshots_enable(g, false);
+            return false;
+        }
     }
-    g->_max_edges = new_num_edges;
+    return true;
 }
 
-static void __vertex_edges_grow(vertex_t v_src, unsigned int outs) {
-    if (outs < v_src->_max_edges)
-        return;
+graph_id_t g_read_begin(graph_t g) {
+    graph_id_t i;
+    for (i = 0; i < GRAPH_MAX_READERS; ++i) {
+        unsigned long long none = 0, epoch = ATOMIC_LOAD(g->_epoch);
+        /*  pinning an epoch that has since moved on only keeps more memory
+            around for a little longer */
+        if (ATOMIC_LOAD(g->_readers[i]) == 0 && ATOMIC_CAS(&g->_readers[i], &none, &epoch))
+            return i;
+    }
+    return GRAPH_INVALID_ID;
+}
 
-    unsigned int new_num_edges = v_src->_max_edges * 2;  /* double */
-    edge_t* tmp = (edge_t*)realloc(v_src->edges, new_num_edges * sizeof(edge_t));
-    unsigned int i;
-    for (i = outs; i < new_num_edges; ++i)
+void g_read_end(graph_t g, graph_id_t reader) {
+    if (reader < GRAPH_MAX_READERS)
+        ATOMIC_STORE(g->_readers[reader], 0ULL);
+}
+
+const edge_t* g_vertex_edges_snapshot(vertex_t v, unsigned int* len) {
+    EdgeBlock* b = ATOMIC_LOAD(v->_snapshot);
+    *len = (b == NULL) ? 0 : b->num;
+    return (*len == 0) ? NULL : b->edges;
+}
+
+const edge_t* g_vertex_edges_in_snapshot(vertex_t v, unsigned int* len) {
+    EdgeBlock* b = ATOMIC_LOAD(v->_snapshot_in);
+    *len = (b == NULL) ? 0 : b->num;
+    return (*len == 0) ? NULL : b->edges;
+}
+
+void g_edge_retire(graph_t g, edge_t e, bool free_metadata) {
+    if (e == NULL)
+        return;
+    if (!g->_snapshots) {
+        g_edge_free_alt(e, free_metadata);
+        return;
+    }
+    __retire(g, e, RETIRED_EDGE, free_metadata);
+}
+
+void g_vertex_retire(graph_t g, vertex_t v, bool free_metadata) {
+    if (v == NULL)
+        return;
+    if (!g->_snapshots) {
+        g_vertex_free_alt(v, free_metadata);
+        return;
+    }
+    __retire(g, v, RETIRED_VERTEX, free_metadata);
+}
+
+size_t g_reclaim(graph_t g) {
+    SPIN_LOCK(g->_retire_lock);
+    size_t num = __reclaim(g, false);
+    SPIN_UNLOCK(g->_retire_lock);
+    return num;
+}
+
+/*  copy the edges out of (or into) v to a new block and swap it in for readers;
+    the caller holds the lock of v */
+static void __snapshot_publish(graph_t g, vertex_t v, bool in) {
+    graph_id_t num = (in) ? v->num_edges_in : v->num_edges_out;
+    EdgeBlock* b = NULL;
+    if (num > 0) {
+        b = (EdgeBlock*)malloc(sizeof(EdgeBlock) + num * sizeof(edge_t));
+        if (b == NULL)
+            return;  /* readers keep seeing the last published edges */
+        b->num = num;
+        b->edges = (edge_t*)(b + 1);
+        memcpy(b->edges, (in) ? v->edges_in : v->edges, num * sizeof(edge_t));
+    }
+
+    EdgeBlock* old = (in) ? v->_snapshot_in : v->_snapshot;
+    if (in)
+        ATOMIC_STORE(v->_snapshot_in, b);
+    else
+        ATOMIC_STORE(v->_snapshot, b);
+    if (old != NULL)
+        __retire(g, old, RETIRED_BLOCK, false);
+}
+
+static void __retire(graph_t g, void* ptr, unsigned int kind, bool free_metadata) {
+    /*  readers that start after the epoch moves on can no longer reach ptr;
+        ptr can be freed once every reader that pinned this epoch, or an
+        earlier one, has finished */
+    unsigned long long epoch = ATOMIC_FETCH_ADD(g->_epoch);
+
+    SPIN_LOCK(g->_retire_lock);
+    if (g->_num_retired == g->_max_retired && __reclaim(g, false) == 0) {
+        size_t size = (g->_max_retired == 0) ? 64 : g->_max_retired * 2;
+        Retired* tmp = (Retired*)realloc(g->_retired, size * sizeof(Retired));
+        if (tmp == NULL) {
+            /* nowhere to keep it; leak it rather than free it under a reader */
+            SPIN_UNLOCK(g->_retire_lock);
+            return;
+        }
+        g->_retired = tmp;
+        g->_max_retired = size;
+    }
+    Retired* r = &g->_retired[g->_num_retired++];
+    r->ptr = ptr;
+    r->kind = kind;
+    r->free_metadata = free_metadata;
+    r->epoch = epoch;
+    SPIN_UNLOCK(g->_retire_lock);
+}
+
+/* free the retired items no reader can see (or all of them); the caller holds the retire lock */
+static size_t __reclaim(graph_t g, bool all) {
+    unsigned long long oldest = ATOMIC_LOAD(g->_epoch);
+    graph_id_t i;
+    for (i = 0; i < GRAPH_MAX_READERS; ++i) {
+        unsigned long long pinned = ATOMIC_LOAD(g->_readers[i]);
+        if (pinned != 0 && pinned < oldest)
+            oldest = pinned;
+    }
+
+    size_t j, kept = 0, num = 0;
+    for (j = 0; j < g->_num_retired; ++j) {
+        Retired* r = &g->_retired[j];
+        if (!all && r->epoch >= oldest) {
+            g->_retired[kept++] = *r;
+            continue;
+        }
+        if (r->kind == RETIRED_EDGE)
+            g_edge_free_alt((edge_t)r->ptr, r->free_metadata);
+        else if (r->kind == RETIRED_VERTEX)
+            g_vertex_free_alt((vertex_t)r->ptr, r->free_metadata);
+        else
+            free(r->ptr);
+        ++num;
+    }
+    g->_num_retired = kept;
+    return num;
+}
+
+
+/*******************************************************************************
+*   traversals
+*******************************************************************************/
+graph_id_t* g_breadth_first_traverse(graph_t g, vertex_t v, graph_id_t* size) {
+    *size = 0;
+    graph_id_t* ret = (graph_id_t*)calloc(g_num_vertices(g), sizeof(graph_id_t));
+    graph_workspace_t w = g_workspace_init(g);
+    if (ret != NULL && w != NULL)
+        *size = g_breadth_first_traverse_alt(g, v, w, ret, g_num_vertices(g));
+    g_workspace_free(w);
+    return ret;
+}
+
+
+graph_id_t* g_depth_first_traverse(graph_t g, vertex_t v, graph_id_t* size) {
+    *size = 0;
+    graph_id_t* ret = (graph_id_t*)calloc(g_num_vertices(g), sizeof(graph_id_t));
+    graph_workspace_t w = g_workspace_init(g);
+    if (ret != NULL && w != NULL)
+        *size = g_depth_first_traverse_alt(g, v, w, ret, g_num_vertices(g));
+    g_workspace_free(w);
+    return ret;
+}
+
+graph_workspace_t g_workspace_init(graph_t g) {
+    graph_workspace_t w = (graph_workspace_t)calloc(1, sizeof(Workspace));
+    if (w == NULL)
+        return NULL;
+    w->size = 0;
+    w->epoch = 0;
+    w->visited = NULL;
+    w->ids = NULL;
+    w->pos = NULL;
+    if (!__workspace_begin(w, (g == NULL) ? 0 : g->_prev_vert_id)) {
+        g_workspace_free(w);
+        return NULL;
+    }
+    return w;
+}
+
+void g_workspace_free(graph_workspace_t w) {
+    if (w == NULL)
+        return;
+    free(w->visited);
+    free(w->ids);
+    free(w->pos);
+    free(w);
+}
+
+bool g_workspace_visited(graph_workspace_t w, graph_id_t id) {
+    return id < w->size && w->visited[id] == w->epoch;
+}
+
+graph_id_t g_breadth_first_visit(graph_t g, vertex_t v, graph_workspace_t w, g_visit_t visit, void* data) {
+    if (v == NULL || !__workspace_begin(w, g->_prev_vert_id))
+        return 0;
+
+    graph_id_t head = 0, tail = 0;
+    unsigned int epoch = w->epoch;
+    w->visited[v->id] = epoch;
+    w->ids[tail++] = v->id;
+    if (visit != NULL && !visit(v, data))
+        return tail;
+
+    while (head < tail) {
+        vertex_t vu = __vertex_at(g, w->ids[head++]);
+        graph_id_t i;
+        for (i = 0; i < vu->num_edges_out; ++i) {
+            graph_id_t id = vu->edges[i]->dest;
+            if (w->visited[id] == epoch)
+                continue;  /* already visited */
+            w->visited[id] = epoch;
+            w->ids[tail++] = id;
+            if (visit != NULL && !visit(__vertex_at(g, id), data))
+                return tail;
+        }
+    }
+    return tail;
+}
+
+graph_id_t g_depth_first_visit(graph_t g, vertex_t v, graph_workspace_t w, g_visit_t visit, void* data) {
+    if (v == NULL || !__workspace_begin(w, g->_prev_vert_id))
+        return 0;
+
+    /*  an explicit stack of vertices with the next edge to follow, giving the
+        same order as recursing on each edge in turn */
+    graph_id_t top = 0, count = 1;
+    unsigned int epoch = w->epoch;
+    w->visited[v->id] = epoch;
+    if (visit != NULL && !visit(v, data))
+        return count;
+    w->ids[top] = v->id;
+    w->pos[top++] = 0;
+
+    while (top > 0) {
+        vertex_t vu = __vertex_at(g, w->ids[top - 1]);
+        graph_id_t i = w->pos[top - 1]++;
+        if (i >= vu->num_edges_out) {
+            --top;
+            continue;
+        }
+        graph_id_t id = vu->edges[i]->dest;
+        if (w->visited[id] == epoch)
+            continue;  /* already visited */
+        w->visited[id] = epoch;
+        ++count;
+        if (visit != NULL && !visit(__vertex_at(g, id), data))
+            return count;
+        w->ids[top] = id;
+        w->pos[top++] = 0;
+    }
+    return count;
+}
+
+graph_id_t g_breadth_first_traverse_alt(graph_t g, vertex_t v, graph_workspace_t w, graph_id_t* res, graph_id_t len) {
+    if (len == 0)
+        return 0;
+    VisitBuffer b;
+    b.res = res;
+    b.len = len;
+    b.size = 0;
+    g_breadth_first_visit(g, v, w, __visit_buffer, &b);
+    return b.size;
+}
+
+graph_id_t g_depth_first_traverse_alt(graph_t g, vertex_t v, graph_workspace_t w, graph_id_t* res, graph_id_t len) {
+    if (len == 0)
+        return 0;
+    VisitBuffer b;
+    b.res = res;
+    b.len = len;
+    b.size = 0;
+    g_depth_first_visit(g, v, w, __visit_buffer, &b);
+    return b.size;
+}
+
+graph_id_t* g_shortest_path(graph_t g, graph_id_t src, graph_id_t dst, graph_id_t* len) {
+    graph_workspace_t w = g_workspace_init(g);
+    if (w == NULL) {
+        *len = 0;
+        return NULL;
+    }
+    graph_id_t* ret = g_shortest_path_alt(g, src, dst, w, len);
+    g_workspace_free(w);
+    return ret;
+}
+
+graph_id_t* g_shortest_path_alt(graph_t g, graph_id_t src, graph_id_t dst, graph_workspace_t w, graph_id_t* len) {
+    *len = 0;
+    if (g_vertex_get(g, src) == NULL || g_vertex_get(g, dst) == NULL)
+        return NULL;
+    if (src == dst) {
+        graph_id_t* ret = (graph_id_t*)malloc(sizeof(graph_id_t));
+        if (ret == NULL)
+            return NULL;
+        ret[0] = src;
+        *len = 1;
+        return ret;
+    }
+
+    /*  each side needs its own mark; start two traversals (and a third should
+        the epoch wrap in between) so that epoch - 1 is free for the forward
+        search and epoch for the backward search */
+    if (!__workspace_begin(w, g->_prev_vert_id) || !__workspace_begin(w, g->_prev_vert_id))
+        return NULL;
+    if (w->epoch == 1 && !__workspace_begin(w, g->_prev_vert_id))
+        return NULL;
+    unsigned int fwd = w->epoch - 1, bwd = w->epoch;
+    graph_id_t n = w->size;
+
+    /*  a vertex is only ever reached by one side, so the forward queue can fill
+        ids from the front and the backward queue from the back; pos holds the
+        parent of a vertex reached forward and the successor of one reached
+        backward */
+    graph_id_t f_head = 0, f_tail = 0, b_head = 0, b_tail = 0;
+    w->visited[src] = fwd;
+    w->pos[src] = GRAPH_INVALID_ID;
+    w->ids[f_tail++] = src;
+    w->visited[dst] = bwd;
+    w->pos[dst] = GRAPH_INVALID_ID;
+    w->ids[n - 1 - b_tail++] = dst;
+
+    /*  expand a whole level of the smaller frontier at a time; every meeting
+        found within a level gives a path of the same length, so the first one
+        found is a shortest path */
+    while (f_head < f_tail && b_head < b_tail) {
+        graph_id_t i, end;
+        if (f_tail - f_head <= b_tail - b_head) {
+            for (end = f_tail; f_head < end; ++f_head) {
+                vertex_t vu = __vertex_at(g, w->ids[f_head]);
+                for (i = 0; i < vu->num_edges_out; ++i) {
+                    graph_id_t id = vu->edges[i]->dest;
+                    if (w->visited[id] == bwd)
+                        return __path_build(w, vu->id, id, len);
+                    if (w->visited[id] == fwd)
+                        continue;
+                    w->visited[id] = fwd;
+                    w->pos[id] = vu->id;
+                    w->ids[f_tail++] = id;
+                }
+            }
+        } else {
+            for (end = b_tail; b_head < end; ++b_head) {
+                vertex_t vu = __vertex_at(g, w->ids[n - 1 - b_head]);
+                for (i = 0; i < vu->num_edges_in; ++i) {
+                    graph_id_t id = vu->edges_in[i]->src;
+                    if (w->visited[id] == fwd)
+                        return __path_build(w, id, vu->id, len);
+                    if (w->visited[id] == bwd)
+                        continue;
+                    w->visited[id] = bwd;
+                    w->pos[id] = vu->id;
+                    w->ids[n - 1 - b_tail++] = id;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+graph_id_t* g_multi_source_bfs(graph_t g, const graph_id_t* sources, graph_id_t num_sources) {
+    size_t n = g->_prev_vert_id, i;
+    graph_id_t* dist = (graph_id_t*)malloc((n * num_sources + 1) * sizeof(graph_id_t));
+    if (dist == NULL)
+        return NULL;
+    for (i = 0; i < n * num_sources; ++i)
+        dist[i] = GRAPH_INVALID_ID;
+    if (!__multi_source_bfs(g, sources, num_sources, dist, NULL, NULL)) {
+        free(dist);
+        return NULL;
+    }
+    return dist;
+}
+
+bool g_multi_source_bfs_sums(graph_t g, const graph_id_t* sources, graph_id_t num_sources, unsigned long long* sums, graph_id_t* reached) {
+    graph_id_t i;
+    for (i = 0; i < num_sources; ++i) {
+        if (sums != NULL)
+            sums[i] = 0;
+        if (reached != NULL)
+            reached[i] = 0;
+    }
+    return __multi_source_bfs(g, sources, num_sources, NULL, sums, reached);
+}
+
+static bool __multi_source_bfs(graph_t g, const graph_id_t* sources, graph_id_t num_sources, graph_id_t* dist, unsigned long long* sums, graph_id_t* reached) {
+    if (num_sources == 0)
+        return true;
+    graph_csr_t c = g_csr_init(g);
+    if (c == NULL)
+        return false;
+
+    /*  bit j of each set is for the j-th source in the current batch: seen
+        is every vertex the search has reached, visit is the current frontier
+        and next is the one being built */
+    graph_id_t n = c->num_verts;
+    uint64_t* seen = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    uint64_t* visit = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    uint64_t* next = (uint64_t*)malloc((n + 1) * sizeof(uint64_t));
+    if (seen == NULL || visit == NULL || next == NULL) {
+        free(seen);
+        free(visit);
+        free(next);
+        g_csr_free(c);
+        return false;
+    }
+
+    graph_id_t base;
+    for (base = 0; base < num_sources; base += 64) {
+        graph_id_t batch = (num_sources - base < 64) ? num_sources - base : 64, j;
+        memset(seen, 0, n * sizeof(uint64_t));
+        memset(visit, 0, n * sizeof(uint64_t));
+        for (j = 0; j < batch; ++j) {
+            graph_id_t s = sources[base + j];
+            if (s >= n || c->exists[s] == 0)
+                continue;
+            seen[s] |= (uint64_t)1 << j;
+            visit[s] |= (uint64_t)1 << j;
+            if (dist != NULL)
+                dist[(size_t)(base + j) * n + s] = 0;
+            if (reached != NULL)
+                ++reached[base + j];
+        }
+
+        graph_id_t level = 0;
+        bool more = true;
+        while (more) {
+            ++level;
+            more = false;
+            graph_id_t v;
+            /*  pull from the edges into each vertex so that every vertex is
+                only written by one thread; the totals are kept per thread */
+            #pragma omp parallel
+            {
+                unsigned long long local_sums[64];
+                graph_id_t local_reached[64];
+                memset(local_sums, 0, sizeof(local_sums));
+                memset(local_reached, 0, sizeof(local_reached));
+                bool local_more = false;
+
+                #pragma omp for schedule(dynamic, 256)
+                for (v = 0; v < n; ++v) {
+                    uint64_t bits = 0;
+                    graph_id_t k;
+                    for (k = c->in_offsets[v]; k < c->in_offsets[v + 1]; ++k)
+                        bits |= visit[c->sources[k]];
+                    bits &= ~seen[v];
+                    next[v] = bits;
+                    if (bits == 0)
+                        continue;
+                    seen[v] |= bits;
+                    local_more = true;
+                    while (bits != 0) {
+                        graph_id_t b = __lowest_bit(bits);
+                        bits &= bits - 1;
+                        if (dist != NULL)
+                            dist[(size_t)(base + b) * n + v] = level;
+                        local_sums[b] += level;
+                        ++local_reached[b];
+                    }
+                }
+
+                CRITICAL
+                {
+                    if (local_more)
+                        more = true;
+                    graph_id_t t;
+                    for (t = 0; t < batch; ++t) {
+                        if (sums != NULL)
+                            sums[base + t] += local_sums[t];
+                        if (reached != NULL)
+                            reached[base + t] += local_reached[t];
+                    }
+                }
+            }
+            uint64_t* tmp = visit;
+            visit = next;
+            next = tmp;
+        }
+    }
+
+    free(seen);
+    free(visit);
+    free(next);
+    g_csr_free(c);
+    return true;
+}
+
+static graph_id_t __lowest_bit(uint64_t x) {
+#if defined (__GNUC__)
+    return (graph_id_t)__builtin_ctzll(x);
+#else
+    graph_id_t i = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+static unsigned int __popcount(uint64_t x) {
+#if defined (__GNUC__)
+    return (unsigned int)__builtin_popcountll(x);
+#else
+    graph_id_t i = 0;
+    for (; x != 0; x &= x - 1)
+        ++i;
+    return i;
+#endif
+}
+
+static unsigned int __degree_bucket(unsigned int degree) {
+    unsigned int k = 0;
+    while (degree != 0) {
+        degree >>= 1;
+        ++k;
+    }
+    return k;
+}
+
+static bool __workspace_begin(graph_workspace_t w, graph_id_t n) {
+    if (n > w->size || w->visited == NULL) {
+        graph_id_t size = (n > 0) ? n : 1;
+        unsigned int* visited = (unsigned int*)realloc(w->visited, size * sizeof(unsigned int));
+        if (visited == NULL)
+            return false;
+        w->visited = visited;
+        graph_id_t* ids = (graph_id_t*)realloc(w->ids, size * sizeof(graph_id_t));
+        if (ids == NULL)
+            return false;
+        w->ids = ids;
+        graph_id_t* pos = (graph_id_t*)realloc(w->pos, size * sizeof(graph_id_t));
+        if (pos == NULL)
+            return false;
+        w->pos = pos;
+        memset(w->visited + w->size, 0, (size - w->size) * sizeof(unsigned int));
+        w->size = size;
+    }
+
+    /* only once every 4 billion traversals do the marks need to be cleared */
+    if (++w->epoch == 0) {
+        memset(w->visited, 0, w->size * sizeof(unsigned int));
+        w->epoch = 1;
+    }
+    return true;
+}
+
+static bool __visit_buffer(vertex_t v, void* data) {
+    VisitBuffer* b = (VisitBuffer*)data;
+    b->res[b->size++] = v->id;
+    return b->size < b->len;
+}
+
+/* join the parents of a back to the source with the successors of b to the destination */
+static graph_id_t* __path_build(graph_workspace_t w, graph_id_t a, graph_id_t b, graph_id_t* len) {
+    graph_id_t num_a = 0, num_b = 0, id;
+    for (id = a; id != GRAPH_INVALID_ID; id = w->pos[id])
+        ++num_a;
+    for (id = b; id != GRAPH_INVALID_ID; id = w->pos[id])
+        ++num_b;
+
+    graph_id_t* ret = (graph_id_t*)malloc((num_a + num_b) * sizeof(graph_id_t));
+    if (ret == NULL)
+        return NULL;
+    graph_id_t i = num_a;
+    for (id = a; id != GRAPH_INVALID_ID; id = w->pos[id])
+        ret[--i] = id;
+    i = num_a;
+    for (id = b; id != GRAPH_INVALID_ID; id = w->pos[id])
+        ret[i++] = id;
+    *len = num_a + num_b;
+    return ret;
+}
+
+/*******************************************************************************
+*   weighted shortest paths
+*******************************************************************************/
+#define HEAP_ARITY 4
+#define DELTA_MAX_BUCKETS 65536
+#define DELTA_BUCKET(d, delta)  ((unsigned long long)((d) / (delta)))
+
+double* g_dijkstra(graph_t g, vertex_t v, g_edge_weight_t weight, graph_id_t** previous) {
+    return __dijkstra(g, v, weight, NULL, previous);
+}
+
+double* g_dijkstra_alt(graph_t g, vertex_t v, const double* weights, graph_id_t** previous) {
+    return __dijkstra(g, v, NULL, weights, previous);
+}
+
+double* g_delta_stepping(graph_t g, vertex_t v, g_edge_weight_t weight, double delta, graph_id_t** previous) {
+    return __delta_stepping(g, v, weight, NULL, delta, previous);
+}
+
+double* g_delta_stepping_alt(graph_t g, vertex_t v, const double* weights, double delta, graph_id_t** previous) {
+    return __delta_stepping(g, v, NULL, weights, delta, previous);
+}
+
+static double* __dijkstra(graph_t g, vertex_t v, g_edge_weight_t weight, const double* weights, graph_id_t** previous) {
+    if (previous != NULL)
+        *previous = NULL;
+    if (v == NULL)
+        return NULL;
+
+    graph_id_t n = g->_prev_vert_id;
+    double* dist = (double*)malloc(n * sizeof(double));
+    graph_id_t* prev = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* heap = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* pos = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    if (dist == NULL || prev == NULL || heap == NULL || pos == NULL) {
+        free(dist);
+        free(prev);
+        free(heap);
+        free(pos);
+        return NULL;
+    }
+
+    graph_id_t i;
+    for (i = 0; i < n; ++i) {
+        dist[i] = INFINITY;
+        prev[i] = GRAPH_INVALID_ID;
+        pos[i] = GRAPH_INVALID_ID;
+    }
+
+    DaryHeap h = {heap, pos, 0, dist};
+    dist[v->id] = 0.0;
+    __heap_push(&h, v->id);
+
+    bool negative = false;
+    while (h.size > 0 && negative == false) {
+        graph_id_t u = __heap_pop(&h);
+        vertex_t vu = __vertex_at(g, u);
+        edge_t e;
+        g_iterate_edges(vu, e, i) {
+            double w = __edge_weight(e, weight, weights);
+            if (w < 0.0) {
+                negative = true;
+                break;
+            }
+            double alt = dist[u] + w;
+            graph_id_t d = e->dest;
+            if (alt < dist[d]) {
+                dist[d] = alt;
+                prev[d] = u;
+                if (pos[d] == GRAPH_INVALID_ID)
+                    __heap_push(&h, d);
+                else
+                    __heap_sift_up(&h, pos[d]);
+            }
+        }
+    }
+    free(heap);
+    free(pos);
+
+    if (negative == true) {
+        free(dist);
+        free(prev);
+        return NULL;
+    }
+    if (previous != NULL)
+        *previous = prev;
+    else
+        free(prev);
+    return dist;
+}
+
+static double* __delta_stepping(graph_t g, vertex_t v, g_edge_weight_t weight, const double* weights, double delta, graph_id_t** previous) {
+    if (previous != NULL)
+        *previous = NULL;
+    if (v == NULL)
+        return NULL;
+
+    /*  find the largest and mean weights; the largest weight bounds how far
+        ahead of the current bucket a tentative distance can be, which lets
+        the buckets be reused cyclically */
+    double max_w = 0.0, sum_w = 0.0;
+    graph_id_t i;
+    for (i = 0; i < g->_prev_edge_id; ++i) {
+        edge_t e = __edge_at(g, i);
+        if (e == NULL)
+            continue;
+        double w = __edge_weight(e, weight, weights);
+        if (w < 0.0)
+            return NULL;
+        if (w > max_w)
+            max_w = w;
+        sum_w += w;
+    }
+    if (delta <= 0.0)
+        delta = (sum_w > 0.0) ? sum_w / g->num_edges : 1.0;
+    if (max_w / delta > DELTA_MAX_BUCKETS)
+        delta = max_w / DELTA_MAX_BUCKETS;
+    graph_id_t num_buckets = (graph_id_t)(max_w / delta) + 2;
+
+    graph_id_t n = g->_prev_vert_id;
+    int num_threads = NUM_THREADS();
+    double* dist = (double*)malloc(n * sizeof(double));
+    graph_id_t* frontier_stamp = (graph_id_t*)calloc(n, sizeof(graph_id_t));
+    graph_id_t* settled_stamp = (graph_id_t*)calloc(n, sizeof(graph_id_t));
+    IdList* buckets = (IdList*)calloc(num_buckets, sizeof(IdList));
+    IdList* updates = (IdList*)calloc(num_threads, sizeof(IdList));
+    IdList frontier = {NULL, 0, 0};
+    IdList settled = {NULL, 0, 0};
+    if (dist == NULL || frontier_stamp == NULL || settled_stamp == NULL || buckets == NULL || updates == NULL) {
+        free(dist);
+        free(frontier_stamp);
+        free(settled_stamp);
+        free(buckets);
+        free(updates);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i)
+        dist[i] = INFINITY;
+
+    dist[v->id] = 0.0;
+    bool ok = __id_list_push(&buckets[0], v->id);
+    size_t pending = 1;
+    unsigned long long b = 0;
+    graph_id_t round = 0, phase = 0;
+    int t;
+
+    while (ok == true && pending > 0) {
+        IdList* bucket = &buckets[b % num_buckets];
+        settled.size = 0;
+        ++phase;
+
+        /* light edges can land back in this bucket, so repeat until empty */
+        while (ok == true && bucket->size > 0) {
+            frontier.size = 0;
+            ++round;
+            pending -= bucket->size;
+            for (i = 0; i < bucket->size; ++i) {
+                graph_id_t u = bucket->ids[i];
+                /* skip stale entries and duplicates */
+                if (DELTA_BUCKET(dist[u], delta) != b || frontier_stamp[u] == round)
+                    continue;
+                frontier_stamp[u] = round;
+                if (__id_list_push(&frontier, u) == false)
+                    ok = false;
+                if (settled_stamp[u] != phase) {
+                    settled_stamp[u] = phase;
+                    if (__id_list_push(&settled, u) == false)
+                        ok = false;
+                }
+            }
+            bucket->size = 0;
+
+            if (ok == true && __delta_relax(g, &frontier, dist, weight, weights, delta, true, updates) == false)
+                ok = false;
+            for (t = 0; t < num_threads; ++t) {
+                for (i = 0; ok == true && i < updates[t].size; ++i) {
+                    graph_id_t u = updates[t].ids[i];
+                    ok = __id_list_push(&buckets[DELTA_BUCKET(dist[u], delta) % num_buckets], u);
+                }
+                pending += updates[t].size;
+                updates[t].size = 0;
+            }
+        }
+
+        /* everything settled in this bucket is final; relax the heavy edges once */
+        if (ok == true && __delta_relax(g, &settled, dist, weight, weights, delta, false, updates) == false)
+            ok = false;
+        for (t = 0; t < num_threads; ++t) {
+            for (i = 0; ok == true && i < updates[t].size; ++i) {
+                graph_id_t u = updates[t].ids[i];
+                ok = __id_list_push(&buckets[DELTA_BUCKET(dist[u], delta) % num_buckets], u);
+            }
+            pending += updates[t].size;
+            updates[t].size = 0;
+        }
+        ++b;
+    }
+
+    for (i = 0; i < num_buckets; ++i)
+        free(buckets[i].ids);
+    for (t = 0; t < num_threads; ++t)
+        free(updates[t].ids);
+    free(buckets);
+    free(updates);
+    free(frontier.ids);
+    free(settled.ids);
+    free(frontier_stamp);
+    free(settled_stamp);
+
+    /* a bucket that could not grow would lose vertices, so the distances are incomplete */
+    if (ok == false) {
+        free(dist);
+        return NULL;
+    }
+    if (previous != NULL)
+        *previous = __shortest_path_tree(g, v->id, dist, weight, weights);
+    return dist;
+}
+
+static bool __delta_relax(graph_t g, const IdList* frontier, double* dist, g_edge_weight_t weight, const double* weights, double delta, bool light, IdList* updates) {
+    graph_id_t f, num = frontier->size;
+    bool ok = true;
+    #pragma omp parallel
+    {
+        IdList* out = &updates[THREAD_NUM()];
+        #pragma omp for schedule(dynamic, 16)
+        for (f = 0; f < num; ++f) {
+            graph_id_t u = frontier->ids[f];
+            double du, cur;
+            ATOMIC_READ(dist[u], du);
+            vertex_t vu = __vertex_at(g, u);
+            edge_t e;
+            graph_id_t i;
+            g_iterate_edges(vu, e, i) {
+                double w = __edge_weight(e, weight, weights);
+                if ((w <= delta) != light)
+                    continue;
+                double alt = du + w;
+                ATOMIC_READ(dist[e->dest], cur);
+                while (alt < cur) {  /* on failure, cur is updated to the new value */
+                    if (ATOMIC_CAS(&dist[e->dest], &cur, &alt)) {
+                        if (__id_list_push(out, e->dest) == false)
+                            ATOMIC_STORE(ok, false);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+static graph_id_t* __shortest_path_tree(graph_t g, graph_id_t src, const double* dist, g_edge_weight_t weight, const double* weights) {
+    /*  the parallel relaxations do not track who set each distance, so walk
+        the edges that are tight with the final distances from the start */
+    graph_id_t n = g->_prev_vert_id;
+    graph_id_t* prev = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* queue = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    if (prev == NULL || queue == NULL) {
+        free(prev);
+        free(queue);
+        return NULL;
+    }
+
+    graph_id_t i, head = 0, tail = 0;
+    for (i = 0; i < n; ++i)
+        prev[i] = GRAPH_INVALID_ID;
+    queue[tail++] = src;
+    while (head != tail) {
+        graph_id_t u = queue[head++];
+        vertex_t vu = __vertex_at(g, u);
+        edge_t e;
+        g_iterate_edges(vu, e, i) {
+            graph_id_t d = e->dest;
+            if (d == src || prev[d] != GRAPH_INVALID_ID)
+                continue;
+            if (dist[u] + __edge_weight(e, weight, weights) == dist[d]) {
+                prev[d] = u;
+                queue[tail++] = d;
+            }
+        }
+    }
+    free(queue);
+    return prev;
+}
+
+static double __edge_weight(edge_t e, g_edge_weight_t weight, const double* weights) {
+    if (weights != NULL)
+        return weights[e->id];
+    if (weight != NULL)
+        return weight(e);
+    return 1.0;
+}
+
+static void __heap_push(DaryHeap* h, graph_id_t id) {
+    h->heap[h->size] = id;
+    __heap_sift_up(h, h->size++);
+}
+
+static graph_id_t __heap_pop(DaryHeap* h) {
+    graph_id_t top = h->heap[0];
+    h->pos[top] = GRAPH_INVALID_ID;
+    if (--h->size > 0) {
+        h->heap[0] = h->heap[h->size];
+        __heap_sift_down(h, 0);
+    }
+    return top;
+}
+
+static void __heap_sift_up(DaryHeap* h, graph_id_t i) {
+    graph_id_t id = h->heap[i];
+    double key = h->keys[id];
+    while (i > 0) {
+        graph_id_t parent = (i - 1) / HEAP_ARITY;
+        graph_id_t p = h->heap[parent];
+        if (h->keys[p] <= key)
+            break;
+        h->heap[i] = p;
+        h->pos[p] = i;
+        i = parent;
+    }
+    h->heap[i] = id;
+    h->pos[id] = i;
+}
+
+static void __heap_sift_down(DaryHeap* h, graph_id_t i) {
+    graph_id_t id = h->heap[i];
+    double key = h->keys[id];
+    while (true) {
+        graph_id_t first = i * HEAP_ARITY + 1;
+        if (first >= h->size)
+            break;
+        graph_id_t last = (first + HEAP_ARITY < h->size) ? first + HEAP_ARITY : h->size;
+        graph_id_t c, best = first;
+        for (c = first + 1; c < last; ++c) {
+            if (h->keys[h->heap[c]] < h->keys[h->heap[best]])
+                best = c;
+        }
+        if (h->keys[h->heap[best]] >= key)
+            break;
+        h->heap[i] = h->heap[best];
+        h->pos[h->heap[i]] = i;
+        i = best;
+    }
+    h->heap[i] = id;
+    h->pos[id] = i;
+}
+
+static bool __id_list_push(IdList* l, graph_id_t id) {
+    if (l->size == l->_max) {
+        graph_id_t new_max = (l->_max == 0) ? 64 : l->_max * 2;
+        graph_id_t* tmp = (graph_id_t*)realloc(l->ids, new_max * sizeof(graph_id_t));
+        if (tmp == NULL)
+            return false;
+        l->ids = tmp;
+        l->_max = new_max;
+    }
+    l->ids[l->size++] = id;
+    return true;
+}
+
+/*******************************************************************************
+*   components
+*******************************************************************************/
+graph_id_t* g_connected_components(graph_t g, graph_id_t* num_components, graph_id_t** sizes) {
+    *num_components = 0;
+    if (sizes != NULL)
+        *sizes = NULL;
+
+    graph_id_t n = g->_prev_vert_id;
+    graph_id_t* parent = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* labels = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    if (parent == NULL || labels == NULL) {
+        free(parent);
+        free(labels);
+        return NULL;
+    }
+
+    graph_id_t i;
+    #pragma omp parallel for schedule(static)
+    for (i = 0; i < n; ++i)
+        parent[i] = i;
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (i = 0; i < g->_prev_edge_id; ++i) {
+        edge_t e = __edge_at(g, i);
+        if (e != NULL)
+            __uf_union(parent, e->src, e->dest);
+    }
+
+    /*  roots are always the lowest id in the component so they are labeled
+        before any of the other vertices in the component are reached */
+    graph_id_t num = 0, max_num = 64;
+    graph_id_t* counts = (graph_id_t*)malloc(max_num * sizeof(graph_id_t));
+    if (counts == NULL) {
+        free(parent);
+        free(labels);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        if (__vertex_at(g, i) == NULL) {
+            labels[i] = GRAPH_INVALID_ID;
+            continue;
+        }
+        graph_id_t root = __uf_find(parent, i);
+        if (root == i) {
+            if (num == max_num) {
+                graph_id_t* tmp = (graph_id_t*)realloc(counts, max_num * 2 * sizeof(graph_id_t));
+                if (tmp == NULL) {
+                    free(parent);
+                    free(labels);
+                    free(counts);
+                    return NULL;
+                }
+                counts = tmp;
+                max_num *= 2;
+            }
+            counts[num] = 0;
+            labels[i] = num++;
+        } else {
+            labels[i] = labels[root];
+        }
+        ++counts[labels[i]];
+    }
+    free(parent);
+
+    *num_components = num;
+    if (sizes != NULL)
+        *sizes = counts;
+    else
+        free(counts);
+    return labels;
+}
+
+graph_id_t* g_strongly_connected_components(graph_t g, graph_id_t* num_components, graph_t* condensation) {
+    *num_components = 0;
+    if (condensation != NULL)
+        *condensation = NULL;
+
+    /*  all the scratch space is allocated up front: the tarjan stack and the
+        explicit call stack (vertex and the next edge to look at) */
+    graph_id_t n = g->_prev_vert_id;
+    graph_id_t* comps = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* idx = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* low = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* stack = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* call_vert = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* call_edge = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    if (comps == NULL || idx == NULL || low == NULL || stack == NULL || call_vert == NULL || call_edge == NULL) {
+        free(comps);
+        free(idx);
+        free(low);
+        free(stack);
+        free(call_vert);
+        free(call_edge);
+        return NULL;
+    }
+
+    graph_id_t i;
+    for (i = 0; i < n; ++i) {
+        comps[i] = GRAPH_INVALID_ID;
+        idx[i] = GRAPH_INVALID_ID;
+    }
+
+    graph_id_t counter = 0, num = 0, stack_size = 0, call_size = 0, r;
+    for (r = 0; r < n; ++r) {
+        if (__vertex_at(g, r) == NULL || idx[r] != GRAPH_INVALID_ID)
+            continue;
+
+        idx[r] = low[r] = counter++;
+        stack[stack_size++] = r;
+        call_vert[call_size] = r;
+        call_edge[call_size++] = 0;
+
+        while (call_size > 0) {
+            graph_id_t v = call_vert[call_size - 1];
+            vertex_t vv = __vertex_at(g, v);
+            if (call_edge[call_size - 1] < vv->num_edges_out) {
+                edge_t e = vv->edges[call_edge[call_size - 1]++];
+                if (e == NULL)
+                    continue;
+                graph_id_t w = e->dest;
+                if (idx[w] == GRAPH_INVALID_ID) {
+                    idx[w] = low[w] = counter++;
+                    stack[stack_size++] = w;
+                    call_vert[call_size] = w;
+                    call_edge[call_size++] = 0;
+                } else if (comps[w] == GRAPH_INVALID_ID && idx[w] < low[v]) {
+                    /* visited but not assigned a component means it is still on the stack */
+                    low[v] = idx[w];
+                }
+                continue;
+            }
+
+            /* done with all the edges of v */
+            if (low[v] == idx[v]) {
+                graph_id_t w;
+                do {
+                    w = stack[--stack_size];
+                    comps[w] = num;
+                } while (w != v);
+                ++num;
+            }
+            if (--call_size > 0) {
+                graph_id_t u = call_vert[call_size - 1];
+                if (low[v] < low[u])
+                    low[u] = low[v];
+            }
+        }
+    }
+    free(idx);
+    free(low);
+    free(stack);
+    free(call_vert);
+    free(call_edge);
+
+    /* tarjan finds the components in reverse topological order */
+    for (i = 0; i < n; ++i) {
+        if (comps[i] != GRAPH_INVALID_ID)
+            comps[i] = num - 1 - comps[i];
+    }
+
+    *num_components = num;
+    if (condensation != NULL)
+        *condensation = __condensation(g, comps, num);
+    return comps;
+}
+
+graph_id_t* g_topological_sort(graph_t g, graph_id_t* size) {
+    *size = 0;
+    graph_id_t n = g->_prev_vert_id;
+    graph_id_t* ret = (graph_id_t*)malloc((g->num_verts + 1) * sizeof(graph_id_t));
+    graph_id_t* ins = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    if (ret == NULL || ins == NULL) {
+        free(ret);
+        free(ins);
+        return NULL;
+    }
+
+    /* the result doubles as the queue of vertices with no remaining edges in */
+    graph_id_t i, head = 0, tail = 0;
+    vertex_t v;
+    g_iterate_vertices(g, v, i) {
+        ins[i] = v->num_edges_in;
+        if (ins[i] == 0)
+            ret[tail++] = i;
+    }
+
+    edge_t e;
+    while (head != tail) {
+        v = __vertex_at(g, ret[head++]);
+        g_iterate_edges(v, e, i) {
+            if (--ins[e->dest] == 0)
+                ret[tail++] = e->dest;
+        }
+    }
+    free(ins);
+
+    if (tail != g->num_verts) {  /* there was a cycle */
+        free(ret);
+        return NULL;
+    }
+    *size = tail;
+    return ret;
+}
+
+static graph_t __condensation(graph_t g, const graph_id_t* comps, graph_id_t num_components) {
+    graph_t c = g_init_alt(num_components > 0 ? num_components : 1);
+    if (c == NULL)
+        return NULL;
+    graph_id_t i;
+    bool ok = true;
+    for (i = 0; i < num_components && ok; ++i)
+        ok = g_vertex_add(c, NULL) != NULL;
+
+    /*  group the vertices by component so each component's edges can be
+        de-duplicated using the last component that was seen as a source */
+    graph_id_t n = g->_prev_vert_id;
+    graph_id_t* offsets = (graph_id_t*)calloc(num_components + 1, sizeof(graph_id_t));
+    graph_id_t* members = (graph_id_t*)malloc((g->num_verts + 1) * sizeof(graph_id_t));
+    graph_id_t* last_seen = (graph_id_t*)malloc((num_components + 1) * sizeof(graph_id_t));
+    IdList src = {NULL, 0, 0}, dest = {NULL, 0, 0};
+    if (!ok || offsets == NULL || members == NULL || last_seen == NULL) {
+        free(offsets);
+        free(members);
+        free(last_seen);
+        g_free(c);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        if (comps[i] != GRAPH_INVALID_ID)
+            ++offsets[comps[i] + 1];
+    }
+    for (i = 0; i < num_components; ++i) {
+        offsets[i + 1] += offsets[i];
+        last_seen[i] = GRAPH_INVALID_ID;
+    }
+    for (i = 0; i < n; ++i) {
+        if (comps[i] != GRAPH_INVALID_ID)
+            members[offsets[comps[i]]++] = i;
+    }
+
+    graph_id_t k, j, start = 0;
+    for (k = 0; k < num_components && ok; ++k) {
+        for (j = start; j < offsets[k] && ok; ++j) {
+            vertex_t v = __vertex_at(g, members[j]);
+            edge_t e;
+            g_iterate_edges(v, e, i) {
+                graph_id_t d = comps[e->dest];
+                if (d == k || last_seen[d] == k)
+                    continue;
+                last_seen[d] = k;
+                if (__id_list_push(&src, k) == false || __id_list_push(&dest, d) == false) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        start = offsets[k];
+    }
+    if (ok && src.size > 0)
+        ok = g_edges_add_batch(c, src.ids, dest.ids, NULL, src.size) == src.size;
+
+    free(src.ids);
+    free(dest.ids);
+    free(offsets);
+    free(members);
+    free(last_seen);
+    if (!ok) {
+        g_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+static graph_id_t __uf_find(graph_id_t* parent, graph_id_t x) {
+    /*  path halving; the compare and swap keeps it safe if another thread
+        updates the same link */
+    while (true) {
+        graph_id_t p = ATOMIC_LOAD(parent[x]);
+        if (p == x)
+            return x;
+        graph_id_t gp = ATOMIC_LOAD(parent[p]);
+        if (p != gp)
+            ATOMIC_CAS(&parent[x], &p, &gp);
+        x = gp;
+    }
+}
+
+static void __uf_union(graph_id_t* parent, graph_id_t a, graph_id_t b) {
+    /*  always hang the larger root under the smaller one; the link only
+        succeeds if the larger root is still a root */
+    while (true) {
+        a = __uf_find(parent, a);
+        b = __uf_find(parent, b);
+        if (a == b)
+            return;
+        if (a < b) {
+            graph_id_t tmp = a;
+            a = b;
+            b = tmp;
+        }
+        graph_id_t expected = a;
+        if (ATOMIC_CAS(&parent[a], &expected, &b))
+            return;
+    }
+}
+
+/*******************************************************************************
+*   centrality
+*******************************************************************************/
+double* g_betweenness_centrality(graph_t g, graph_id_t num_samples, unsigned long long seed) {
+    graph_id_t n = g->_prev_vert_id, num = 0, i;
+    double* scores = (double*)calloc(n + 1, sizeof(double));
+    graph_id_t* sources = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    graph_csr_t c = g_csr_init(g);
+    if (scores == NULL || sources == NULL || c == NULL) {
+        free(scores);
+        free(sources);
+        if (c != NULL)
+            g_csr_free(c);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        if (c->exists[i] != 0)
+            sources[num++] = i;
+    }
+
+    /* a partial shuffle picks the sampled sources without repeats */
+    graph_id_t num_sources = num;
+    if (num_samples != 0 && num_samples < num) {
+        uint64_t state = seed;
+        for (i = 0; i < num_samples; ++i) {
+            graph_id_t j = i + (graph_id_t)(__rand_next(&state) % (num - i));
+            graph_id_t tmp = sources[i];
+            sources[i] = sources[j];
+            sources[j] = tmp;
+        }
+        num_sources = num_samples;
+    }
+
+    bool failed = false;
+    #pragma omp parallel
+    {
+        /* each thread has its own scratch and scores, merged once at the end */
+        graph_id_t* dist = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+        graph_id_t* order = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+        double* sigma = (double*)malloc((n + 1) * sizeof(double));
+        double* delta = (double*)malloc((n + 1) * sizeof(double));
+        double* local = (double*)calloc(n + 1, sizeof(double));
+        bool ok = (dist != NULL && order != NULL && sigma != NULL && delta != NULL && local != NULL);
+        graph_id_t k, j;
+        if (ok == false) {
+            ATOMIC_STORE(failed, true);
+        } else {
+            for (k = 0; k < n; ++k)
+                dist[k] = GRAPH_INVALID_ID;
+        }
+
+        /*  every thread has to reach the worksharing loop, even one without
+            scratch; once any thread fails the result is thrown away anyway */
+        #pragma omp for schedule(dynamic, 1)
+        for (j = 0; j < num_sources; ++j) {
+            if (ok == true && ATOMIC_LOAD(failed) == false)
+                __brandes(c, sources[j], dist, sigma, delta, order, local);
+        }
+
+        if (ok == true) {
+            CRITICAL
+            {
+                for (k = 0; k < n; ++k)
+                    scores[k] += local[k];
+            }
+        }
+        free(dist);
+        free(order);
+        free(sigma);
+        free(delta);
+        free(local);
+    }
+    g_csr_free(c);
+    free(sources);
+    if (failed) {
+        free(scores);
+        return NULL;
+    }
+
+    if (num_sources < num) {
+        double scale = (double)num / num_sources;
+        for (i = 0; i < n; ++i)
+            scores[i] *= scale;
+    }
+    return scores;
+}
+
+double* g_closeness_centrality(graph_t g) {
+    graph_id_t n = g->_prev_vert_id, num = 0, i;
+    double* scores = (double*)calloc(n + 1, sizeof(double));
+    graph_id_t* sources = (graph_id_t*)calloc(n + 1, sizeof(graph_id_t));
+    unsigned long long* sums = (unsigned long long*)calloc(n + 1, sizeof(unsigned long long));
+    graph_id_t* reached = (graph_id_t*)calloc(n + 1, sizeof(graph_id_t));
+    if (scores == NULL || sources == NULL || sums == NULL || reached == NULL) {
+        free(scores);
+        free(sources);
+        free(sums);
+        free(reached);
+        return NULL;
+    }
+
+    for (i = 0; i < n; ++i) {
+        if (__vertex_at(g, i) != NULL)
+            sources[num++] = i;
+    }
+    bool ok = __multi_source_bfs(g, sources, num, NULL, sums, reached);
+    for (i = 0; ok && i < num; ++i) {
+        if (sums[i] == 0)
+            continue;
+        double others = (double)(reached[i] - 1);
+        scores[sources[i]] = (others / sums[i]) * (others / (num - 1));
+    }
+    free(sources);
+    free(sums);
+    free(reached);
+    if (!ok) {
+        free(scores);
+        return NULL;
+    }
+    return scores;
+}
+
+/*  single source step of Brandes' algorithm; adds the dependencies of s to
+    scores and leaves dist reset to GRAPH_INVALID_ID for the next source */
+static void __brandes(graph_csr_t c, graph_id_t s, graph_id_t* dist, double* sigma, double* delta, graph_id_t* order, double* scores) {
+    graph_id_t head = 0, tail = 0, j;
+    dist[s] = 0;
+    sigma[s] = 1.0;
+    delta[s] = 0.0;
+    order[tail++] = s;
+    while (head < tail) {
+        graph_id_t v = order[head++];
+        for (j = c->offsets[v]; j < c->offsets[v + 1]; ++j) {
+            graph_id_t w = c->targets[j];
+            if (dist[w] == GRAPH_INVALID_ID) {
+                dist[w] = dist[v] + 1;
+                sigma[w] = 0.0;
+                delta[w] = 0.0;
+                order[tail++] = w;
+            }
+            if (dist[w] == dist[v] + 1)
+                sigma[w] += sigma[v];
+        }
+    }
+
+    /*  walk back in order of decreasing distance; the successors of v on a
+        shortest path are the edges out of it one level further away, so no
+        predecessor lists are needed */
+    while (tail > 0) {
+        graph_id_t v = order[--tail];
+        double sum = 0.0;
+        for (j = c->offsets[v]; j < c->offsets[v + 1]; ++j) {
+            graph_id_t w = c->targets[j];
+            if (dist[w] == dist[v] + 1)
+                sum += (1.0 + delta[w]) / sigma[w];
+        }
+        delta[v] = sigma[v] * sum;
+        if (v != s)
+            scores[v] += delta[v];
+    }
+    for (j = 0; j < head; ++j)
+        dist[order[j]] = GRAPH_INVALID_ID;
+}
+
+/*******************************************************************************
+*   spanning trees
+*******************************************************************************/
+graph_id_t* g_kruskal(graph_t g, g_edge_weight_t weight, graph_id_t* num_edges, double* total) {
+    return __kruskal(g, weight, NULL, num_edges, total);
+}
+
+graph_id_t* g_kruskal_alt(graph_t g, const double* weights, graph_id_t* num_edges, double* total) {
+    return __kruskal(g, NULL, weights, num_edges, total);
+}
+
+graph_id_t* g_boruvka(graph_t g, g_edge_weight_t weight, graph_id_t* num_edges, double* total) {
+    return __boruvka(g, weight, NULL, num_edges, total);
+}
+
+graph_id_t* g_boruvka_alt(graph_t g, const double* weights, graph_id_t* num_edges, double* total) {
+    return __boruvka(g, NULL, weights, num_edges, total);
+}
+
+static graph_id_t* __kruskal(graph_t g, g_edge_weight_t weight, const double* weights, graph_id_t* num_edges, double* total) {
+    *num_edges = 0;
+    if (total != NULL)
+        *total = 0.0;
+
+    graph_id_t n = g->_prev_vert_id, i;
+    size_t m, j;
+    WeightedEdge* edges = __weighted_edges(g, weight, weights, &m);
+    graph_id_t* parent = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    graph_id_t* ret = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    if (edges == NULL || parent == NULL || ret == NULL || !__sort_weighted(edges, m)) {
+        free(edges);
+        free(parent);
+        free(ret);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i)
+        parent[i] = i;
+
+    graph_id_t num = 0;
+    double sum = 0.0;
+    for (j = 0; j < m && num + 1 < n; ++j) {
+        graph_id_t a = __uf_find(parent, edges[j].src), b = __uf_find(parent, edges[j].dest);
+        if (a == b)
+            continue;
+        __uf_union(parent, a, b);
+        ret[num++] = edges[j].id;
+        sum += edges[j].weight;
+    }
+    free(edges);
+    free(parent);
+
+    *num_edges = num;
+    if (total != NULL)
+        *total = sum;
+    return ret;
+}
+
+static graph_id_t* __boruvka(graph_t g, g_edge_weight_t weight, const double* weights, graph_id_t* num_edges, double* total) {
+    *num_edges = 0;
+    if (total != NULL)
+        *total = 0.0;
+
+    graph_id_t n = g->_prev_vert_id, num = 0;
+    size_t m, j;
+    WeightedEdge* edges = __weighted_edges(g, weight, weights, &m);
+    graph_id_t* parent = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    graph_id_t* comp = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    graph_id_t* best = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    graph_id_t* ret = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    if (edges == NULL || parent == NULL || comp == NULL || best == NULL || ret == NULL) {
+        free(edges);
+        free(parent);
+        free(comp);
+        free(best);
+        free(ret);
+        return NULL;
+    }
+
+    graph_id_t v;
+    #pragma omp parallel for
+    for (v = 0; v < n; ++v)
+        parent[v] = v;
+
+    double sum = 0.0;
+    while (m > 0) {
+        #pragma omp parallel for
+        for (v = 0; v < n; ++v) {
+            comp[v] = __uf_find(parent, v);
+            best[v] = GRAPH_INVALID_ID;
+        }
+
+        /*  drop the edges within a tree; the rest keep their relative order.
+            This only shrinks the list so it is done in place */
+        size_t kept = 0;
+        for (j = 0; j < m; ++j) {
+            if (comp[edges[j].src] != comp[edges[j].dest])
+                edges[kept++] = edges[j];
+        }
+        m = kept;
+
+        /*  the lightest edge out of each tree; ties on the weight go to the
+            lower edge id so that every tree agrees on the order */
+        graph_id_t k;
+        #pragma omp parallel for schedule(static)
+        for (k = 0; k < m; ++k) {
+            graph_id_t ends[2], t;
+            ends[0] = comp[edges[k].src];
+            ends[1] = comp[edges[k].dest];
+            for (t = 0; t < 2; ++t) {
+                graph_id_t cur = ATOMIC_LOAD(best[ends[t]]), idx = k;
+                while (cur == GRAPH_INVALID_ID || __compare_weighted(&edges[k], &edges[cur]) < 0) {
+                    if (ATOMIC_CAS(&best[ends[t]], &cur, &idx))
+                        break;
+                }
+            }
+        }
+
+        /*  join along the lightest edges; with a strict order on the edges they
+            can not form a cycle, but two trees can pick the same edge, in which
+            case only the tree with the lower id adds it */
+        graph_id_t added = 0;
+        #pragma omp parallel for reduction(+:added, sum)
+        for (v = 0; v < n; ++v) {
+            graph_id_t idx = best[v];
+            if (idx == GRAPH_INVALID_ID)
+                continue;
+            graph_id_t other = (comp[edges[idx].src] == v) ? comp[edges[idx].dest] : comp[edges[idx].src];
+            if (best[other] == idx && other < v)
+                continue;
+            __uf_union(parent, edges[idx].src, edges[idx].dest);
+            ret[ATOMIC_FETCH_ADD(num)] = edges[idx].id;
+            sum += edges[idx].weight;
+            ++added;
+        }
+        if (added == 0)
+            break;
+    }
+    free(edges);
+    free(parent);
+    free(comp);
+    free(best);
+
+    *num_edges = num;
+    if (total != NULL)
+        *total = sum;
+    return ret;
+}
+
+/* gather every edge, other than self loops, with its weight */
+static WeightedEdge* __weighted_edges(graph_t g, g_edge_weight_t weight, const double* weights, size_t* num) {
+    graph_id_t n = g->_prev_vert_id, i;
+    size_t* offsets = (size_t*)calloc((size_t)n + 1, sizeof(size_t));
+    WeightedEdge* edges = (WeightedEdge*)malloc(((size_t)g->num_edges + 1) * sizeof(WeightedEdge));
+    if (offsets == NULL || edges == NULL) {
+        free(offsets);
+        free(edges);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        graph_id_t j;
+        if (v == NULL)
+            continue;
+        for (j = 0; j < v->num_edges_out; ++j)
+            offsets[i + 1] += (v->edges[j]->dest != i);
+    }
+    for (i = 0; i < n; ++i)
+        offsets[i + 1] += offsets[i];
+
+    graph_id_t k;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (k = 0; k < n; ++k) {
+        vertex_t v = __vertex_at(g, k);
+        if (v == NULL)
+            continue;
+        size_t pos = offsets[k];
+        graph_id_t j;
+        for (j = 0; j < v->num_edges_out; ++j) {
+            edge_t e = v->edges[j];
+            if (e->dest == e->src)
+                continue;
+            edges[pos].weight = __edge_weight(e, weight, weights);
+            edges[pos].id = e->id;
+            edges[pos].src = e->src;
+            edges[pos++].dest = e->dest;
+        }
+    }
+    *num = offsets[n];
+    free(offsets);
+    return edges;
+}
+
+/*  sort a chunk per thread, then merge pairs of runs, each merge in parallel
+    with the others, until there is a single run; tmp is scratch for both */
+static bool __sort_weighted(WeightedEdge* edges, size_t num) {
+    size_t chunks = 1;
+    while (chunks < (size_t)NUM_THREADS())
+        chunks *= 2;
+    size_t width = (num + chunks - 1) / chunks;
+    if (width < 1024)
+        chunks = 1;
+    width = (num + chunks - 1) / chunks;
+
+    WeightedEdge* tmp = (WeightedEdge*)malloc((num + 1) * sizeof(WeightedEdge));
+    if (tmp == NULL)
+        return false;
+
+    int c;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (c = 0; c < (int)chunks; ++c) {
+        size_t start = c * width;
+        if (start < num)
+            __radix_weighted(edges + start, tmp + start, (start + width < num) ? width : num - start);
+    }
+
+    WeightedEdge* src = edges;
+    WeightedEdge* dest = tmp;
+    for (; width < num; width *= 2) {
+        int pairs = (int)((num + 2 * width - 1) / (2 * width)), p;
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (p = 0; p < pairs; ++p) {
+            size_t start = 2 * width * p;
+            size_t mid = (start + width < num) ? start + width : num;
+            size_t end = (mid + width < num) ? mid + width : num;
+            __merge_weighted(src + start, mid - start, src + mid, end - mid, dest + start);
+        }
+        WeightedEdge* swap = src;
+        src = dest;
+        dest = swap;
+    }
+    if (src != edges)
+        memcpy(edges, src, num * sizeof(WeightedEdge));
+    free(tmp);
+    return true;
+}
+
+#define WEIGHTED_ID_DIGITS ((unsigned int)sizeof(graph_id_t) / 2)  /* 16 bit digits of an id */
+
+/*  least significant digit radix sort on the weight, then the id, 16 bits at
+    a time; passes where every edge has the same digit are skipped. Small runs
+    are left to qsort */
+static void __radix_weighted(WeightedEdge* edges, WeightedEdge* tmp, size_t num) {
+    if (num < 65536) {
+        qsort(edges, num, sizeof(WeightedEdge), __compare_weighted);
+        return;
+    }
+    size_t* counts = (size_t*)malloc(65536 * sizeof(size_t));
+    if (counts == NULL) {
+        qsort(edges, num, sizeof(WeightedEdge), __compare_weighted);
+        return;
+    }
+
+    WeightedEdge* src = edges;
+    WeightedEdge* dest = tmp;
+    unsigned int pass;
+    size_t i;
+    for (pass = 0; pass < WEIGHTED_ID_DIGITS + 4; ++pass) {
+        memset(counts, 0, 65536 * sizeof(size_t));
+        for (i = 0; i < num; ++i)
+            ++counts[__weighted_digit(&src[i], pass)];
+        if (counts[__weighted_digit(&src[0], pass)] == num)
+            continue;
+        size_t total = 0, d;
+        for (d = 0; d < 65536; ++d) {
+            size_t cnt = counts[d];
+            counts[d] = total;
+            total += cnt;
+        }
+        for (i = 0; i < num; ++i)
+            dest[counts[__weighted_digit(&src[i], pass)]++] = src[i];
+        WeightedEdge* swap = src;
+        src = dest;
+        dest = swap;
+    }
+    if (src != edges)
+        memcpy(edges, src, num * sizeof(WeightedEdge));
+    free(counts);
+}
+
+/*  digit of the key (weight, id) for the pass; the bits of the weight are
+    flipped so that they sort in the same order as the doubles */
+static unsigned int __weighted_digit(const WeightedEdge* e, unsigned int pass) {
+    if (pass < WEIGHTED_ID_DIGITS)
+        return (unsigned int)(e->id >> (16 * pass)) & 0xFFFF;
+    double w = (e->weight == 0.0) ? 0.0 : e->weight;  /* -0.0 ties with 0.0 */
+    uint64_t bits;
+    memcpy(&bits, &w, sizeof(uint64_t));
+    bits = (bits >> 63) ? ~bits : bits | 0x8000000000000000ULL;
+    return (unsigned int)(bits >> (16 * (pass - WEIGHTED_ID_DIGITS))) & 0xFFFF;
+}
+
+static void __merge_weighted(const WeightedEdge* a, size_t num_a, const WeightedEdge* b, size_t num_b, WeightedEdge* out) {
+    size_t i = 0, j = 0;
+    while (i < num_a && j < num_b)
+        *out++ = (__compare_weighted(&b[j], &a[i]) < 0) ? b[j++] : a[i++];
+    while (i < num_a)
+        *out++ = a[i++];
+    while (j < num_b)
+        *out++ = b[j++];
+}
+
+static int __compare_weighted(const void* a, const void* b) {
+    const WeightedEdge* x = (const WeightedEdge*)a;
+    const WeightedEdge* y = (const WeightedEdge*)b;
+    if (x->weight != y->weight)
+        return (x->weight < y->weight) ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+/*******************************************************************************
+*   triangles and cores
+*******************************************************************************/
+unsigned long long* g_triangles(graph_t g, unsigned long long* total) {
+    graph_id_t n = g->_prev_vert_id, i;
+    unsigned long long* counts = (unsigned long long*)calloc((size_t)n + 1, sizeof(unsigned long long));
+    size_t* offsets = (size_t*)malloc(((size_t)n + 1) * sizeof(size_t));
+    unsigned int* degrees = (unsigned int*)malloc(((size_t)n + 1) * sizeof(unsigned int));
+    graph_id_t* rank = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* order = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* adj = NULL;
+    if (counts != NULL && offsets != NULL && degrees != NULL && rank != NULL && order != NULL)
+        adj = __undirected_adjacency(g, offsets, degrees);
+    if (adj == NULL) {
+        free(counts);
+        free(offsets);
+        free(degrees);
+        free(rank);
+        free(order);
+        return NULL;
+    }
+
+    /*  rank the vertices by degree, then id, using a counting sort; rank is
+        reused for the start of each degree before it is filled in */
+    unsigned int max_degree = 0;
+    for (i = 0; i < n; ++i) {
+        if (degrees[i] > max_degree)
+            max_degree = degrees[i];
+    }
+    graph_id_t* starts = (graph_id_t*)calloc((size_t)max_degree + 2, sizeof(graph_id_t));
+    if (starts == NULL) {
+        free(counts);
+        counts = NULL;
+        n = 0;
+    }
+    for (i = 0; i < n; ++i)
+        ++starts[degrees[i] + 1];
+    for (i = 0; i < max_degree && n > 0; ++i)
+        starts[i + 1] += starts[i];
+    for (i = 0; i < n; ++i) {
+        rank[i] = starts[degrees[i]]++;
+        order[rank[i]] = i;
+    }
+    free(starts);
+
+    /*  orient each edge towards the end of higher rank and keep it only there,
+        by rank; no vertex keeps more than O(sqrt(m)) neighbors */
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i = 0; i < n; ++i) {
+        graph_id_t* list = adj + offsets[i];
+        graph_id_t j, k = 0;
+        for (j = 0; j < degrees[i]; ++j) {
+            if (rank[list[j]] > rank[i])
+                list[k++] = rank[list[j]];
+        }
+        qsort(list, k, sizeof(graph_id_t), __compare_ids);
+        degrees[i] = k;
+    }
+
+    /*  a third vertex of a triangle with the edge u -> v ranks above v, so only
+        the rest of the list of u past v needs to be merged with that of v. The
+        counts are kept by rank while merging, which puts the vertices in the
+        most triangles next to each other, and then moved to the vertex ids */
+    unsigned long long* found_by_rank = (unsigned long long*)calloc((size_t)n + 1, sizeof(unsigned long long));
+    if (found_by_rank == NULL) {
+        free(counts);
+        counts = NULL;
+        n = 0;
+    }
+    unsigned long long sum = 0;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:sum)
+    for (i = 0; i < n; ++i) {
+        const graph_id_t* a = adj + offsets[i];
+        graph_id_t num_a = degrees[i], j;
+        unsigned long long found = 0;
+        for (j = 0; j < num_a; ++j) {
+            graph_id_t v = order[a[j]];
+            graph_id_t common = __intersect(a + j + 1, num_a - j - 1, adj + offsets[v], degrees[v], found_by_rank);
+            if (common > 0) {
+                ATOMIC
+                found_by_rank[a[j]] += common;
+            }
+            found += common;
+        }
+        if (found > 0) {
+            ATOMIC
+            found_by_rank[rank[i]] += found;
+        }
+        sum += found;
+    }
+    for (i = 0; i < n; ++i)
+        counts[i] = found_by_rank[rank[i]];
+    free(found_by_rank);
+    free(offsets);
+    free(degrees);
+    free(rank);
+    free(order);
+    free(adj);
+    if (total != NULL)
+        *total = sum;
+    return counts;
+}
+
+unsigned int* g_core_numbers(graph_t g, unsigned int* max_core) {
+    graph_id_t n = g->_prev_vert_id, i, j;
+    unsigned int* core = (unsigned int*)calloc((size_t)n + 1, sizeof(unsigned int));
+    size_t* offsets = (size_t*)malloc(((size_t)n + 1) * sizeof(size_t));
+    unsigned int* degrees = (unsigned int*)malloc(((size_t)n + 1) * sizeof(unsigned int));
+    graph_id_t* vert = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* pos = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* adj = NULL;
+    graph_id_t* bin = NULL;
+    unsigned int most = 0, top = 0;
+    if (core != NULL && offsets != NULL && degrees != NULL && vert != NULL && pos != NULL)
+        adj = __undirected_adjacency(g, offsets, degrees);
+    if (adj != NULL) {
+        for (i = 0; i < n; ++i) {
+            core[i] = degrees[i];
+            if (degrees[i] > most)
+                most = degrees[i];
+        }
+        bin = (graph_id_t*)calloc((size_t)most + 2, sizeof(graph_id_t));
+    }
+    if (bin == NULL) {
+        free(core);
+        core = NULL;
+        n = 0;
+    }
+
+    /*  bucket the vertices by the number of neighbors left (Batagelj and
+        Zaversnik): vert holds them sorted by that count, pos where each one is
+        and bin[d] where the bucket for d starts. Peeling in that order, a
+        neighbor with more left moves to the front of its bucket and drops into
+        the one below, so each vertex and edge is handled once; O(n + m) */
+    for (i = 0; i < n; ++i)
+        ++bin[core[i]];
+    graph_id_t start = 0;
+    unsigned int d;
+    for (d = 0; d <= most && n > 0; ++d) {
+        graph_id_t num = bin[d];
+        bin[d] = start;
+        start += num;
+    }
+    for (i = 0; i < n; ++i) {
+        pos[i] = bin[core[i]]++;
+        vert[pos[i]] = i;
+    }
+    for (d = most; d > 0 && n > 0; --d)
+        bin[d] = bin[d - 1];
+    if (n > 0)
+        bin[0] = 0;
+
+    for (i = 0; i < n; ++i) {
+        graph_id_t v = vert[i];
+        const graph_id_t* list = adj + offsets[v];
+        if (core[v] > top)
+            top = core[v];
+        for (j = 0; j < degrees[v]; ++j) {
+            graph_id_t u = list[j];
+            if (core[u] <= core[v])
+                continue;
+            unsigned int du = core[u];
+            graph_id_t pu = pos[u], pw = bin[du], w = vert[pw];
+            if (u != w) {
+                pos[u] = pw;
+                vert[pu] = w;
+                pos[w] = pu;
+                vert[pw] = u;
+            }
+            ++bin[du];
+            --core[u];
+        }
+    }
+    free(offsets);
+    free(degrees);
+    free(vert);
+    free(pos);
+    free(bin);
+    free(adj);
+    if (max_core != NULL)
+        *max_core = top;
+    return core;
+}
+
+/*  count the values in both sorted lists, adding one to found[] for each; when
+    one list is much longer, each value of the shorter one is searched for in
+    it instead of merging the two */
+static graph_id_t __intersect(const graph_id_t* a, graph_id_t num_a, const graph_id_t* b, graph_id_t num_b, unsigned long long* found) {
+    graph_id_t x = 0, y = 0, common = 0;
+    if (num_a > num_b) {
+        const graph_id_t* tmp = a;
+        a = b;
+        b = tmp;
+        x = num_a;
+        num_a = num_b;
+        num_b = x;
+        x = 0;
+    }
+    if (num_a * 16 < num_b) {
+        for (x = 0; x < num_a && y < num_b; ++x) {
+            y = __lower_bound(b, y, num_b, a[x]);
+            if (y < num_b && b[y] == a[x]) {
+                ATOMIC
+                found[a[x]]++;
+                ++common;
+            }
+        }
+        return common;
+    }
+    while (x < num_a && y < num_b) {
+        graph_id_t p = a[x], q = b[y];
+        if (p == q) {
+            ATOMIC
+            found[p]++;
+            ++common;
+        }
+        x += (p <= q);
+        y += (q <= p);
+    }
+    return common;
+}
+
+/* first position from lo on with a value of at least val, galloping from lo */
+static graph_id_t __lower_bound(const graph_id_t* a, graph_id_t lo, graph_id_t num, graph_id_t val) {
+    graph_id_t step = 1, hi = lo;
+    while (hi < num && a[hi] < val) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > num)
+        hi = num;
+    while (lo < hi) {
+        graph_id_t mid = lo + (hi - lo) / 2;
+        if (a[mid] < val)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*  gather the distinct neighbors of each vertex, either way and not itself,
+    sorted by id; those of v are adj[offsets[v]] to adj[offsets[v] + degrees[v]] */
+static graph_id_t* __undirected_adjacency(graph_t g, size_t* offsets, unsigned int* degrees) {
+    graph_id_t n = g->_prev_vert_id, i;
+    offsets[0] = 0;
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        offsets[i + 1] = offsets[i] + ((v == NULL) ? 0 : (size_t)v->num_edges_out + v->num_edges_in);
+    }
+    graph_id_t* adj = (graph_id_t*)malloc((offsets[n] + 1) * sizeof(graph_id_t));
+    if (adj == NULL)
+        return NULL;
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        graph_id_t* list = adj + offsets[i];
+        graph_id_t j, k = 0, num = 0;
+        if (v != NULL) {
+            for (j = 0; j < v->num_edges_out; ++j) {
+                if (v->edges[j]->dest != i)
+                    list[k++] = v->edges[j]->dest;
+            }
+            for (j = 0; j < v->num_edges_in; ++j) {
+                if (v->edges_in[j]->src != i)
+                    list[k++] = v->edges_in[j]->src;
+            }
+            qsort(list, k, sizeof(graph_id_t), __compare_ids);
+            for (j = 0; j < k; ++j) {
+                if (num == 0 || list[j] != list[num - 1])
+                    list[num++] = list[j];
+            }
+        }
+        degrees[i] = num;
+    }
+    return adj;
+}
+
+/*******************************************************************************
+*   subgraphs and partitioning
+*******************************************************************************/
+graph_t g_subgraph(graph_t g, const graph_id_t* ids, graph_id_t n) {
+    graph_id_t num_ids = g->_prev_vert_id, i;
+    graph_id_t* map = (graph_id_t*)malloc(((size_t)num_ids + 1) * sizeof(graph_id_t));
+    size_t* offsets = (size_t*)calloc((size_t)n + 1, sizeof(size_t));
+    if (map == NULL || offsets == NULL || (n > 0 && ids == NULL)) {
+        free(map);
+        free(offsets);
+        return NULL;
+    }
+
+    /* every id must have a vertex and be listed once */
+    for (i = 0; i < num_ids; ++i)
+        map[i] = GRAPH_INVALID_ID;
+    for (i = 0; i < n; ++i) {
+        if (ids[i] >= num_ids || __vertex_at(g, ids[i]) == NULL || map[ids[i]] != GRAPH_INVALID_ID) {
+            free(map);
+            free(offsets);
+            return NULL;
+        }
+        map[ids[i]] = i;
+    }
+
+    /* count the kept edges out of each vertex to know where its edges go */
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, ids[i]);
+        unsigned int j;
+        size_t num = 0;
+        for (j = 0; j < v->num_edges_out; ++j) {
+            if (map[v->edges[j]->dest] != GRAPH_INVALID_ID)
+                ++num;
+        }
+        offsets[i + 1] = num;
+    }
+    for (i = 0; i < n; ++i)
+        offsets[i + 1] += offsets[i];
+
+    size_t m = offsets[n];
+    graph_id_t* src = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    graph_id_t* from = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    void** metadata = (void**)malloc((m + 1) * sizeof(void*));
+    graph_t sub = NULL;
+    if (src != NULL && dest != NULL && from != NULL && metadata != NULL)
+        sub = g_init_alt((n > 0) ? (unsigned int)((n < 1024) ? n : 1024) : 1);
+    if (sub == NULL)
+        n = 0;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, ids[i]);
+        unsigned int j;
+        size_t k = offsets[i];
+        for (j = 0; j < v->num_edges_out; ++j) {
+            edge_t e = v->edges[j];
+            if (map[e->dest] == GRAPH_INVALID_ID)
+                continue;
+            src[k] = i;
+            dest[k] = map[e->dest];
+            from[k] = e->id;
+            metadata[k] = e->metadata;
+            ++k;
+        }
+    }
+
+    bool ok = (sub != NULL);
+    for (i = 0; i < n && ok; ++i)
+        ok = g_vertex_add_alt(sub, i, __vertex_at(g, ids[i])->metadata) != NULL;
+    ok = ok && __edges_add_batch(sub, src, dest, metadata, NULL, m) == m;
+    ok = ok && __props_gather(&sub->_vertex_props, &g->_vertex_props, ids, n);
+    ok = ok && __props_gather(&sub->_edge_props, &g->_edge_props, from, m);
+    if (!ok && sub != NULL) {
+        g_free_alt(sub, false);
+        sub = NULL;
+    }
+
+    free(map);
+    free(offsets);
+    free(src);
+    free(dest);
+    free(from);
+    free(metadata);
+    return sub;
+}
+
+/* copy each column, value k of dst taking value from[k] of src */
+static bool __props_gather(PropList* dst, const PropList* src, const graph_id_t* from, size_t num) {
+    graph_id_t i;
+    for (i = 0; i < src->num; ++i) {
+        const PropColumn* c = &src->columns[i];
+        char* values = (char*)__prop(dst, c->name, c->type, num);
+        if (values == NULL)
+            return false;
+        size_t width = __prop_value_size(c->type), k;
+        for (k = 0; k < num; ++k) {
+            if (from[k] < c->size)
+                memcpy(values + k * width, (const char*)c->values + (size_t)from[k] * width, width);
+        }
+    }
+    return true;
+}
+
+graph_id_t* g_partition(graph_t g, graph_id_t num_parts, size_t* cut, double* balance) {
+    return g_partition_alt(g, num_parts, 0.03, 20, cut, balance);
+}
+
+graph_id_t* g_partition_alt(graph_t g, graph_id_t num_parts, double imbalance, unsigned int max_rounds, size_t* cut, double* balance) {
+    if (cut != NULL)
+        *cut = 0;
+    if (balance != NULL)
+        *balance = 0.0;
+    if (num_parts == 0)
+        return NULL;
+
+    graph_id_t n = g->_prev_vert_id, num = g->num_verts, i;
+    unsigned int threads = (unsigned int)NUM_THREADS();
+    graph_id_t* parts = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* sizes = (graph_id_t*)calloc((size_t)num_parts, sizeof(graph_id_t));
+    graph_id_t* counts = (graph_id_t*)calloc((size_t)threads * num_parts, sizeof(graph_id_t));
+    graph_id_t* touched = (graph_id_t*)malloc((size_t)threads * num_parts * sizeof(graph_id_t));
+    size_t* offsets = (size_t*)malloc(((size_t)n + 1) * sizeof(size_t));
+    unsigned int* degrees = (unsigned int*)malloc(((size_t)n + 1) * sizeof(unsigned int));
+    graph_id_t* order = NULL;
+    graph_id_t* adj = NULL;
+    if (parts != NULL && sizes != NULL && counts != NULL && touched != NULL && offsets != NULL && degrees != NULL)
+        order = g_order_bfs(g);
+    if (order != NULL)
+        adj = __undirected_adjacency(g, offsets, degrees);
+    if (adj == NULL) {
+        free(parts);
+        parts = NULL;
+        num = 0;
+        n = 0;
+    }
+
+    /*  start from runs of the breadth first order so that each part begins
+        mostly connected; an average part may grow by the imbalance */
+    for (i = 0; i < n; ++i)
+        parts[i] = GRAPH_INVALID_ID;
+    for (i = 0; i < num; ++i) {
+        parts[order[i]] = (graph_id_t)(((unsigned long long)i * num_parts) / num);
+        ++sizes[parts[order[i]]];
+    }
+    graph_id_t max_size = (num + num_parts - 1) / num_parts;
+    if (imbalance > 0.0)
+        max_size += (graph_id_t)(imbalance * ((double)num / num_parts));
+
+    unsigned int round;
+    for (round = 0; round < max_rounds && num > 0; ++round) {
+        graph_id_t moved = 0;
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:moved)
+        for (i = 0; i < num; ++i) {
+            graph_id_t* count = counts + (size_t)THREAD_NUM() * num_parts;
+            graph_id_t* seen = touched + (size_t)THREAD_NUM() * num_parts;
+            graph_id_t v = order[i], num_seen = 0, j;
+            const graph_id_t* list = adj + offsets[v];
+            for (j = 0; j < degrees[v]; ++j) {
+                graph_id_t p = ATOMIC_LOAD(parts[list[j]]);
+                if (count[p]++ == 0)
+                    seen[num_seen++] = p;
+            }
+
+            /* the part holding most neighbors and with room left; ties stay */
+            graph_id_t cur = ATOMIC_LOAD(parts[v]), best = cur;
+            graph_id_t most = count[cur];
+            for (j = 0; j < num_seen; ++j) {
+                graph_id_t p = seen[j];
+                if (count[p] > most && ATOMIC_LOAD(sizes[p]) < max_size) {
+                    best = p;
+                    most = count[p];
+                }
+                count[p] = 0;
+            }
+            count[cur] = 0;
+            if (best == cur)
+                continue;
+
+            /* another thread may have filled the part since */
+            if (ATOMIC_ADD_FETCH(sizes[best]) > max_size) {
+                ATOMIC_SUB_FETCH(sizes[best]);
+                continue;
+            }
+            ATOMIC_SUB_FETCH(sizes[cur]);
+            ATOMIC_STORE(parts[v], best);
+            ++moved;
+        }
+        if (moved <= num / 1000)
+            break;
+    }
+
+    if (parts != NULL) {
+        size_t cut_edges = 0;
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:cut_edges)
+        for (i = 0; i < n; ++i) {
+            vertex_t v = __vertex_at(g, i);
+            if (v == NULL)
+                continue;
+            unsigned int j;
+            for (j = 0; j < v->num_edges_out; ++j) {
+                if (parts[v->edges[j]->dest] != parts[i])
+                    ++cut_edges;
+            }
+        }
+        graph_id_t largest = 0;
+        for (i = 0; i < num_parts; ++i) {
+            if (sizes[i] > largest)
+                largest = sizes[i];
+        }
+        if (cut != NULL)
+            *cut = cut_edges;
+        if (balance != NULL && num > 0)
+            *balance = ((double)largest * num_parts) / num;
+    }
+
+    free(sizes);
+    free(counts);
+    free(touched);
+    free(offsets);
+    free(degrees);
+    free(order);
+    free(adj);
+    return parts;
+}
+
+/*******************************************************************************
+*   compaction and ordering
+*******************************************************************************/
+graph_id_t* g_compact(graph_t g) {
+    return g_compact_alt(g, NULL);
+}
+
+graph_id_t* g_compact_alt(graph_t g, const graph_id_t* order) {
+    graph_id_t n = g->_prev_vert_id, num = g->num_verts, i;
+    graph_id_t* map = (graph_id_t*)malloc((n + 1) * sizeof(graph_id_t));
+    if (map == NULL)
+        return NULL;
+    for (i = 0; i < n; ++i)
+        map[i] = GRAPH_INVALID_ID;
+
+    graph_id_t next = 0;
+    if (order == NULL) {
+        for (i = 0; i < n; ++i) {
+            if (__vertex_at(g, i) != NULL)
+                map[i] = next++;
+        }
+    } else {
+        for (i = 0; i < num; ++i) {
+            graph_id_t id = order[i];
+            if (id >= n || __vertex_at(g, id) == NULL || map[id] != GRAPH_INVALID_ID) {
+                free(map);
+                return NULL;
+            }
+            map[id] = next++;
+        }
+    }
+
+    /*  pull every vertex out before putting them back so that a vertex is
+        never overwritten by another moving into its slot */
+    vertex_t* verts = (vertex_t*)malloc((num + 1) * sizeof(vertex_t));
+    if (verts == NULL || !__props_permute(&g->_vertex_props, map, n, num)) {
+        free(verts);
+        free(map);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        if (map[i] == GRAPH_INVALID_ID)
+            continue;
+        verts[map[i]] = __vertex_at(g, i);
+        *__vertex_slot(g, i) = NULL;
+    }
+    for (i = 0; i < num; ++i) {
+        verts[i]->id = i;
+        *__vertex_slot(g, i) = verts[i];
+    }
+    g->_prev_vert_id = num;
+    free(verts);
+
+    graph_id_t j;
+    #pragma omp parallel for
+    for (j = 0; j < g->_prev_edge_id; ++j) {
+        edge_t e = __edge_at(g, j);
+        if (e == NULL)
+            continue;
+        e->src = map[e->src];
+        e->dest = map[e->dest];
+    }
+
+    /*  the ids the index is built on have changed. Renumbering keeps distinct
+        pairs of vertices distinct, so the hash table holds as many entries as
+        before and is refilled in place; nothing is allocated, so the index
+        cannot be lost part way through. Sorting the edges cannot fail */
+    if (g->_index_mode == GRAPH_EDGE_INDEX_HASH) {
+        memset(g->_index, 0, g->_index_size * sizeof(edge_t));
+        g->_index_count = 0;
+        for (j = 0; j < g->_prev_edge_id; ++j) {
+            edge_t e = __edge_at(g, j);
+            if (e != NULL)
+                __index_insert(g, e);
+        }
+    } else if (g->_index_mode == GRAPH_EDGE_INDEX_SORTED) {
+        g->_index_mode = GRAPH_EDGE_INDEX_NONE;
+        g_edge_index(g, GRAPH_EDGE_INDEX_SORTED);
+    }
+
+    /* the records in the log use the old ids */
+    if (g->_log != NULL)
+        g_log_compact(g->_log);
+    return map;
+}
+
+graph_id_t* g_order_degree(graph_t g) {
+    graph_id_t n = g->_prev_vert_id, num = 0, i;
+    VertexDegree* degs = (VertexDegree*)malloc((g->num_verts + 1) * sizeof(VertexDegree));
+    graph_id_t* ret = (graph_id_t*)malloc((g->num_verts + 1) * sizeof(graph_id_t));
+    if (degs == NULL || ret == NULL) {
+        free(degs);
+        free(ret);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        if (v == NULL)
+            continue;
+        /* flip the degree so that the largest sorts first */
+        degs[num].degree = GRAPH_INVALID_ID - ((graph_id_t)v->num_edges_in + v->num_edges_out);
+        degs[num++].id = i;
+    }
+    qsort(degs, num, sizeof(VertexDegree), __compare_degree);
+    for (i = 0; i < num; ++i)
+        ret[i] = degs[i].id;
+    free(degs);
+    return ret;
+}
+
+graph_id_t* g_order_bfs(graph_t g) {
+    return __order_breadth_first(g, false);
+}
+
+graph_id_t* g_order_rcm(graph_t g) {
+    return __order_breadth_first(g, true);
+}
+
+static graph_id_t* __order_breadth_first(graph_t g, bool rcm) {
+    graph_csr_t c = g_csr_init(g);
+    if (c == NULL)
+        return NULL;
+
+    graph_id_t n = g_csr_num_vertices(c), num = 0, i, j;
+    graph_id_t* ret = (graph_id_t*)malloc((g->num_verts + 1) * sizeof(graph_id_t));
+    char* visited = (char*)calloc(n + 1, sizeof(char));
+    VertexDegree* starts = (VertexDegree*)malloc((g->num_verts + 1) * sizeof(VertexDegree));
+    VertexDegree* next = (VertexDegree*)malloc((2 * (size_t)g_csr_num_edges(c) + 1) * sizeof(VertexDegree));
+    if (ret == NULL || visited == NULL || starts == NULL || next == NULL) {
+        free(ret);
+        ret = NULL;
+        n = 0;
+    }
+
+    /*  candidates to start each component from; the lowest id for a plain
+        breadth first order and the lowest degree for Cuthill-McKee */
+    graph_id_t num_starts = 0;
+    for (i = 0; i < n; ++i) {
+        if (!g_csr_vertex_exists(c, i))
+            continue;
+        starts[num_starts].degree = rcm ? (c->offsets[i + 1] - c->offsets[i]) + (c->in_offsets[i + 1] - c->in_offsets[i]) : 0;
+        starts[num_starts++].id = i;
+    }
+    if (rcm)
+        qsort(starts, num_starts, sizeof(VertexDegree), __compare_degree);
+
+    for (i = 0; i < num_starts; ++i) {
+        if (visited[starts[i].id])
+            continue;
+        graph_id_t head = num;
+        visited[starts[i].id] = 1;
+        ret[num++] = starts[i].id;
+        while (head < num) {
+            graph_id_t u = ret[head++], k = 0;
+            unsigned int len_out, len_in;
+            const graph_id_t* out = g_csr_neighbors_out(c, u, &len_out);
+            const graph_id_t* in = g_csr_neighbors_in(c, u, &len_in);
+            for (j = 0; j < len_out + len_in; ++j) {
+                graph_id_t v = (j < len_out) ? out[j] : in[j - len_out];
+                if (visited[v])
+                    continue;
+                visited[v] = 1;
+                next[k].degree = rcm ? (c->offsets[v + 1] - c->offsets[v]) + (c->in_offsets[v + 1] - c->in_offsets[v]) : 0;
+                next[k++].id = v;
+            }
+            if (rcm)
+                qsort(next, k, sizeof(VertexDegree), __compare_degree);
+            for (j = 0; j < k; ++j)
+                ret[num++] = next[j].id;
+        }
+    }
+
+    if (rcm) {
+        for (i = 0; i < num / 2; ++i) {
+            graph_id_t tmp = ret[i];
+            ret[i] = ret[num - 1 - i];
+            ret[num - 1 - i] = tmp;
+        }
+    }
+
+    free(visited);
+    free(starts);
+    free(next);
+    g_csr_free(c);
+    return ret;
+}
+
+static int __compare_degree(const void* a, const void* b) {
+    const VertexDegree* x = (const VertexDegree*)a;
+    const VertexDegree* y = (const VertexDegree*)b;
+    if (x->degree != y->degree)
+        return (x->degree < y->degree) ? -1 : 1;
+    return (x->id < y->id) ? -1 : (x->id > y->id);
+}
+
+
+/*******************************************************************************
+*   frozen adjacency (csr)
+*******************************************************************************/
+graph_csr_t g_csr_init(graph_t g) {
+    graph_csr_t c = (graph_csr_t)calloc(1, sizeof(CSR));
+    if (c == NULL)
+        return NULL;
+
+    graph_id_t n = g->_prev_vert_id;
+    c->num_verts = n;
+    c->exists = (unsigned char*)calloc(n + 1, sizeof(unsigned char));
+    c->offsets = (graph_id_t*)calloc(n + 1, sizeof(graph_id_t));
+    c->in_offsets = (graph_id_t*)calloc(n + 1, sizeof(graph_id_t));
+    if (c->exists == NULL || c->offsets == NULL || c->in_offsets == NULL) {
+        g_csr_free(c);
+        return NULL;
+    }
+
+    graph_id_t i;
+    vertex_t v;
+    g_iterate_vertices(g, v, i) {
+        c->exists[i] = 1;
+        c->offsets[i + 1] = v->num_edges_out;
+    }
+    for (i = 0; i < n; ++i)
+        c->offsets[i + 1] += c->offsets[i];
+
+    graph_id_t m = c->offsets[n];
+    c->num_edges = m;
+    c->targets = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    c->edge_ids = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    c->sources = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    c->in_edge_ids = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    if (c->targets == NULL || c->edge_ids == NULL || c->sources == NULL || c->in_edge_ids == NULL) {
+        g_csr_free(c);
+        return NULL;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i = 0; i < n; ++i) {
+        vertex_t vs = __vertex_at(g, i);
+        if (vs == NULL)
+            continue;
+        graph_id_t j, k = c->offsets[i];
+        for (j = 0; j < vs->num_edges_out; ++j) {
+            c->targets[k] = vs->edges[j]->dest;
+            c->edge_ids[k++] = vs->edges[j]->id;
+        }
+    }
+
+    /*  transpose; walking the sources in order keeps the edges into each
+        vertex sorted by source id */
+    for (i = 0; i < m; ++i)
+        ++c->in_offsets[c->targets[i] + 1];
+    for (i = 0; i < n; ++i)
+        c->in_offsets[i + 1] += c->in_offsets[i];
+    for (i = 0; i < n; ++i) {
+        graph_id_t j;
+        for (j = c->offsets[i]; j < c->offsets[i + 1]; ++j) {
+            graph_id_t slot = c->in_offsets[c->targets[j]]++;
+            c->sources[slot] = i;
+            c->in_edge_ids[slot] = c->edge_ids[j];
+        }
+    }
+    for (i = n; i > 0; --i)
+        c->in_offsets[i] = c->in_offsets[i - 1];
+    c->in_offsets[0] = 0;
+
+    return c;
+}
+
+void g_csr_free(graph_csr_t c) {
+    if (c->_mapped != NULL) {
+        __unmap_file(c->_mapped, c->_mapped_size);
+        c->_mapped = NULL;
+        c->_mapped_size = 0;
+    } else {
+        free(c->exists);
+        free(c->offsets);
+        free(c->targets);
+        free(c->edge_ids);
+        free(c->in_offsets);
+        free(c->sources);
+        free(c->in_edge_ids);
+    }
+    c->num_verts = 0;
+    c->num_edges = 0;
+    free(c);
+}
+
+graph_id_t g_csr_num_vertices(graph_csr_t c) {
+    return c->num_verts;
+}
+
+graph_id_t g_csr_num_edges(graph_csr_t c) {
+    return c->num_edges;
+}
+
+bool g_csr_vertex_exists(graph_csr_t c, graph_id_t id) {
+    return id < c->num_verts && c->exists[id] != 0;
+}
+
+const graph_id_t* g_csr_neighbors_out(graph_csr_t c, graph_id_t id, unsigned int* len) {
+    *len = (id < c->num_verts) ? c->offsets[id + 1] - c->offsets[id] : 0;
+    return (*len == 0) ? NULL : c->targets + c->offsets[id];
+}
+
+const graph_id_t* g_csr_neighbors_in(graph_csr_t c, graph_id_t id, unsigned int* len) {
+    *len = (id < c->num_verts) ? c->in_offsets[id + 1] - c->in_offsets[id] : 0;
+    return (*len == 0) ? NULL : c->sources + c->in_offsets[id];
+}
+
+const graph_id_t* g_csr_edge_ids_out(graph_csr_t c, graph_id_t id, unsigned int* len) {
+    *len = (id < c->num_verts) ? c->offsets[id + 1] - c->offsets[id] : 0;
+    return (*len == 0) ? NULL : c->edge_ids + c->offsets[id];
+}
+
+const graph_id_t* g_csr_edge_ids_in(graph_csr_t c, graph_id_t id, unsigned int* len) {
+    *len = (id < c->num_verts) ? c->in_offsets[id + 1] - c->in_offsets[id] : 0;
+    return (*len == 0) ? NULL : c->in_edge_ids + c->in_offsets[id];
+}
+
+const void* g_csr_vertex_metadata(graph_csr_t c, graph_id_t id, size_t* len) {
+    *len = 0;
+    if (c->vertex_metadata == NULL || id >= c->num_verts)
+        return NULL;
+    *len = c->vertex_metadata_offsets[id + 1] - c->vertex_metadata_offsets[id];
+    return (*len == 0) ? NULL : c->vertex_metadata + c->vertex_metadata_offsets[id];
+}
+
+const void* g_csr_edge_metadata(graph_csr_t c, graph_id_t id, size_t* len) {
+    *len = 0;
+    if (c->edge_metadata == NULL || id >= c->num_edge_ids)
+        return NULL;
+    *len = c->edge_metadata_offsets[id + 1] - c->edge_metadata_offsets[id];
+    return (*len == 0) ? NULL : c->edge_metadata + c->edge_metadata_offsets[id];
+}
+
+void g_csr_spmv(graph_csr_t c, const double* x, double* y, const double* weights) {
+    graph_id_t v;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (v = 0; v < c->num_verts; ++v) {
+        double sum = 0.0;
+        graph_id_t j;
+        if (weights == NULL) {
+            for (j = c->in_offsets[v]; j < c->in_offsets[v + 1]; ++j)
+                sum += x[c->sources[j]];
+        } else {
+            for (j = c->in_offsets[v]; j < c->in_offsets[v + 1]; ++j)
+                sum += weights[c->in_edge_ids[j]] * x[c->sources[j]];
+        }
+        y[v] = sum;
+    }
+}
+
+double* g_pagerank(graph_t g, double damping, double tolerance, unsigned int max_iterations, unsigned int* iterations) {
+    graph_csr_t c = g_csr_init(g);
+    if (c == NULL)
+        return NULL;
+    double* ret = g_csr_pagerank(c, damping, tolerance, max_iterations, iterations);
+    g_csr_free(c);
+    return ret;
+}
+
+double* g_csr_pagerank(graph_csr_t c, double damping, double tolerance, unsigned int max_iterations, unsigned int* iterations) {
+    if (iterations != NULL)
+        *iterations = 0;
+
+    graph_id_t n = c->num_verts;
+    double* rank = (double*)calloc(n + 1, sizeof(double));
+    double* contrib = (double*)calloc(n + 1, sizeof(double));
+    double* sums = (double*)calloc(n + 1, sizeof(double));
+    if (rank == NULL || contrib == NULL || sums == NULL) {
+        free(rank);
+        free(contrib);
+        free(sums);
+        return NULL;
+    }
+
+    graph_id_t v, num = 0;
+    for (v = 0; v < n; ++v)
+        num += c->exists[v];
+    if (num == 0) {
+        free(contrib);
+        free(sums);
+        return rank;
+    }
+    for (v = 0; v < n; ++v)
+        rank[v] = c->exists[v] ? 1.0 / num : 0.0;
+
+    double base = (1.0 - damping) / num;
+    unsigned int iter = 0;
+    while (iter < max_iterations) {
+        double dangling = 0.0, diff = 0.0;
+        #pragma omp parallel for schedule(static) reduction(+:dangling)
+        for (v = 0; v < n; ++v) {
+            graph_id_t outs = c->offsets[v + 1] - c->offsets[v];
+            if (outs > 0) {
+                contrib[v] = rank[v] / outs;
+            } else {
+                contrib[v] = 0.0;
+                dangling += rank[v];
+            }
+        }
+
+        g_csr_spmv(c, contrib, sums, NULL);
+
+        double spread = base + damping * dangling / num;
+        #pragma omp parallel for schedule(static) reduction(+:diff)
+        for (v = 0; v < n; ++v) {
+            if (c->exists[v] == 0)
+                continue;
+            double r = spread + damping * sums[v];
+            diff += (r > rank[v]) ? r - rank[v] : rank[v] - r;
+            rank[v] = r;
+        }
+        ++iter;
+        if (diff < tolerance)
+            break;
+    }
+    free(contrib);
+    free(sums);
+
+    if (iterations != NULL)
+        *iterations = iter;
+    return rank;
+}
+
+/*******************************************************************************
+*   compressed adjacency
+*******************************************************************************/
+graph_compressed_t g_compressed_init(graph_t g) {
+    graph_id_t n = g->_prev_vert_id, i;
+    size_t m = g->num_edges;
+    graph_compressed_t c = (graph_compressed_t)calloc(1, sizeof(Compressed));
+    graph_id_t* adj_offsets = (graph_id_t*)calloc(n + 1, sizeof(graph_id_t));
+    graph_id_t* adj = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    if (c == NULL || adj_offsets == NULL || adj == NULL) {
+        free(c);
+        free(adj_offsets);
+        free(adj);
+        return NULL;
+    }
+    c->num_verts = n;
+    c->num_edges = (graph_id_t)m;
+
+    /*  gather the neighbors out of, then into, each vertex into the same
+        temporary lists; they are sorted and encoded one side at a time */
+    bool ok = true;
+    int side;
+    for (side = 0; side < 2 && ok; ++side) {
+        for (i = 0; i < n; ++i) {
+            vertex_t v = __vertex_at(g, i);
+            adj_offsets[i + 1] = adj_offsets[i] + ((v == NULL) ? 0 : (side == 0) ? v->num_edges_out : v->num_edges_in);
+        }
+
+        #pragma omp parallel for schedule(dynamic, 256)
+        for (i = 0; i < n; ++i) {
+            vertex_t v = __vertex_at(g, i);
+            if (v == NULL)
+                continue;
+            graph_id_t j, k = adj_offsets[i];
+            if (side == 0) {
+                for (j = 0; j < v->num_edges_out; ++j)
+                    adj[k++] = v->edges[j]->dest;
+            } else {
+                for (j = 0; j < v->num_edges_in; ++j)
+                    adj[k++] = v->edges_in[j]->src;
+            }
+        }
+        if (side == 0)
+            ok = __compressed_side(n, adj_offsets, adj, &c->offsets, &c->bytes);
+        else
+            ok = __compressed_side(n, adj_offsets, adj, &c->in_offsets, &c->in_bytes);
+    }
+    free(adj_offsets);
+    free(adj);
+    if (!ok) {
+        g_compressed_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+graph_compressed_t g_compressed_init_alt(graph_id_t num_verts, const graph_id_t* src, const graph_id_t* dest, size_t num_edges) {
+    graph_compressed_t c = (graph_compressed_t)calloc(1, sizeof(Compressed));
+    graph_id_t* adj_offsets = (graph_id_t*)calloc((size_t)num_verts + 1, sizeof(graph_id_t));
+    graph_id_t* adj = (graph_id_t*)malloc((num_edges + 1) * sizeof(graph_id_t));
+    if (c == NULL || adj_offsets == NULL || adj == NULL) {
+        free(c);
+        free(adj_offsets);
+        free(adj);
+        return NULL;
+    }
+    c->num_verts = num_verts;
+
+    bool ok = __compressed_bucket(num_verts, src, dest, num_edges, adj_offsets, adj) &&
+              __compressed_side(num_verts, adj_offsets, adj, &c->offsets, &c->bytes);
+    c->num_edges = adj_offsets[num_verts];
+    ok = ok && __compressed_bucket(num_verts, dest, src, num_edges, adj_offsets, adj) &&
+         __compressed_side(num_verts, adj_offsets, adj, &c->in_offsets, &c->in_bytes);
+    free(adj_offsets);
+    free(adj);
+    if (!ok) {
+        g_compressed_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void g_compressed_free(graph_compressed_t c) {
+    free(c->offsets);
+    free(c->bytes);
+    free(c->in_offsets);
+    free(c->in_bytes);
+    c->num_verts = 0;
+    c->num_edges = 0;
+    free(c);
+}
+
+graph_id_t g_compressed_num_vertices(graph_compressed_t c) {
+    return c->num_verts;
+}
+
+graph_id_t g_compressed_num_edges(graph_compressed_t c) {
+    return c->num_edges;
+}
+
+unsigned int g_compressed_degree_out(graph_compressed_t c, graph_id_t id) {
+    graph_id_t deg = 0;
+    if (id < c->num_verts)
+        __varint_decode(c->bytes + c->offsets[id], &deg);
+    return (unsigned int)deg;
+}
+
+unsigned int g_compressed_degree_in(graph_compressed_t c, graph_id_t id) {
+    graph_id_t deg = 0;
+    if (id < c->num_verts)
+        __varint_decode(c->in_bytes + c->in_offsets[id], &deg);
+    return (unsigned int)deg;
+}
+
+unsigned int g_compressed_neighbors_out(graph_compressed_t c, graph_id_t id, graph_id_t* res, unsigned int len) {
+    graph_compressed_iter_t it;
+    unsigned int num = 0;
+    g_compressed_iter_out(c, id, &it);
+    while (num < len && g_compressed_iter_next(&it, &res[num]))
+        ++num;
+    return num;
+}
+
+unsigned int g_compressed_neighbors_in(graph_compressed_t c, graph_id_t id, graph_id_t* res, unsigned int len) {
+    graph_compressed_iter_t it;
+    unsigned int num = 0;
+    g_compressed_iter_in(c, id, &it);
+    while (num < len && g_compressed_iter_next(&it, &res[num]))
+        ++num;
+    return num;
+}
+
+void g_compressed_iter_out(graph_compressed_t c, graph_id_t id, graph_compressed_iter_t* it) {
+    it->_prev = 0;
+    it->_remaining = 0;
+    it->_next = NULL;
+    if (id < c->num_verts) {
+        graph_id_t deg;
+        it->_next = __varint_decode(c->bytes + c->offsets[id], &deg);
+        it->_remaining = (unsigned int)deg;
+    }
+}
+
+void g_compressed_iter_in(graph_compressed_t c, graph_id_t id, graph_compressed_iter_t* it) {
+    it->_prev = 0;
+    it->_remaining = 0;
+    it->_next = NULL;
+    if (id < c->num_verts) {
+        graph_id_t deg;
+        it->_next = __varint_decode(c->in_bytes + c->in_offsets[id], &deg);
+        it->_remaining = (unsigned int)deg;
+    }
+}
+
+bool g_compressed_iter_next(graph_compressed_iter_t* it, graph_id_t* neighbor) {
+    if (it->_remaining == 0)
+        return false;
+    graph_id_t gap;
+    it->_next = __varint_decode(it->_next, &gap);
+    it->_prev += gap;
+    --it->_remaining;
+    *neighbor = it->_prev;
+    return true;
+}
+
+graph_id_t g_compressed_breadth_first_traverse(graph_compressed_t c, graph_id_t id, graph_workspace_t w, graph_id_t* res, graph_id_t len) {
+    if (id >= c->num_verts || len == 0 || !__workspace_begin(w, c->num_verts))
+        return 0;
+
+    graph_id_t head = 0, tail = 0, num = 0;
+    unsigned int epoch = w->epoch;
+    w->visited[id] = epoch;
+    w->ids[tail++] = id;
+    res[num++] = id;
+    while (head < tail && num < len) {
+        graph_compressed_iter_t it;
+        graph_id_t u;
+        g_compressed_iterate_out(c, w->ids[head++], it, u) {
+            if (w->visited[u] == epoch)
+                continue;  /* already visited */
+            w->visited[u] = epoch;
+            w->ids[tail++] = u;
+            res[num++] = u;
+            if (num == len)
+                break;
+        }
+    }
+    return num;
+}
+
+size_t g_compressed_memory_usage(graph_compressed_t c) {
+    size_t n = c->num_verts;
+    return sizeof(Compressed) + 2 * (n + 1) * sizeof(uint64_t) + c->offsets[n] + c->in_offsets[n];
+}
+
+/*  sort and encode the lists adj[adj_offsets[v]] to adj[adj_offsets[v + 1]];
+    sizes are found first so that each list can be encoded in parallel */
+static bool __compressed_side(graph_id_t n, const graph_id_t* adj_offsets, graph_id_t* adj, uint64_t** offsets, unsigned char** bytes) {
+    uint64_t* offs = (uint64_t*)calloc((size_t)n + 1, sizeof(uint64_t));
+    if (offs == NULL)
+        return false;
+
+    graph_id_t v;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (v = 0; v < n; ++v) {
+        graph_id_t j, prev = 0, start = adj_offsets[v], end = adj_offsets[v + 1];
+        qsort(adj + start, end - start, sizeof(graph_id_t), __compare_ids);
+        uint64_t size = __varint_size(end - start);
+        for (j = start; j < end; ++j) {
+            size += __varint_size(adj[j] - prev);
+            prev = adj[j];
+        }
+        offs[v + 1] = size;
+    }
+    for (v = 0; v < n; ++v)
+        offs[v + 1] += offs[v];
+
+    unsigned char* data = (unsigned char*)malloc(offs[n] + 1);
+    if (data == NULL) {
+        free(offs);
+        return false;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (v = 0; v < n; ++v) {
+        graph_id_t j, prev = 0, start = adj_offsets[v], end = adj_offsets[v + 1];
+        unsigned char* p = __varint_encode(data + offs[v], end - start);
+        for (j = start; j < end; ++j) {
+            p = __varint_encode(p, adj[j] - prev);
+            prev = adj[j];
+        }
+    }
+    *offsets = offs;
+    *bytes = data;
+    return true;
+}
+
+/* counting sort the edges by key into lists of val, skipping those out of range */
+static bool __compressed_bucket(graph_id_t n, const graph_id_t* key, const graph_id_t* val, size_t num_edges, graph_id_t* adj_offsets, graph_id_t* adj) {
+    graph_id_t* pos = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    if (pos == NULL)
+        return false;
+
+    size_t i;
+    memset(adj_offsets, 0, ((size_t)n + 1) * sizeof(graph_id_t));
+    for (i = 0; i < num_edges; ++i) {
+        if (key[i] < n && val[i] < n)
+            ++adj_offsets[key[i] + 1];
+    }
+    graph_id_t v;
+    for (v = 0; v < n; ++v)
+        adj_offsets[v + 1] += adj_offsets[v];
+    memcpy(pos, adj_offsets, ((size_t)n + 1) * sizeof(graph_id_t));
+    for (i = 0; i < num_edges; ++i) {
+        if (key[i] < n && val[i] < n)
+            adj[pos[key[i]]++] = val[i];
+    }
+    free(pos);
+    return true;
+}
+
+static int __compare_ids(const void* a, const void* b) {
+    graph_id_t x = *(const graph_id_t*)a, y = *(const graph_id_t*)b;
+    return (x > y) - (x < y);
+}
+
+static size_t __varint_size(graph_id_t x) {
+    size_t size = 1;
+    while (x >= 0x80) {
+        x >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+static unsigned char* __varint_encode(unsigned char* p, graph_id_t x) {
+    while (x >= 0x80) {
+        *p++ = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (unsigned char)x;
+    return p;
+}
+
+static const unsigned char* __varint_decode(const unsigned char* p, graph_id_t* x) {
+    if (*p < 0x80) {  /* most gaps fit in a single byte */
+        *x = *p;
+        return p + 1;
+    }
+    graph_id_t val = 0;
+    unsigned int shift = 0;
+    unsigned char b;
+    do {
+        b = *p++;
+        val |= (graph_id_t)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    *x = val;
+    return p;
+}
+
+/*******************************************************************************
+*   dense adjacency (bit matrix)
+*******************************************************************************/
+#define BITMATRIX_ROW(m, id)    ((m)->rows + (size_t)(id) * (m)->words)
+#define BITMATRIX_BIT(id)       ((uint64_t)1 << ((id) & 63))
+#define BITMATRIX_BLOCK 64      /* words of the frontier union done per task */
+
+graph_bitmatrix_t g_bitmatrix_init(graph_t g, bool undirected) {
+    graph_bitmatrix_t m = g_bitmatrix_init_alt(g->_prev_vert_id, undirected);
+    if (m == NULL)
+        return NULL;
+
+    /*  each vertex only writes its own row, so the edges into it are used
+        for the opposite direction rather than writing to the other rows */
+    graph_id_t i;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (i = 0; i < m->num_verts; ++i) {
+        vertex_t v = __vertex_at(g, i);
+        if (v == NULL)
+            continue;
+        uint64_t* row = BITMATRIX_ROW(m, i);
+        graph_id_t j, id;
+        for (j = 0; j < v->num_edges_out; ++j) {
+            id = v->edges[j]->dest;
+            row[id >> 6] |= BITMATRIX_BIT(id);
+        }
+        if (!undirected)
+            continue;
+        for (j = 0; j < v->num_edges_in; ++j) {
+            id = v->edges_in[j]->src;
+            row[id >> 6] |= BITMATRIX_BIT(id);
+        }
+    }
+    return m;
+}
+
+graph_bitmatrix_t g_bitmatrix_init_alt(graph_id_t num_verts, bool undirected) {
+    if (num_verts > GRAPH_BITMATRIX_MAX_VERTICES)
+        return NULL;
+    graph_bitmatrix_t m = (graph_bitmatrix_t)calloc(1, sizeof(BitMatrix));
+    if (m == NULL)
+        return NULL;
+    m->num_verts = num_verts;
+    m->words = (num_verts + 63) / 64;
+    m->undirected = undirected;
+    m->rows = (uint64_t*)calloc((size_t)num_verts * m->words + 1, sizeof(uint64_t));
+    if (m->rows == NULL) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+void g_bitmatrix_free(graph_bitmatrix_t m) {
+    free(m->rows);
+    m->rows = NULL;
+    m->num_verts = 0;
+    free(m);
+}
+
+graph_t g_bitmatrix_to_graph(graph_bitmatrix_t m) {
+    size_t num = g_bitmatrix_num_edges(m), k = 0;
+    graph_id_t* src = (graph_id_t*)malloc((num + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((num + 1) * sizeof(graph_id_t));
+    graph_t g = NULL;
+    if (src != NULL && dest != NULL) {
+        graph_id_t i, j;
+        for (i = 0; i < m->num_verts; ++i) {
+            const uint64_t* row = BITMATRIX_ROW(m, i);
+            for (j = 0; j < m->words; ++j) {
+                uint64_t bits = row[j];
+                while (bits != 0) {
+                    src[k] = i;
+                    dest[k++] = j * 64 + __lowest_bit(bits);
+                    bits &= bits - 1;
+                }
+            }
+        }
+        g = __generated_graph(m->num_verts, src, dest, k);
+    }
+    free(src);
+    free(dest);
+    return g;
+}
+
+graph_id_t g_bitmatrix_num_vertices(graph_bitmatrix_t m) {
+    return m->num_verts;
+}
+
+size_t g_bitmatrix_num_edges(graph_bitmatrix_t m) {
+    size_t num = (size_t)m->num_verts * m->words;
+    unsigned long long count = 0;
+    int i;
+    #pragma omp parallel for schedule(static) reduction(+:count)
+    for (i = 0; i < (int)num; ++i)
+        count += __popcount(m->rows[i]);
+    return (size_t)count;
+}
+
+bool g_bitmatrix_edge_add(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest) {
+    if (src >= m->num_verts || dest >= m->num_verts)
+        return false;
+    BITMATRIX_ROW(m, src)[dest >> 6] |= BITMATRIX_BIT(dest);
+    if (m->undirected)
+        BITMATRIX_ROW(m, dest)[src >> 6] |= BITMATRIX_BIT(src);
+    return true;
+}
+
+bool g_bitmatrix_edge_remove(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest) {
+    if (src >= m->num_verts || dest >= m->num_verts)
+        return false;
+    BITMATRIX_ROW(m, src)[dest >> 6] &= ~BITMATRIX_BIT(dest);
+    if (m->undirected)
+        BITMATRIX_ROW(m, dest)[src >> 6] &= ~BITMATRIX_BIT(src);
+    return true;
+}
+
+bool g_bitmatrix_edge_exists(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest) {
+    if (src >= m->num_verts || dest >= m->num_verts)
+        return false;
+    return (BITMATRIX_ROW(m, src)[dest >> 6] & BITMATRIX_BIT(dest)) != 0;
+}
+
+unsigned int g_bitmatrix_degree(graph_bitmatrix_t m, graph_id_t id) {
+    if (id >= m->num_verts)
+        return 0;
+    const uint64_t* row = BITMATRIX_ROW(m, id);
+    unsigned int j, deg = 0;
+    for (j = 0; j < m->words; ++j)
+        deg += __popcount(row[j]);
+    return deg;
+}
+
+unsigned int g_bitmatrix_neighbors(graph_bitmatrix_t m, graph_id_t id, graph_id_t* res, unsigned int len) {
+    if (id >= m->num_verts)
+        return 0;
+    const uint64_t* row = BITMATRIX_ROW(m, id);
+    unsigned int j, num = 0;
+    for (j = 0; j < m->words && num < len; ++j) {
+        uint64_t bits = row[j];
+        while (bits != 0 && num < len) {
+            res[num++] = j * 64 + __lowest_bit(bits);
+            bits &= bits - 1;
+        }
+    }
+    return num;
+}
+
+unsigned int g_bitmatrix_common_neighbors(graph_bitmatrix_t m, graph_id_t a, graph_id_t b) {
+    if (a >= m->num_verts || b >= m->num_verts)
+        return 0;
+    return __bits_and_count(BITMATRIX_ROW(m, a), BITMATRIX_ROW(m, b), 0, m->words);
+}
+
+unsigned long long g_bitmatrix_triangles(graph_bitmatrix_t m) {
+    unsigned long long count = 0;
+    graph_id_t u;
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:count)
+    for (u = 0; u < m->num_verts; ++u) {
+        /* for each v > u in the row of u, the w > v in both rows */
+        const uint64_t* row = BITMATRIX_ROW(m, u);
+        graph_id_t j;
+        for (j = (u + 1) >> 6; j < m->words; ++j) {
+            uint64_t bits = row[j];
+            if (j == (u + 1) >> 6)
+                bits &= ~(uint64_t)0 << ((u + 1) & 63);
+            while (bits != 0) {
+                graph_id_t v = j * 64 + __lowest_bit(bits);
+                bits &= bits - 1;
+                count += __bits_and_count(row, BITMATRIX_ROW(m, v), v + 1, m->words);
+            }
+        }
+    }
+    return count;
+}
+
+graph_id_t* g_bitmatrix_bfs(graph_bitmatrix_t m, graph_id_t id) {
+    if (id >= m->num_verts)
+        return NULL;
+    graph_id_t n = m->num_verts, words = m->words, i;
+    graph_id_t* dist = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    graph_id_t* frontier = (graph_id_t*)malloc(((size_t)n + 1) * sizeof(graph_id_t));
+    uint64_t* visited = (uint64_t*)calloc((size_t)words + 1, sizeof(uint64_t));
+    uint64_t* next = (uint64_t*)malloc(((size_t)words + 1) * sizeof(uint64_t));
+    if (dist == NULL || frontier == NULL || visited == NULL || next == NULL) {
+        free(dist);
+        free(frontier);
+        free(visited);
+        free(next);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i)
+        dist[i] = GRAPH_INVALID_ID;
+
+    graph_id_t num = 1, level = 0;
+    dist[id] = 0;
+    frontier[0] = id;
+    visited[id >> 6] |= BITMATRIX_BIT(id);
+    while (num > 0) {
+        /*  OR the rows of the frontier together; each task does a block of
+            words so that the rows are read in order and nothing is shared */
+        int b;
+        #pragma omp parallel for schedule(static)
+        for (b = 0; b < (int)((words + BITMATRIX_BLOCK - 1) / BITMATRIX_BLOCK); ++b) {
+            graph_id_t start = (graph_id_t)b * BITMATRIX_BLOCK, j, k;
+            graph_id_t end = (start + BITMATRIX_BLOCK < words) ? start + BITMATRIX_BLOCK : words;
+            for (k = start; k < end; ++k)
+                next[k] = 0;
+            for (j = 0; j < num; ++j) {
+                const uint64_t* row = BITMATRIX_ROW(m, frontier[j]);
+                for (k = start; k < end; ++k)
+                    next[k] |= row[k];
+            }
+            for (k = start; k < end; ++k) {
+                next[k] &= ~visited[k];
+                visited[k] |= next[k];
+            }
+        }
+
+        ++level;
+        num = 0;
+        for (i = 0; i < words; ++i) {
+            uint64_t bits = next[i];
+            while (bits != 0) {
+                graph_id_t v = i * 64 + __lowest_bit(bits);
+                bits &= bits - 1;
+                dist[v] = level;
+                frontier[num++] = v;
+            }
+        }
+    }
+    free(frontier);
+    free(visited);
+    free(next);
+    return dist;
+}
+
+size_t g_bitmatrix_memory_usage(graph_bitmatrix_t m) {
+    return sizeof(BitMatrix) + ((size_t)m->num_verts * m->words + 1) * sizeof(uint64_t);
+}
+
+/* number of bits set in both a and b at positions from and up */
+static unsigned int __bits_and_count(const uint64_t* a, const uint64_t* b, unsigned int from, unsigned int words) {
+    graph_id_t j = from >> 6, count = 0;
+    if (j >= words)
+        return 0;
+    count = __popcount(a[j] & b[j] & (~(uint64_t)0 << (from & 63)));
+    for (++j; j < words; ++j)
+        count += __popcount(a[j] & b[j]);
+    return count;
+}
+
+/*******************************************************************************
+*   saving and loading
+*******************************************************************************/
+bool g_save(graph_t g, const char* filename) {
+    return g_save_alt(g, filename, NULL, NULL);
+}
+
+bool g_save_alt(graph_t g, const char* filename, g_metadata_serialize_t vertex_metadata, g_metadata_serialize_t edge_metadata) {
+    graph_csr_t c = g_csr_init(g);
+    if (c == NULL)
+        return false;
+    FILE* fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        g_csr_free(c);
+        return false;
+    }
+
+    GraphFileHeader h;
+    memset(&h, 0, sizeof(GraphFileHeader));
+    memcpy(h.magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC));
+    h.version = GRAPH_FILE_VERSION;
+    h.flags = (vertex_metadata != NULL ? GRAPH_FILE_VERTEX_METADATA : 0) | (edge_metadata != NULL ? GRAPH_FILE_EDGE_METADATA : 0);
+    h.id_bytes = sizeof(graph_id_t);
+    h.byte_order = GRAPH_FILE_BYTE_ORDER;
+    h.num_verts = c->num_verts;
+    h.num_edges = c->num_edges;
+    h.num_edge_ids = g->_prev_edge_id;
+
+    size_t n = c->num_verts, m = c->num_edges;
+    bool ok = fwrite(&h, sizeof(GraphFileHeader), 1, fp) == 1
+        && __write_padded(fp, c->exists, n)
+        && __write_padded(fp, c->offsets, (n + 1) * sizeof(graph_id_t))
+        && __write_padded(fp, c->targets, m * sizeof(graph_id_t))
+        && __write_padded(fp, c->edge_ids, m * sizeof(graph_id_t))
+        && __write_padded(fp, c->in_offsets, (n + 1) * sizeof(graph_id_t))
+        && __write_padded(fp, c->sources, m * sizeof(graph_id_t))
+        && __write_padded(fp, c->in_edge_ids, m * sizeof(graph_id_t));
+    g_csr_free(c);
+
+    if (ok && vertex_metadata != NULL) {
+        void** md = (void**)calloc(n + 1, sizeof(void*));
+        graph_id_t i;
+        vertex_t v;
+        g_iterate_vertices(g, v, i) {
+            md[i] = v->metadata;
+        }
+        ok = __write_metadata(fp, md, n, vertex_metadata);
+        free(md);
+    }
+    if (ok && edge_metadata != NULL) {
+        void** md = (void**)calloc(h.num_edge_ids + 1, sizeof(void*));
+        graph_id_t i;
+        for (i = 0; i < g->_prev_edge_id; ++i) {
+            edge_t e = __edge_at(g, i);
+            if (e != NULL)
+                md[i] = e->metadata;
+        }
+        ok = __write_metadata(fp, md, g->_prev_edge_id, edge_metadata);
+        free(md);
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+    return ok;
+}
+
+graph_csr_t g_csr_load(const char* filename) {
+    size_t size;
+    unsigned char* data;
+    if (__map_file(filename, &data, &size) == false)
+        return NULL;
+    if (size < sizeof(GraphFileHeader)) {
+        __unmap_file(data, size);
+        return NULL;
+    }
+
+    graph_csr_t c = (graph_csr_t)calloc(1, sizeof(CSR));
+    if (c == NULL) {
+        __unmap_file(data, size);
+        return NULL;
+    }
+    c->_mapped = data;
+    c->_mapped_size = size;
+
+    GraphFileHeader h;
+    memcpy(&h, data, sizeof(GraphFileHeader));
+    if (memcmp(h.magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC)) != 0 || h.version != GRAPH_FILE_VERSION
+            || h.id_bytes != sizeof(graph_id_t) || h.byte_order != GRAPH_FILE_BYTE_ORDER) {
+        g_csr_free(c);
+        return NULL;
+    }
+
+    /*  every count must fit an id and every array the file; the arrays are
+        checked one at a time so that a huge count cannot overflow the sizes */
+    if (h.num_verts >= GRAPH_INVALID_ID || h.num_edges >= GRAPH_INVALID_ID || h.num_edge_ids >= GRAPH_INVALID_ID
+            || h.num_verts >= size / sizeof(graph_id_t) || h.num_edges >= size / sizeof(graph_id_t)) {
+        g_csr_free(c);
+        return NULL;
+    }
+    size_t n = (size_t)h.num_verts, m = (size_t)h.num_edges, pos = sizeof(GraphFileHeader);
+    c->num_verts = (graph_id_t)n;
+    c->num_edges = (graph_id_t)m;
+    c->num_edge_ids = (graph_id_t)h.num_edge_ids;
+    c->exists = (unsigned char*)__file_section(data, size, &pos, n);
+    c->offsets = (graph_id_t*)__file_section(data, size, &pos, (n + 1) * sizeof(graph_id_t));
+    c->targets = (graph_id_t*)__file_section(data, size, &pos, m * sizeof(graph_id_t));
+    c->edge_ids = (graph_id_t*)__file_section(data, size, &pos, m * sizeof(graph_id_t));
+    c->in_offsets = (graph_id_t*)__file_section(data, size, &pos, (n + 1) * sizeof(graph_id_t));
+    c->sources = (graph_id_t*)__file_section(data, size, &pos, m * sizeof(graph_id_t));
+    c->in_edge_ids = (graph_id_t*)__file_section(data, size, &pos, m * sizeof(graph_id_t));
+    bool ok = c->exists != NULL && c->offsets != NULL && c->targets != NULL && c->edge_ids != NULL
+        && c->in_offsets != NULL && c->sources != NULL && c->in_edge_ids != NULL;
+
+    /* metadata: offsets into the blob followed by the blob */
+    if (ok && (h.flags & GRAPH_FILE_VERTEX_METADATA) != 0) {
+        ok = n < (size - pos) / sizeof(uint64_t);
+        if (ok) {
+            c->vertex_metadata_offsets = (const uint64_t*)__file_section(data, size, &pos, (n + 1) * sizeof(uint64_t));
+            ok = __metadata_offsets_valid(c->vertex_metadata_offsets, n, size - pos);
+        }
+        if (ok)
+            c->vertex_metadata = __file_section(data, size, &pos, (size_t)c->vertex_metadata_offsets[n]);
+        ok = ok && c->vertex_metadata != NULL;
+    }
+    if (ok && (h.flags & GRAPH_FILE_EDGE_METADATA) != 0) {
+        size_t num_ids = (size_t)h.num_edge_ids;
+        ok = num_ids < (size - pos) / sizeof(uint64_t);
+        if (ok) {
+            c->edge_metadata_offsets = (const uint64_t*)__file_section(data, size, &pos, (num_ids + 1) * sizeof(uint64_t));
+            ok = __metadata_offsets_valid(c->edge_metadata_offsets, num_ids, size - pos);
+        }
+        if (ok)
+            c->edge_metadata = __file_section(data, size, &pos, (size_t)c->edge_metadata_offsets[num_ids]);
+        ok = ok && c->edge_metadata != NULL;
+    }
+    if (!ok || !__csr_valid(c)) {
+        g_csr_free(c);
+        return NULL;
+    }
+    return c;
+}
+
+graph_t g_load(const char* filename) {
+    return g_load_alt(filename, NULL, NULL);
+}
+
+graph_t g_load_alt(const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata) {
+    graph_csr_t c = g_csr_load(filename);
+    if (c == NULL)
+        return NULL;
+
+    graph_id_t n = c->num_verts, m = c->num_edges;
+    graph_t g = g_init_alt(n > 1024 ? n : 1024);
+    graph_id_t* src = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    void** md = (edge_metadata != NULL) ? (void**)malloc((m + 1) * sizeof(void*)) : NULL;
+    if (g == NULL || src == NULL || (edge_metadata != NULL && md == NULL)) {
+        if (g != NULL)
+            g_free(g);
+        free(src);
+        free(md);
+        g_csr_free(c);
+        return NULL;
+    }
+
+    graph_id_t i, j;
+    size_t len;
+    bool ok = true;
+    for (i = 0; i < n && ok; ++i) {
+        if (c->exists[i] == 0)
+            continue;
+        const void* data = g_csr_vertex_metadata(c, i, &len);
+        void* metadata = (vertex_metadata != NULL && data != NULL) ? vertex_metadata(data, len) : NULL;
+        if (g_vertex_add_alt(g, i, metadata) == NULL) {
+            free(metadata);
+            ok = false;
+        }
+    }
+
+    for (i = 0; i < n && ok; ++i) {
+        for (j = c->offsets[i]; j < c->offsets[i + 1]; ++j) {
+            src[j] = i;
+            if (md != NULL) {
+                const void* data = g_csr_edge_metadata(c, c->edge_ids[j], &len);
+                md[j] = (data != NULL) ? edge_metadata(data, len) : NULL;
+            }
+        }
+    }
+    if (ok && m > 0 && __edges_add_batch(g, src, c->targets, md, c->edge_ids, m) != m) {
+        /* the metadata of the edges that were not added is not in the graph */
+        for (j = 0; md != NULL && j < m; ++j) {
+            edge_t e = __edge_at(g, c->edge_ids[j]);
+            if (e == NULL || e->metadata != md[j])
+                free(md[j]);
+        }
+        ok = false;
+    }
+
+    /* keep handing out new ids after those already used */
+    if (ok && c->num_edge_ids > g->_prev_edge_id) {
+        __graph_edges_grow(g, c->num_edge_ids);
+        g->_prev_edge_id = c->num_edge_ids;
+    }
+
+    free(src);
+    free(md);
+    g_csr_free(c);
+    if (!ok) {
+        g_free(g);
+        return NULL;
+    }
+    return g;
+}
+
+graph_t g_load_edge_list(const char* filename, const graph_edge_list_options* opts, double** weights) {
+    if (weights != NULL)
+        *weights = NULL;
+    bool undirected = (opts != NULL) ? opts->undirected : false;
+    graph_id_t base = (opts != NULL && opts->one_based) ? 1 : 0;
+
+    size_t size;
+    unsigned char* data;
+    if (__map_file(filename, &data, &size) == false)
+        return NULL;
+
+    /*  split into a few chunks per thread, each ending at the end of a line so
+        that no line is split between chunks */
+    int num_chunks = (size < (1 << 20)) ? 1 : NUM_THREADS() * 4, t;
+    EdgeListChunk* chunks = (EdgeListChunk*)calloc(num_chunks, sizeof(EdgeListChunk));
+    if (chunks == NULL) {
+        __unmap_file(data, size);
+        return NULL;
+    }
+    const char* text = (const char*)data;
+    const char* end = text + size;
+    const char* p = text;
+    for (t = 0; t < num_chunks; ++t) {
+        chunks[t].start = p;
+        if (t == num_chunks - 1) {
+            p = end;
+        } else {
+            const char* q = text + (size / num_chunks) * (t + 1);
+            if (q < p)
+                q = p;
+            while (q < end && *q != '\n')
+                ++q;
+            p = (q < end) ? q + 1 : end;
+        }
+        chunks[t].end = p;
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (t = 0; t < num_chunks; ++t)
+        __parse_edge_list(&chunks[t], weights != NULL, base);
+    __unmap_file(data, size);
+
+    /* stitch the chunks back together in file order */
+    size_t m = 0, k = 0;
+    graph_id_t i, max_id = 0;
+    bool any = false, failed = false;
+    for (t = 0; t < num_chunks; ++t) {
+        if (chunks[t].failed == true)
+            failed = true;
+        m += chunks[t].src.size;
+        for (i = 0; i < chunks[t].src.size; ++i) {
+            graph_id_t larger = (chunks[t].src.ids[i] > chunks[t].dest.ids[i]) ? chunks[t].src.ids[i] : chunks[t].dest.ids[i];
+            if (larger >= max_id)
+                max_id = larger;
+            any = true;
+        }
+    }
+    size_t total = undirected ? 2 * m : m;
+    graph_id_t* src = (graph_id_t*)malloc((total + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((total + 1) * sizeof(graph_id_t));
+    double* w = (weights != NULL) ? (double*)malloc((total + 1) * sizeof(double)) : NULL;
+    graph_t g = (failed == false) ? g_init_alt((any && max_id >= 1024) ? max_id + 1 : 1024) : NULL;
+    if (src == NULL || dest == NULL || (weights != NULL && w == NULL) || g == NULL) {
+        free(src);
+        free(dest);
+        free(w);
+        if (g != NULL)
+            g_free(g);
+        g = NULL;
+    } else {
+        for (t = 0; t < num_chunks; ++t) {
+            memcpy(src + k, chunks[t].src.ids, chunks[t].src.size * sizeof(graph_id_t));
+            memcpy(dest + k, chunks[t].dest.ids, chunks[t].dest.size * sizeof(graph_id_t));
+            if (w != NULL)
+                memcpy(w + k, chunks[t].weights, chunks[t].src.size * sizeof(double));
+            k += chunks[t].src.size;
+        }
+        if (undirected) {
+            memcpy(src + m, dest, m * sizeof(graph_id_t));
+            memcpy(dest + m, src, m * sizeof(graph_id_t));
+            if (w != NULL)
+                memcpy(w + m, w, m * sizeof(double));
+        }
+    }
+    for (t = 0; t < num_chunks; ++t) {
+        free(chunks[t].src.ids);
+        free(chunks[t].dest.ids);
+        free(chunks[t].weights);
+    }
+    free(chunks);
+    if (g == NULL)
+        return NULL;
+
+    if (any) {
+        for (i = 0; i <= max_id; ++i)
+            g_vertex_add_alt(g, i, NULL);
+    }
+    size_t added = __edges_add_batch(g, src, dest, NULL, NULL, total);
+    free(src);
+    free(dest);
+    if (added != total) {
+        free(w);
+        g_free(g);
+        return NULL;
+    }
+
+    if (weights != NULL)
+        *weights = w;
+    return g;
+}
+
+static void __parse_edge_list(EdgeListChunk* chunk, bool weighted, graph_id_t base) {
+    const char* p = chunk->start;
+    const char* end = chunk->end;
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            ++p;
+        if (p == end)
+            break;
+
+        graph_id_t src, dest;
+        double w = 1.0;
+        const char* q = NULL;
+        if (*p != '#' && *p != '%' && *p != '\n') {
+            q = __parse_uint(p, end, &src);
+            while (q != NULL && q < end && (*q == ' ' || *q == '\t' || *q == ','))
+                ++q;
+            if (q != NULL)
+                q = __parse_uint(q, end, &dest);
+            if (q != NULL && weighted) {
+                while (q < end && (*q == ' ' || *q == '\t' || *q == ','))
+                    ++q;
+                const char* r = __parse_double(q, end, &w);
+                if (r != NULL)
+                    q = r;
+            }
+        }
+        if (q != NULL && src >= base && dest >= base) {
+            if (__id_list_push(&chunk->src, src - base) == false || __id_list_push(&chunk->dest, dest - base) == false) {
+                chunk->failed = true;
+                return;
+            }
+            if (weighted) {
+                if (chunk->src.size > chunk->_max_weights) {
+                    double* tmp = (double*)realloc(chunk->weights, chunk->src._max * sizeof(double));
+                    if (tmp == NULL) {
+                        chunk->failed = true;
+                        return;
+                    }
+                    chunk->weights = tmp;
+                    chunk->_max_weights = chunk->src._max;
+                }
+                chunk->weights[chunk->src.size - 1] = w;
+            }
+            p = q;
+        }
+
+        /* on to the next line; also skips comments and malformed lines */
+        while (p < end && *p != '\n')
+            ++p;
+        ++p;
+    }
+}
+
+static const char* __parse_uint(const char* p, const char* end, graph_id_t* val) {
+    if (p >= end || *p < '0' || *p > '9')
+        return NULL;
+    /* GRAPH_INVALID_ID is reserved, so anything that reaches it is too large */
+    graph_id_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        graph_id_t d = (graph_id_t)(*p++ - '0');
+        if (v > (GRAPH_INVALID_ID - 1 - d) / 10)
+            return NULL;
+        v = v * 10 + d;
+    }
+    *val = v;
+    return p;
+}
+
+static const char* __parse_double(const char* p, const char* end, double* val) {
+    /*  the mapped file is not null terminated, so copy the token out and let
+        strtod do the conversion; it rounds correctly, which summing the digits
+        one at a time does not */
+    char buf[64];
+    size_t len = 0;
+    while (p + len < end && len < sizeof(buf) - 1 && strchr("0123456789+-.eE", p[len]) != NULL && p[len] != '\0')
+        ++len;
+    if (len == 0)
+        return NULL;
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+
+    char* stop;
+    double v = strtod(buf, &stop);
+    if (stop == buf)
+        return NULL;
+    *val = v;
+    return p + (stop - buf);
+}
+
+static bool __map_file(const char* filename, unsigned char** data, size_t* size) {
+    /* an empty file is valid, but there is nothing to map */
+    *data = NULL;
+    *size = 0;
+    #if defined(GRAPH_NO_MMAP)
+        FILE* fp = fopen(filename, "rb");
+        if (fp == NULL)
+            return false;
+        fseek(fp, 0, SEEK_END);
+        long len = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        if (len <= 0) {
+            fclose(fp);
+            return len == 0;
+        }
+        unsigned char* buf = (unsigned char*)malloc((size_t)len);
+        if (buf == NULL || fread(buf, 1, (size_t)len, fp) != (size_t)len) {
+            free(buf);
+            fclose(fp);
+            return false;
+        }
+        fclose(fp);
+        *data = buf;
+        *size = (size_t)len;
+    #else
+        int fd = open(filename, O_RDONLY);
+        if (fd == -1)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            close(fd);
+            return true;
+        }
+        void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+            return false;
+        *data = (unsigned char*)mapped;
+        *size = (size_t)st.st_size;
+    #endif
+    return true;
+}
+
+static void __unmap_file(void* data, size_t size) {
+    if (data == NULL)
+        return;
+    #if defined(GRAPH_NO_MMAP)
+        (void)size;
+        free(data);
+    #else
+        munmap(data, size);
+    #endif
+}
+
+static bool __write_metadata(FILE* fp, void** metadata, graph_id_t num, g_metadata_serialize_t serialize) {
+    uint64_t* offsets = (uint64_t*)calloc((size_t)num + 1, sizeof(uint64_t));
+    const void** data = (const void**)calloc((size_t)num + 1, sizeof(void*));
+    if (offsets == NULL || data == NULL) {
+        free(offsets);
+        free(data);
+        return false;
+    }
+
+    graph_id_t i;
+    for (i = 0; i < num; ++i) {
+        size_t len = 0;
+        if (metadata[i] != NULL)
+            data[i] = serialize(metadata[i], &len);
+        if (data[i] == NULL)
+            len = 0;
+        offsets[i + 1] = offsets[i] + len;
+    }
+
+    bool ok = fwrite(offsets, sizeof(uint64_t), (size_t)num + 1, fp) == (size_t)num + 1;
+    for (i = 0; ok && i < num; ++i) {
+        size_t len = (size_t)(offsets[i + 1] - offsets[i]);
+        if (len > 0)
+            ok = fwrite(data[i], 1, len, fp) == len;
+    }
+    if (ok)
+        ok = __write_padded(fp, NULL, (size_t)offsets[num]);
+    free(offsets);
+    free(data);
+    return ok;
+}
+
+static bool __write_padded(FILE* fp, const void* data, size_t bytes) {
+    /* if data is NULL, only the padding is written */
+    static const char zeros[8] = {0};
+    if (data != NULL && bytes > 0 && fwrite(data, 1, bytes, fp) != bytes)
+        return false;
+    size_t pad = __pad8(bytes) - bytes;
+    return pad == 0 || fwrite(zeros, 1, pad, fp) == pad;
+}
+
+static size_t __pad8(size_t bytes) {
+    return (bytes + 7) & ~((size_t)7);
+}
+
+/*  the bytes at pos, moving pos past them and their padding; NULL if they do
+    not fit in the file */
+static const unsigned char* __file_section(const unsigned char* data, size_t size, size_t* pos, size_t bytes) {
+    if (*pos > size || bytes > size - *pos || __pad8(bytes) > size - *pos)
+        return NULL;
+    const unsigned char* p = data + *pos;
+    *pos += __pad8(bytes);
+    return p;
+}
+
+/* metadata offsets must start at 0, never go backwards and end in the blob */
+static bool __metadata_offsets_valid(const uint64_t* offsets, size_t num, size_t available) {
+    size_t i;
+    if (offsets == NULL || offsets[0] != 0 || offsets[num] > available)
+        return false;
+    for (i = 0; i < num; ++i) {
+        if (offsets[i] > offsets[i + 1])
+            return false;
+    }
+    return true;
+}
+
+/*  check a frozen graph read from a file before it is used: both offset
+    arrays start at 0, never go backwards and end at the number of edges,
+    every source and target is a vertex id and the edge ids are distinct and
+    below num_edge_ids, the same ones out of and into the vertices */
+static bool __csr_valid(graph_csr_t c) {
+    graph_id_t n = c->num_verts, m = c->num_edges, i;
+    if (c->offsets[0] != 0 || c->in_offsets[0] != 0 || c->offsets[n] != m || c->in_offsets[n] != m)
+        return false;
+    for (i = 0; i < n; ++i) {
+        if (c->offsets[i] > c->offsets[i + 1] || c->in_offsets[i] > c->in_offsets[i + 1])
+            return false;
+    }
+    for (i = 0; i < m; ++i) {
+        if (c->targets[i] >= n || c->sources[i] >= n || c->edge_ids[i] >= c->num_edge_ids || c->in_edge_ids[i] >= c->num_edge_ids)
+            return false;
+    }
+
+    /* set a bit for each id out of a vertex, then clear it for each id into one */
+    uint64_t* seen = (uint64_t*)calloc(((size_t)c->num_edge_ids + 63) / 64 + 1, sizeof(uint64_t));
+    if (seen == NULL)
+        return false;
+    bool ok = true;
+    for (i = 0; i < m && ok; ++i) {
+        graph_id_t id = c->edge_ids[i];
+        uint64_t bit = (uint64_t)1 << (id & 63);
+        ok = (seen[id >> 6] & bit) == 0;
+        seen[id >> 6] |= bit;
+    }
+    for (i = 0; i < m && ok; ++i) {
+        graph_id_t id = c->in_edge_ids[i];
+        uint64_t bit = (uint64_t)1 << (id & 63);
+        ok = (seen[id >> 6] & bit) != 0;
+        seen[id >> 6] &= ~bit;
+    }
+    free(seen);
+    return ok;
+}
+
+/*******************************************************************************
+*   change log
+*******************************************************************************/
+graph_log_t g_log_open(graph_t g, const char* snapshot, const char* filename) {
+    return g_log_open_alt(g, snapshot, filename, NULL, NULL, 0);
+}
+
+graph_log_t g_log_open_alt(graph_t g, const char* snapshot, const char* filename, g_metadata_serialize_t vertex_metadata, g_metadata_serialize_t edge_metadata, size_t compact_bytes) {
+    if (g->_log != NULL || snapshot == NULL || filename == NULL)
+        return NULL;
+    graph_log_t l = (graph_log_t)calloc(1, sizeof(GraphLog));
+    if (l == NULL)
+        return NULL;
+    size_t len_snapshot = strlen(snapshot) + 1, len_filename = strlen(filename) + 1;
+    l->snapshot = (char*)malloc(len_snapshot);
+    l->filename = (char*)malloc(len_filename);
+    if (l->snapshot == NULL || l->filename == NULL) {
+        free(l->snapshot);
+        free(l->filename);
+        free(l);
+        return NULL;
+    }
+    memcpy(l->snapshot, snapshot, len_snapshot);
+    memcpy(l->filename, filename, len_filename);
+    l->g = g;
+    l->vertex_metadata = vertex_metadata;
+    l->edge_metadata = edge_metadata;
+    l->compact_bytes = compact_bytes;
+    l->flags = (vertex_metadata != NULL ? GRAPH_FILE_VERTEX_METADATA : 0) | (edge_metadata != NULL ? GRAPH_FILE_EDGE_METADATA : 0);
+    l->ok = true;
+
+    /*  keep appending to a log that was written the same way and ends with a
+        complete record; anything else starts over from a new snapshot */
+    size_t size;
+    unsigned char* data;
+    bool append = false;
+    if (__map_file(filename, &data, &size)) {
+        GraphLogHeader h;
+        size_t valid = __log_check(data, size, &h, NULL);
+        append = valid == size && h.flags == l->flags;
+        __unmap_file(data, size);
+    }
+    if (append) {
+        l->fp = fopen(filename, "ab");
+        l->written = size;
+    }
+    if (l->fp == NULL && !g_log_compact(l)) {
+        g_log_close(l);
+        return NULL;
+    }
+    g->_log = l;
+    return l;
+}
+
+bool g_log_flush(graph_log_t l) {
+    SPIN_LOCK(l->_lock);
+    bool ok = __log_write(l) && l->fp != NULL && fflush(l->fp) == 0;
+    l->ok = l->ok && ok;
+    SPIN_UNLOCK(l->_lock);
+    return ok;
+}
+
+bool g_log_compact(graph_log_t l) {
+    /*  write the snapshot next to the old one and swap it in before starting
+        the new log; if stopped in between, the old log replays cleanly onto
+        the new snapshot since records that no longer apply are skipped */
+    size_t len = strlen(l->snapshot);
+    char* tmp = (char*)malloc(len + 5);
+    if (tmp == NULL)
+        return false;
+    memcpy(tmp, l->snapshot, len);
+    memcpy(tmp + len, ".tmp", 5);
+
+    bool ok = g_save_alt(l->g, tmp, l->vertex_metadata, l->edge_metadata);
+    #if defined(GRAPH_NO_MMAP)
+        if (ok)
+            remove(l->snapshot);  /* rename does not replace a file on windows */
+    #endif
+    ok = ok && rename(tmp, l->snapshot) == 0;
+    if (!ok)
+        remove(tmp);
+    free(tmp);
+
+    /* the buffered records are in the snapshot */
+    SPIN_LOCK(l->_lock);
+    if (ok) {
+        l->size = 0;
+        ok = __log_restart(l);
+    }
+    SPIN_UNLOCK(l->_lock);
+    return ok;
+}
+
+bool g_log_checkpoint(graph_log_t l) {
+    if (l->compact_bytes > 0 && g_log_size(l) >= l->compact_bytes)
+        return g_log_compact(l);
+    return g_log_flush(l);
+}
+
+size_t g_log_size(graph_log_t l) {
+    SPIN_LOCK(l->_lock);
+    size_t size = l->written + l->size;
+    SPIN_UNLOCK(l->_lock);
+    return size;
+}
+
+bool g_log_close(graph_log_t l) {
+    bool ok = false;
+    if (l->fp != NULL) {
+        ok = g_log_flush(l) && l->ok;
+        if (fclose(l->fp) != 0)
+            ok = false;
+    }
+    if (l->g->_log == l)
+        l->g->_log = NULL;
+    free(l->snapshot);
+    free(l->filename);
+    free(l->buf);
+    free(l);
+    return ok;
+}
+
+bool g_log_replay(graph_t g, const char* filename) {
+    return g_log_replay_alt(g, filename, NULL, NULL);
+}
+
+bool g_log_replay_alt(graph_t g, const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata) {
+    size_t size;
+    unsigned char* data;
+    if (__map_file(filename, &data, &size) == false)
+        return false;
+    if (size == 0)  /* stopped before the header was written */
+        return true;
+
+    GraphLogHeader h;
+    size_t max_edges = 0;
+    size_t valid = __log_check(data, size, &h, &max_edges);
+    if (valid == 0) {
+        __unmap_file(data, size);
+        return false;
+    }
+
+    /*  edges added one after the other are added in bulk; the batch is added
+        before any other record, or an edge id that is not past those in the
+        batch, so that the batch never repeats an id */
+    size_t num = 0;
+    graph_id_t batch_max = 0;
+    graph_id_t* src = (graph_id_t*)malloc((max_edges + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((max_edges + 1) * sizeof(graph_id_t));
+    graph_id_t* ids = (graph_id_t*)malloc((max_edges + 1) * sizeof(graph_id_t));
+    void** md = (void**)malloc((max_edges + 1) * sizeof(void*));
+    if (src == NULL || dest == NULL || ids == NULL || md == NULL) {
+        free(src);
+        free(dest);
+        free(ids);
+        free(md);
+        __unmap_file(data, size);
+        return false;
+    }
+
+    /* replaying is not a change to record */
+    graph_log_t l = g->_log;
+    g->_log = NULL;
+
+    const unsigned char* p = data + sizeof(GraphLogHeader);
+    const unsigned char* end = data + valid;
+    bool ok = true;
+    while (ok && p < end) {
+        LogRecord r;
+        p = __log_read(p, end, h.flags, &r);
+        if (num > 0 && (r.op != GRAPH_LOG_EDGE_ADD || r.id <= batch_max)) {
+            ok = __log_replay_edges(g, src, dest, md, ids, num);
+            num = 0;
+            if (!ok)
+                break;
+        }
+
+        if (r.op == GRAPH_LOG_VERTEX_ADD) {
+            if (r.id < g->_prev_vert_id && __vertex_at(g, r.id) != NULL)
+                continue;
+            void* metadata = (vertex_metadata != NULL && r.metadata != NULL) ? vertex_metadata(r.metadata, r.len) : NULL;
+            if (g_vertex_add_alt(g, r.id, metadata) == NULL) {
+                free(metadata);
+                ok = false;
+            }
+        } else if (r.op == GRAPH_LOG_VERTEX_REMOVE) {
+            g_vertex_retire(g, g_vertex_remove(g, r.id), true);
+        } else if (r.op == GRAPH_LOG_EDGE_ADD) {
+            /* the ends were checked before the metadata is built */
+            graph_id_t n = g->_prev_vert_id;
+            if ((r.id < g->_prev_edge_id && __edge_at(g, r.id) != NULL) || r.src >= n || r.dest >= n
+                    || __vertex_at(g, r.src) == NULL || __vertex_at(g, r.dest) == NULL)
+                continue;
+            src[num] = r.src;
+            dest[num] = r.dest;
+            ids[num] = r.id;
+            md[num] = (edge_metadata != NULL && r.metadata != NULL) ? edge_metadata(r.metadata, r.len) : NULL;
+            batch_max = r.id;
+            ++num;
+        } else {
+            g_edge_retire(g, g_edge_remove(g, r.id), true);
+        }
+    }
+    if (ok && num > 0)
+        ok = __log_replay_edges(g, src, dest, md, ids, num);
+
+    g->_log = l;
+    free(src);
+    free(dest);
+    free(ids);
+    free(md);
+    __unmap_file(data, size);
+    return ok;
+}
+
+static bool __log_replay_edges(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, const graph_id_t* ids, size_t num) {
+    /*  every edge in the batch was checked against the graph, so one that is
+        not added means the graph ran out of memory; free the metadata that
+        did not make it into the graph */
+    if (__edges_add_batch(g, src, dest, metadata, ids, num) == num)
+        return true;
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        edge_t e = __edge_at(g, ids[i]);
+        if (e == NULL || e->metadata != metadata[i])
+            free(metadata[i]);
+    }
+    return false;
+}
+
+graph_t g_log_load(const char* snapshot, const char* filename) {
+    return g_log_load_alt(snapshot, filename, NULL, NULL);
+}
+
+graph_t g_log_load_alt(const char* snapshot, const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata) {
+    /* a missing file is nothing to load, but one that does not load is an error */
+    FILE* fp = fopen(snapshot, "rb");
+    graph_t g = NULL;
+    if (fp != NULL) {
+        fclose(fp);
+        g = g_load_alt(snapshot, vertex_metadata, edge_metadata);
+    } else {
+        g = g_init();
+    }
+    if (g == NULL)
+        return NULL;
+
+    fp = fopen(filename, "rb");
+    if (fp != NULL) {
+        fclose(fp);
+        if (!g_log_replay_alt(g, filename, vertex_metadata, edge_metadata)) {
+            g_free(g);
+            return NULL;
+        }
+    }
+    return g;
+}
+
+/*  add a record to the buffer, writing the buffer out once it fills; the
+    metadata is serialized before taking the lock */
+static void __log_record(graph_log_t l, unsigned char op, graph_id_t id, graph_id_t src, graph_id_t dest, void* metadata) {
+    g_metadata_serialize_t serialize = NULL;
+    if (op == GRAPH_LOG_VERTEX_ADD)
+        serialize = l->vertex_metadata;
+    else if (op == GRAPH_LOG_EDGE_ADD)
+        serialize = l->edge_metadata;
+    const void* bytes = NULL;
+    size_t len = 0;
+    if (serialize != NULL && metadata != NULL)
+        bytes = serialize(metadata, &len);
+
+    /* at most 10 bytes for each varint */
+    unsigned char head[41];
+    unsigned char* p = head;
+    *p++ = op;
+    p = __log_encode(p, id);
+    if (op == GRAPH_LOG_EDGE_ADD) {
+        p = __log_encode(p, src);
+        p = __log_encode(p, dest);
+    }
+    if (serialize != NULL)  /* 0 for no metadata, otherwise one more than its length */
+        p = __log_encode(p, (bytes == NULL) ? 0 : (uint64_t)len + 1);
+    size_t num = (size_t)(p - head), needed = num + ((bytes == NULL) ? 0 : len);
+
+    SPIN_LOCK(l->_lock);
+    if (l->size + needed > l->max) {
+        size_t max = (l->max == 0) ? GRAPH_LOG_BUFFER : l->max;
+        while (max < l->size + needed)
+            max *= 2;
+        unsigned char* tmp = (unsigned char*)realloc(l->buf, max);
+        if (tmp == NULL) {
+            l->ok = false;
+            SPIN_UNLOCK(l->_lock);
+            return;
+        }
+        l->buf = tmp;
+        l->max = max;
+    }
+    memcpy(l->buf + l->size, head, num);
+    if (bytes != NULL && len > 0)
+        memcpy(l->buf + l->size + num, bytes, len);
+    l->size += needed;
+    if (l->size >= GRAPH_LOG_BUFFER)
+        l->ok = __log_write(l) && l->ok;
+    SPIN_UNLOCK(l->_lock);
+}
+
+/* write the buffered records to the file; the caller holds the lock */
+static bool __log_write(graph_log_t l) {
+    if (l->fp == NULL)
+        return false;
+    if (l->size == 0)
+        return true;
+    bool ok = fwrite(l->buf, 1, l->size, l->fp) == l->size;
+    l->written += l->size;
+    l->size = 0;
+    return ok;
+}
+
+/* start a new log holding just the header; the caller holds the lock */
+static bool __log_restart(graph_log_t l) {
+    if (l->fp != NULL)
+        fclose(l->fp);
+    l->fp = fopen(l->filename, "wb");
+    l->written = 0;
+    if (l->fp == NULL)
+        return false;
+
+    GraphLogHeader h;
+    memset(&h, 0, sizeof(GraphLogHeader));
+    memcpy(h.magic, GRAPH_LOG_MAGIC, sizeof(GRAPH_LOG_MAGIC));
+    h.version = GRAPH_LOG_VERSION;
+    h.flags = l->flags;
+    h.id_bytes = sizeof(graph_id_t);
+    bool ok = fwrite(&h, sizeof(GraphLogHeader), 1, l->fp) == 1 && fflush(l->fp) == 0;
+    l->written = sizeof(GraphLogHeader);
+    l->ok = ok;
+    return ok;
+}
+
+/*  check the header and find the end of the last complete record, counting
+    the edges added if num_edges is not NULL; returns 0 if it is not a log
+    written with the same id size */
+static size_t __log_check(const unsigned char* data, size_t size, GraphLogHeader* h, size_t* num_edges) {
+    if (size < sizeof(GraphLogHeader))
+        return 0;
+    memcpy(h, data, sizeof(GraphLogHeader));
+    if (memcmp(h->magic, GRAPH_LOG_MAGIC, sizeof(GRAPH_LOG_MAGIC)) != 0 || h->version != GRAPH_LOG_VERSION || h->id_bytes != sizeof(graph_id_t))
+        return 0;
+
+    const unsigned char* p = data + sizeof(GraphLogHeader);
+    const unsigned char* end = data + size;
+    while (p < end) {
+        LogRecord r;
+        const unsigned char* next = __log_read(p, end, h->flags, &r);
+        if (next == NULL)
+            break;
+        if (num_edges != NULL && r.op == GRAPH_LOG_EDGE_ADD)
+            ++*num_edges;
+        p = next;
+    }
+    return (size_t)(p - data);
+}
+
+/* read the record at p; returns NULL if it is cut short or not a record */
+static const unsigned char* __log_read(const unsigned char* p, const unsigned char* end, unsigned int flags, LogRecord* r) {
+    uint64_t x;
+    memset(r, 0, sizeof(LogRecord));
+    r->op = *p++;
+    if (r->op < GRAPH_LOG_VERTEX_ADD || r->op > GRAPH_LOG_EDGE_REMOVE)
+        return NULL;
+    if ((p = __log_decode(p, end, &x)) == NULL || x >= GRAPH_INVALID_ID)
+        return NULL;
+    r->id = (graph_id_t)x;
+    if (r->op == GRAPH_LOG_EDGE_ADD) {
+        if ((p = __log_decode(p, end, &x)) == NULL || x >= GRAPH_INVALID_ID)
+            return NULL;
+        r->src = (graph_id_t)x;
+        if ((p = __log_decode(p, end, &x)) == NULL || x >= GRAPH_INVALID_ID)
+            return NULL;
+        r->dest = (graph_id_t)x;
+    }
+
+    bool has_metadata = (r->op == GRAPH_LOG_VERTEX_ADD && (flags & GRAPH_FILE_VERTEX_METADATA) != 0)
+        || (r->op == GRAPH_LOG_EDGE_ADD && (flags & GRAPH_FILE_EDGE_METADATA) != 0);
+    if (has_metadata) {
+        if ((p = __log_decode(p, end, &x)) == NULL || (x > 0 && x - 1 > (uint64_t)(end - p)))
+            return NULL;
+        if (x > 0) {
+            r->metadata = p;
+            r->len = (size_t)(x - 1);
+            p += r->len;
+        }
+    }
+    return p;
+}
+
+static unsigned char* __log_encode(unsigned char* p, uint64_t x) {
+    while (x >= 0x80) {
+        *p++ = (unsigned char)(x | 0x80);
+        x >>= 7;
+    }
+    *p++ = (unsigned char)x;
+    return p;
+}
+
+static const unsigned char* __log_decode(const unsigned char* p, const unsigned char* end, uint64_t* x) {
+    unsigned int shift = 0;
+    *x = 0;
+    while (p < end && shift < 64) {
+        unsigned char b = *p++;
+        *x |= (uint64_t)(b & 0x7F) << shift;
+        if (b < 0x80)
+            return p;
+        shift += 7;
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+*   generators
+*******************************************************************************/
+#define GENERATOR_CHUNK 65536  /* edges drawn from each random stream */
+#define RMAT_A 0.57
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+
+graph_t g_generate_erdos_renyi(graph_id_t n, graph_id_t m, unsigned long long seed) {
+    graph_id_t* src = (graph_id_t*)malloc(((size_t)m + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc(((size_t)m + 1) * sizeof(graph_id_t));
+    if (src == NULL || dest == NULL || (n < 2 && m > 0)) {
+        free(src);
+        free(dest);
+        return NULL;
+    }
+
+    /*  each chunk has its own stream so that the graph is the same no matter
+        the number of threads */
+    int chunk;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (chunk = 0; chunk < (int)((m + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK); ++chunk) {
+        uint64_t state = seed ^ (0x9E3779B97F4A7C15ULL * (chunk + 1));
+        graph_id_t i = (graph_id_t)chunk * GENERATOR_CHUNK;
+        graph_id_t end = (m - i < GENERATOR_CHUNK) ? m : i + GENERATOR_CHUNK;
+        for (; i < end; ++i) {
+            src[i] = (graph_id_t)(__rand_next(&state) % n);
+            do {
+                dest[i] = (graph_id_t)(__rand_next(&state) % n);
+            } while (dest[i] == src[i]);
+        }
+    }
+    graph_t g = __generated_graph(n, src, dest, m);
+    free(src);
+    free(dest);
+    return g;
+}
+
+graph_t g_generate_rmat(unsigned int scale, unsigned int edge_factor, unsigned long long seed) {
+    if (scale >= 8 * sizeof(graph_id_t))
+        return NULL;
+    graph_id_t n = (graph_id_t)1 << scale;
+    size_t m = (size_t)n * edge_factor;
+    graph_id_t* src = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    if (src == NULL || dest == NULL) {
+        free(src);
+        free(dest);
+        return NULL;
+    }
+
+    /* each edge picks a quadrant of the adjacency matrix at every level */
+    long long chunk;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (chunk = 0; chunk < (long long)((m + GENERATOR_CHUNK - 1) / GENERATOR_CHUNK); ++chunk) {
+        uint64_t state = seed ^ (0x9E3779B97F4A7C15ULL * (chunk + 1));
+        size_t i = (size_t)chunk * GENERATOR_CHUNK;
+        size_t end = (m - i < GENERATOR_CHUNK) ? m : i + GENERATOR_CHUNK;
+        for (; i < end; ++i) {
+            graph_id_t u = 0, v = 0, level;
+            for (level = 0; level < scale; ++level) {
+                double r = __rand_double(&state);
+                u <<= 1;
+                v <<= 1;
+                if (r < RMAT_A) {
+                    /* top left */
+                } else if (r < RMAT_A + RMAT_B) {
+                    v |= 1;
+                } else if (r < RMAT_A + RMAT_B + RMAT_C) {
+                    u |= 1;
+                } else {
+                    u |= 1;
+                    v |= 1;
+                }
+            }
+            src[i] = u;
+            dest[i] = v;
+        }
+    }
+    graph_t g = __generated_graph(n, src, dest, m);
+    free(src);
+    free(dest);
+    return g;
+}
+
+graph_t g_generate_grid(unsigned int rows, unsigned int cols) {
+    size_t n = (size_t)rows * cols;
+    size_t m = 2 * ((size_t)rows * (cols > 0 ? cols - 1 : 0) + (size_t)cols * (rows > 0 ? rows - 1 : 0));
+    if (n >= GRAPH_INVALID_ID)
+        return NULL;
+    graph_id_t* src = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    if (src == NULL || dest == NULL) {
+        free(src);
+        free(dest);
+        return NULL;
+    }
+
+    size_t k = 0;
+    graph_id_t r, c;
+    for (r = 0; r < rows; ++r) {
+        for (c = 0; c < cols; ++c) {
+            graph_id_t id = r * cols + c;
+            if (c + 1 < cols) {
+                src[k] = id;
+                dest[k++] = id + 1;
+                src[k] = id + 1;
+                dest[k++] = id;
+            }
+            if (r + 1 < rows) {
+                src[k] = id;
+                dest[k++] = id + cols;
+                src[k] = id + cols;
+                dest[k++] = id;
+            }
+        }
+    }
+    graph_t g = __generated_graph((graph_id_t)n, src, dest, m);
+    free(src);
+    free(dest);
+    return g;
+}
+
+graph_t g_generate_power_law(graph_id_t n, unsigned int k, unsigned long long seed) {
+    if (k == 0 || n <= k)
+        return __generated_graph(n, NULL, NULL, 0);
+    size_t m = (size_t)(n - k) * k;
+    graph_id_t* src = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc((m + 1) * sizeof(graph_id_t));
+    if (src == NULL || dest == NULL) {
+        free(src);
+        free(dest);
+        return NULL;
+    }
+
+    /*  picking a uniformly random end of a random earlier edge picks a vertex
+        in proportion to its degree; the first k vertices start out equally
+        likely as there are no edges yet */
+    uint64_t state = seed;
+    size_t e = 0;
+    graph_id_t v, j;
+    for (v = k; v < n; ++v) {
+        for (j = 0; j < k; ++j) {
+            graph_id_t target;
+            if (e == 0 || __rand_next(&state) % (2 * e + k) < k) {
+                target = (graph_id_t)(__rand_next(&state) % k);
+            } else {
+                size_t pick = (size_t)(__rand_next(&state) % (2 * e));
+                target = (pick & 1) ? dest[pick / 2] : src[pick / 2];
+            }
+            src[e] = v;
+            dest[e++] = target;
+        }
+    }
+    graph_t g = __generated_graph(n, src, dest, m);
+    free(src);
+    free(dest);
+    return g;
+}
+
+static graph_t __generated_graph(graph_id_t n, const graph_id_t* src, const graph_id_t* dest, size_t m) {
+    graph_t g = g_init_alt(n > 0 ? n : 1);
+    if (g == NULL)
+        return NULL;
+    graph_id_t i;
+    for (i = 0; i < n; ++i)
+        g_vertex_add_alt(g, i, NULL);
+    if (m > 0)
+        __edges_add_batch(g, src, dest, NULL, NULL, m);
+    return g;
+}
+
+/* xorshift64* */
+static uint64_t __rand_next(uint64_t* state) {
+    uint64_t x = (*state != 0) ? *state : 0x9E3779B97F4A7C15ULL;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double __rand_double(uint64_t* state) {
+    return (__rand_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void __graph_vertices_grow(graph_t g, graph_id_t id) {
+    /*  allocate any missing segments up to the one holding id; in parallel
+        code, the work may have been done by another thread, so it should be
+        checked one more time once in the critical section */
+    graph_id_t offset, k, last = __segment(g, id, &offset);
+    for (k = 0; k <= last; ++k) {
+        if (ATOMIC_LOAD(g->verts[k]) != NULL)
+            continue;
+        CRITICAL
+        {
+            if (g->verts[k] == NULL) {
+                vertex_t* seg = (vertex_t*)calloc(__segment_size(g, k), sizeof(vertex_t));
+                ATOMIC_STORE(g->verts[k], seg);
+            }
+        }
+    }
+}
+
+static void __graph_edges_grow(graph_t g, graph_id_t id) {
+    graph_id_t offset, k, last = __segment(g, id, &offset);
+    for (k = 0; k <= last; ++k) {
+        if (ATOMIC_LOAD(g->edges[k]) != NULL)
+            continue;
+        CRITICAL_EDGE
+        {
+            if (g->edges[k] == NULL) {
+                edge_t* seg = (edge_t*)calloc(__segment_size(g, k), sizeof(edge_t));
+                ATOMIC_STORE(g->edges[k], seg);
+            }
+        }
+    }
+}
+
+static graph_id_t __segment(graph_t g, graph_id_t id, graph_id_t* offset) {
+    /*  segment k holds the 2^(shift + k) ids starting at (2^k - 1) * 2^shift,
+        so k is the position of the highest bit of (id >> shift) + 1 */
+    unsigned long long x = ((unsigned long long)id >> g->_segment_shift) + 1;
+    graph_id_t k;
+#if defined (__GNUC__)
+    k = 63 - (graph_id_t)__builtin_clzll(x);
+#else
+    k = 0;
+    while (x >>= 1)
+        ++k;
+#endif
+    *offset = (graph_id_t)(id - (((1ULL << k) - 1) << g->_segment_shift));
+    return k;
+}
+
+static size_t __segment_size(graph_t g, graph_id_t k) {
+    return (size_t)1 << (g->_segment_shift + k);
+}
+
+static vertex_t* __vertex_slot(graph_t g, graph_id_t id) {
+    graph_id_t offset, k = __segment(g, id, &offset);
+    vertex_t* seg = ATOMIC_LOAD(g->verts[k]);
+    return (seg == NULL) ? NULL : &seg[offset];
+}
+
+static edge_t* __edge_slot(graph_t g, graph_id_t id) {
+    graph_id_t offset, k = __segment(g, id, &offset);
+    edge_t* seg = ATOMIC_LOAD(g->edges[k]);
+    return (seg == NULL) ? NULL : &seg[offset];
+}
+
+static vertex_t __vertex_at(graph_t g, graph_id_t id) {
+    vertex_t* slot = __vertex_slot(g, id);
+    return (slot == NULL) ? NULL : *slot;
+}
+
+static edge_t __edge_at(graph_t g, graph_id_t id) {
+    edge_t* slot = __edge_slot(g, id);
+    return (slot == NULL) ? NULL : *slot;
+}
+
+static void __vertex_edges_grow(vertex_t v_src, unsigned int outs) {
+    if (outs < v_src->_max_edges)
+        return;
+
+    unsigned int new_num_edges = __doubled(v_src->_max_edges);
+    edge_t* tmp = (edge_t*)realloc(v_src->edges, (size_t)new_num_edges * sizeof(edge_t));
+    unsigned int i;
+    for (i = outs; i < new_num_edges; ++i)
         tmp[i] = NULL;
     v_src->_max_edges = new_num_edges;
     v_src->edges = tmp;
     tmp = NULL;
 }
+
+static void __vertex_edges_in_reserve(vertex_t v, unsigned int size) {
+    if (size <= v->_max_edges_in)
+        return;
+
+    edge_t* tmp = (edge_t*)realloc(v->edges_in, (size_t)size * sizeof(edge_t));
+    unsigned int i;
+    for (i = v->num_edges_in; i < size; ++i)
+        tmp[i] = NULL;
+    v->_max_edges_in = size;
+    v->edges_in = tmp;
+}
+
+static void __vertex_edges_reserve(vertex_t v, unsigned int size) {
+    if (size <= v->_max_edges)
+        return;
+
+    edge_t* tmp = (edge_t*)realloc(v->edges, (size_t)size * sizeof(edge_t));
+    unsigned int i;
+    for (i = v->num_edges_out; i < size; ++i)
+        tmp[i] = NULL;
+    v->_max_edges = size;
+    v->edges = tmp;
+}
+
+/* twice the size of a list of edges, without wrapping past the largest degree */
+static unsigned int __doubled(unsigned int size) {
+    return (size > (unsigned int)-1 / 2) ? (unsigned int)-1 : size * 2;
+}
+
+static size_t __index_hash(graph_id_t src, graph_id_t dest) {
+    /* splitmix64 finalizer */
+    unsigned long long x = (((unsigned long long)src << 32) | ((unsigned long long)src >> 32)) ^ dest;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return (size_t)(x ^ (x >> 31));
+}
+
+static bool __index_build(graph_t g, size_t size) {
+    /* keep the table at most half full */
+    while (size < 2 * ((size_t)g->num_edges + 1))
+        size *= 2;
+    edge_t* index = (edge_t*)calloc(size, sizeof(edge_t));
+    if (index == NULL)
+        return false;
+
+    free(g->_index);
+    g->_index = index;
+    g->_index_size = size;
+    g->_index_count = 0;
+
+    graph_id_t i;
+    for (i = 0; i < g->_prev_edge_id; ++i) {
+        edge_t e = __edge_at(g, i);
+        if (e != NULL)
+            __index_insert(g, e);
+    }
+    return true;
+}
+
+static void __index_insert(graph_t g, edge_t e) {
+    if (2 * (g->_index_count + 1) > g->_index_size) {
+        /*  rebuilding re-inserts every edge in the graph, including e if it
+            is already in the edge table */
+        __index_build(g, g->_index_size * 2);
+        if (__index_find(g, e->src, e->dest) != NULL)
+            return;
+    }
+
+    size_t mask = g->_index_size - 1;
+    size_t i = __index_hash(e->src, e->dest) & mask;
+    while (g->_index[i] != NULL) {
+        /* only the first of several edges between the same vertices is kept */
+        if (g->_index[i]->src == e->src && g->_index[i]->dest == e->dest)
+            return;
+        i = (i + 1) & mask;
+    }
+    g->_index[i] = e;
+    ++g->_index_count;
+}
+
+static void __index_remove(graph_t g, edge_t e) {
+    size_t mask = g->_index_size - 1;
+    size_t i = __index_hash(e->src, e->dest) & mask;
+    while (g->_index[i] != NULL && g->_index[i] != e)
+        i = (i + 1) & mask;
+    if (g->_index[i] == NULL)
+        return;  /* another edge between the same vertices was indexed */
+
+    /*  backward shift deletion: move up any entry that would no longer be
+        reachable from its home slot once this one is emptied */
+    size_t j = i;
+    g->_index[i] = NULL;
+    --g->_index_count;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (g->_index[j] == NULL)
+            break;
+        size_t home = __index_hash(g->_index[j]->src, g->_index[j]->dest) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            g->_index[i] = g->_index[j];
+            g->_index[j] = NULL;
+            i = j;
+        }
+    }
+
+    /* index any other edge between the same two vertices in its place */
+    vertex_t v = __vertex_at(g, e->src);
+    SPIN_LOCK(v->_lock);
+    for (j = 0; j < v->num_edges_out; ++j) {
+        if (v->edges[j]->dest == e->dest) {
+            __index_insert(g, v->edges[j]);
+            break;
+        }
+    }
+    SPIN_UNLOCK(v->_lock);
+}
+
+static edge_t __index_find(graph_t g, graph_id_t src, graph_id_t dest) {
+    size_t mask = g->_index_size - 1;
+    size_t i = __index_hash(src, dest) & mask;
+    while (g->_index[i] != NULL) {
+        if (g->_index[i]->src == src && g->_index[i]->dest == dest)
+            return g->_index[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+static graph_id_t __sorted_lower_bound(vertex_t v, graph_id_t dest) {
+    graph_id_t lo = 0, hi = v->num_edges_out;
+    while (lo < hi) {
+        graph_id_t mid = lo + (hi - lo) / 2;
+        if (v->edges[mid]->dest < dest)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void __sort_edges(vertex_t v) {
+    qsort(v->edges, v->num_edges_out, sizeof(edge_t), __compare_edges);
+}
+
+static int __compare_edges(const void* a, const void* b) {
+    edge_t x = *(const edge_t*)a;
+    edge_t y = *(const edge_t*)b;
+    if (x->dest != y->dest)
+        return (x->dest < y->dest) ? -1 : 1;
+    return (x->id < y->id) ? -1 : (x->id > y->id);
+}
@@ -20,7 +20,7 @@
 ***
 ***     g_edge_add(g, 0, 1, "test");
 ***
-***     unsigned int i;
+***     graph_id_t i;
 ***     vertex_t v;
 ***     g_iterate_vertices(g, v, i) {
 ***         printf("vertex id: %d\tmetadata: %s\n", g_vertex_id(v), (char*)g_vertex_metadata(v));
@@ -28,13 +28,106 @@
 ***     g_free(g);
 *******************************************************************************/
 
+#include <stdbool.h>
+#include <stddef.h>     /* size_t */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*  Vertex and edge ids, and counts of them, are 32 bits by default; compile
+    with -DGRAPH_64BIT_IDS to go past 4 billion vertices or edges at the cost
+    of larger edges and id arrays. The number of edges out of or into a single
+    vertex is an unsigned int either way. GRAPH_ID_FORMAT is the printf
+    conversion for a graph_id_t */
+#if defined (GRAPH_64BIT_IDS)
+    typedef unsigned long long graph_id_t;
+    #define GRAPH_ID_FORMAT "%llu"
+#else
+    typedef unsigned int graph_id_t;
+    #define GRAPH_ID_FORMAT "%u"
+#endif
+
 typedef struct __graph* graph_t;
 typedef struct __vertex_node* vertex_t;
 typedef struct __edge_node* edge_t;
+typedef struct __graph_csr* graph_csr_t;
+typedef struct __graph_workspace* graph_workspace_t;
+typedef struct __graph_compressed* graph_compressed_t;
+typedef struct __graph_bitmatrix* graph_bitmatrix_t;
+typedef struct __graph_log* graph_log_t;
+
+/*  Used to mark a vertex or edge id that is not set, such as the predecessor
+    of an unreachable vertex */
+#define GRAPH_INVALID_ID ((graph_id_t)-1)
+
+/*  Ways to index the edges to speed up g_edge_find(); see g_edge_index() */
+#define GRAPH_EDGE_INDEX_NONE   0   /* scan the edges out of the source */
+#define GRAPH_EDGE_INDEX_HASH   1   /* hash table keyed on (src, dest) */
+#define GRAPH_EDGE_INDEX_SORTED 2   /* edges out of each vertex sorted by dest */
+
+/*  Types of the values in a property column; see g_vertex_prop() */
+#define GRAPH_PROP_DOUBLE   0   /* double */
+#define GRAPH_PROP_INT      1   /* long long */
+#define GRAPH_PROP_UINT     2   /* unsigned int, such as a label */
+#define GRAPH_PROP_ID       3   /* graph_id_t, such as a vertex or edge id */
+
+/*  Most vertex ids a bit matrix can hold; at this size it takes 512 MB */
+#define GRAPH_BITMATRIX_MAX_VERTICES 65536
+
+/* most readers that can be reading a graph using snapshots at once */
+#define GRAPH_MAX_READERS 64
+
+/*  Options for reading an edge list; see g_load_edge_list() */
+typedef struct __graph_edge_list_options {
+    bool undirected;    /* add an edge in each direction for each line */
+    bool one_based;     /* vertex ids in the file start at 1 instead of 0 */
+} graph_edge_list_options;
+
+/*  Position within a compressed list of neighbors; see g_compressed_iter_out() */
+typedef struct __graph_compressed_iter {
+    const unsigned char* _next;
+    unsigned int _remaining;
+    graph_id_t _prev;
+} graph_compressed_iter_t;
+
+/*  Number of buckets in the degree histograms of graph_stats_t; bucket 0 is a
+    degree of 0 and bucket k > 0 holds the degrees 2^(k - 1) to 2^k - 1 */
+#define GRAPH_STATS_BUCKETS 33
+
+/*  Memory used by each part of a graph and the shape of its degrees; see
+    g_stats(). The bytes add up to bytes_total, which is g_memory_usage() */
+typedef struct __graph_stats {
+    size_t bytes_total;
+    size_t bytes_graph;         /* the graph itself and its list of retired memory */
+    size_t bytes_tables;        /* the segments of the vertex and edge id tables */
+    size_t bytes_vertices;      /* the vertices */
+    size_t bytes_edges;         /* the edges */
+    size_t bytes_edge_lists;    /* the lists of edges out of and into each vertex */
+    size_t bytes_snapshots;     /* the edge lists published for readers */
+    size_t bytes_index;         /* the edge index */
+    size_t bytes_props;         /* the property columns */
+    size_t bytes_wasted;        /* of the above, allocated but not holding anything */
+    graph_id_t vertex_holes;  /* ids below g_vertices_inserted() without a vertex */
+    graph_id_t edge_holes;    /* edge ids ever assigned without an edge */
+    unsigned int max_degree_out;
+    unsigned int max_degree_in;
+    graph_id_t degree_out[GRAPH_STATS_BUCKETS];   /* vertices by edges out */
+    graph_id_t degree_in[GRAPH_STATS_BUCKETS];    /* vertices by edges in */
+} graph_stats_t;
+
+/*  Function called for each vertex reached by a traversal; return false to
+    stop the traversal early */
+typedef bool (*g_visit_t)(vertex_t v, void* data);
+
+/*  Function to retrieve the weight of an edge for the weighted algorithms */
+typedef double (*g_edge_weight_t)(edge_t e);
+
+/*  Functions to convert metadata to and from bytes when saving and loading;
+    serialize returns a pointer to the bytes (not free'd) and sets len while
+    deserialize returns the new metadata built from the len bytes */
+typedef const void* (*g_metadata_serialize_t)(void* metadata, size_t* len);
+typedef void* (*g_metadata_deserialize_t)(const void* data, size_t len);
 
 /*  Initialize the graph either using the default start size or based on the
     passed in size parameter */
@@ -48,14 +141,32 @@ void g_free(graph_t g);
 void g_free_alt(graph_t g, bool free_metadata);
 
 /*  Return the number of vertices currently in the graph */
-unsigned int g_num_vertices(graph_t g);
+graph_id_t g_num_vertices(graph_t g);
 
 /*  Return the total number of vertices ever inserted into the graph
     NOTE: likely only needed if writing ones own iteration loop */
-unsigned int g_vertices_inserted(graph_t g);
+graph_id_t g_vertices_inserted(graph_t g);
 
 /*  Return the number of edges in the graph */
-unsigned int g_num_edges(graph_t g);
+graph_id_t g_num_edges(graph_t g);
+
+/*  Return the number of bytes allocated for the graph, its vertices, edges,
+    index and property columns; the metadata is not included */
+size_t g_memory_usage(graph_t g);
+
+/*  Fill stats with the bytes allocated for each part of the graph, the part of
+    them that is unused capacity (edge lists and id tables that grew by
+    doubling, ids that were removed), the number of removed ids and the
+    distribution of the degrees
+    NOTE: not safe to call while other threads are modifying the graph */
+void g_stats(graph_t g, graph_stats_t* stats);
+
+/*  Free the unused capacity of the graph, such as after loading or removing
+    many edges: each edge list is cut down to its edges, the id table segments
+    past the last id and the unused end of the property columns are freed.
+    Returns the number of bytes freed
+    NOTE: not safe to call while other threads are using the graph */
+size_t g_shrink_to_fit(graph_t g);
 
 
 /*  Insert a new vertex into the graph with the provided metadata; the
@@ -69,28 +180,65 @@ vertex_t g_vertex_add(graph_t g, void* metadata);
     NOTE: if id already has a vertex with that id, then NULL will be returned
     NOTE: it is NOT recommended to mix using g_vertex_add and g_vertex_add_alt
     NOTE: if possible, initialize the graph to hold the largest known id */
-vertex_t g_vertex_add_alt(graph_t g, unsigned int id, void* metadata);
+vertex_t g_vertex_add_alt(graph_t g, graph_id_t id, void* metadata);
 
 /*  Remove the vertex from the graph, returning it
     NOTE: It is up to the caller to free the memory using g_vertex_free()
     NOTE: Default is to free all memory of those edges attached; use the
           alt version if the memory is not alloc'd */
-vertex_t g_vertex_remove(graph_t g, unsigned int id);
-vertex_t g_vertex_remove_alt(graph_t g, unsigned int id, bool free_edge_metadata);
+vertex_t g_vertex_remove(graph_t g, graph_id_t id);
+vertex_t g_vertex_remove_alt(graph_t g, graph_id_t id, bool free_edge_metadata);
 
 /*  Retrieve a vertex based on it's assigned identifier */
-vertex_t g_vertex_get(graph_t g, unsigned int id);
+vertex_t g_vertex_get(graph_t g, graph_id_t id);
 
 /*  Add an edge between the source (src) vertex to the destination vertex
     (dest) with the provided metadata. The edge is assigned an id for quick
-    retrieval */
-edge_t g_edge_add(graph_t g, unsigned int src, unsigned int dest, void* metadata);
+    retrieval
+    NOTE: Edges can be added and removed from several threads at once; the
+          source and destination vertices are locked, one at a time, while
+          their edges out and in are updated */
+edge_t g_edge_add(graph_t g, graph_id_t src, graph_id_t dest, void* metadata);
+
+/*  Add n edges in bulk; edge i goes from src[i] to dest[i] with metadata[i]
+    (pass NULL for metadata to not set any). The edge arrays of each source
+    vertex are sized exactly once and filled in parallel when using OpenMP.
+    Returns the number of edges added; edges with a source or destination that
+    is not in the graph are skipped. The added edges are assigned consecutive
+    ids in the order they were passed in
+    NOTE: not safe to call while other threads are modifying the graph */
+size_t g_edges_add_batch(graph_t g, const graph_id_t* src, const graph_id_t* dest, void** metadata, size_t n);
 
 /*  Remove an edge from the graph based on it's assigned identifier */
-edge_t g_edge_remove(graph_t g, unsigned int id);
+edge_t g_edge_remove(graph_t g, graph_id_t id);
 
 /*  Retrieve an edge based on it's assigned identifier */
-edge_t g_edge_get(graph_t g, unsigned int id);
+edge_t g_edge_get(graph_t g, graph_id_t id);
+
+/*  Find an edge from src to dest, or NULL if there is none; if there are
+    several, any one of them may be returned. Without an index this scans the
+    edges out of src; see g_edge_index()
+    NOTE: Safe to call while other threads add and remove edges: the edges out
+          of src are locked while they are searched and, with
+          GRAPH_EDGE_INDEX_HASH, every lookup takes a turn on the single lock of
+          the index. The edge found may still be removed by another thread
+          right after; see g_edge_retire() */
+edge_t g_edge_find(graph_t g, graph_id_t src, graph_id_t dest);
+
+/*  Set how edges are indexed for g_edge_find(); the index is kept up to date
+    as edges are added and removed. Returns false if the mode is unknown or
+    the index could not be built.
+        GRAPH_EDGE_INDEX_NONE:   no extra memory; O(out degree) lookups
+        GRAPH_EDGE_INDEX_HASH:   an open addressing hash table; O(1) lookups
+        GRAPH_EDGE_INDEX_SORTED: no extra memory; O(log out degree) lookups
+                                 but adding and removing an edge shifts the
+                                 edges of the source vertex
+    NOTE: GRAPH_EDGE_INDEX_SORTED changes the order of g_vertex_edge()
+    NOTE: With GRAPH_EDGE_INDEX_HASH, edges added, removed or found from
+          several threads at once take turns on the index, so lookups do not
+          run in parallel with each other
+    NOTE: not safe to call while other threads are using the graph */
+bool g_edge_index(graph_t g, unsigned int mode);
 
 
 /*******************************************************************************
@@ -98,7 +246,7 @@ edge_t g_edge_get(graph_t g, unsigned int id);
 *******************************************************************************/
 
 /*  Get the id of the provided vertex */
-unsigned int g_vertex_id(vertex_t v);
+graph_id_t g_vertex_id(vertex_t v);
 
 /*  Get the number of edges into the provided vertex */
 unsigned int g_vertex_num_edges_in(vertex_t v);
@@ -122,18 +270,22 @@ void g_vertex_free_alt(vertex_t v, bool free_metadata);
     to iterate over the edges that have the vertex as its source */
 edge_t g_vertex_edge(vertex_t v, unsigned int idx);
 
+/*  Get edge idx of the edges into the provided vertex; this is useful when one
+    needs to iterate over the edges that have the vertex as its destination */
+edge_t g_vertex_edge_in(vertex_t v, unsigned int idx);
+
 /*******************************************************************************
 *   Edge Properties / Functions
 *******************************************************************************/
 
 /*  Get the assigned id for the provided edge */
-unsigned int g_edge_id(edge_t e);
+graph_id_t g_edge_id(edge_t e);
 
 /* Get the source vertex id for the provided edge */
-unsigned int g_edge_src(edge_t e);
+graph_id_t g_edge_src(edge_t e);
 
 /* Get the destination vertex id for the provided edge */
-unsigned int g_edge_dest(edge_t e);
+graph_id_t g_edge_dest(edge_t e);
 
 /* Get the metadata for the provided edge */
 void* g_edge_metadata(edge_t e);
@@ -147,6 +299,77 @@ void g_edge_metadata_update(edge_t e, void* metadata);
 void g_edge_free(edge_t e);
 void g_edge_free_alt(edge_t e, bool free_metadata);
 
+/*******************************************************************************
+*   Property Columns
+*******************************************************************************/
+/*  Get the named property column of the vertices (or edges), adding it if it
+    does not exist. A column is a dense array of values of the type, one per
+    vertex (or edge) id, so reading a property is a single array access and
+    costs only the size of the value; new values are 0. The array covers every
+    id inserted so far and can be passed to the functions that take an array
+    of weights indexed by edge id, such as g_dijkstra_alt(). Returns NULL if
+    the column exists with another type or can not be allocated
+    NOTE: The array may move when it grows to cover newly added ids, so get it
+          again after adding vertices (or edges)
+    NOTE: The values of removed ids are left as they are
+    NOTE: Not safe to call while other threads add to the graph or use the
+          column */
+void* g_vertex_prop(graph_t g, const char* name, unsigned int type);
+void* g_edge_prop(graph_t g, const char* name, unsigned int type);
+
+/*  Typed versions of g_vertex_prop() and g_edge_prop() */
+double* g_vertex_prop_double(graph_t g, const char* name);
+double* g_edge_prop_double(graph_t g, const char* name);
+long long* g_vertex_prop_int(graph_t g, const char* name);
+long long* g_edge_prop_int(graph_t g, const char* name);
+unsigned int* g_vertex_prop_uint(graph_t g, const char* name);
+unsigned int* g_edge_prop_uint(graph_t g, const char* name);
+graph_id_t* g_vertex_prop_id(graph_t g, const char* name);
+graph_id_t* g_edge_prop_id(graph_t g, const char* name);
+
+/*  Remove and free the named property column of the vertices (or edges);
+    returns false if there is no such column */
+bool g_vertex_prop_remove(graph_t g, const char* name);
+bool g_edge_prop_remove(graph_t g, const char* name);
+
+/*******************************************************************************
+*   Snapshot Reads
+*******************************************************************************/
+/*  Turn on (or off) snapshots so that threads can read the graph while other
+    threads update it without either taking a lock. Each change to the edges
+    of a vertex publishes a new, never modified, copy of its edges out or in;
+    the copy being replaced (and any edge or vertex removed) is only freed once
+    every reader that may have seen it has finished. Returns false if the
+    snapshots could not be built
+    NOTE: Not safe to call while there are readers
+    NOTE: Removed edges and vertices must be freed using g_edge_retire() and
+          g_vertex_retire() while there may be readers
+    NOTE: Readers and writers only run safely at once when using OpenMP */
+bool g_snapshots_enable(graph_t g, bool enable);
+
+/*  Start and finish reading the graph; everything seen in between stays valid
+    until g_read_end(). Returns the reader to pass to g_read_end(), or
+    GRAPH_INVALID_ID if GRAPH_MAX_READERS are already reading
+    NOTE: Neither blocks, waits, or takes a lock */
+graph_id_t g_read_begin(graph_t g);
+void g_read_end(graph_t g, graph_id_t reader);
+
+/*  Return the edges out of (or into) the vertex as last published; len is set
+    to the number of edges. This is the only safe way to get the edges of a
+    vertex while it is being updated. NULL is returned if there are no edges
+    NOTE: The memory is owned by the graph; do not free */
+const edge_t* g_vertex_edges_snapshot(vertex_t v, unsigned int* len);
+const edge_t* g_vertex_edges_in_snapshot(vertex_t v, unsigned int* len);
+
+/*  Free a removed edge or vertex once no reader can be using it; when not
+    using snapshots it is freed right away */
+void g_edge_retire(graph_t g, edge_t e, bool free_metadata);
+void g_vertex_retire(graph_t g, vertex_t v, bool free_metadata);
+
+/*  Free everything retired that no reader can still see; this is also done
+    as things are retired. Returns the number of items freed */
+size_t g_reclaim(graph_t g);
+
 
 /*******************************************************************************
 *   Iterators - Iterate over the vertices and edges of a vertex easily
@@ -155,7 +378,7 @@ void g_edge_free_alt(edge_t e, bool free_metadata);
     NOTE:
         g   -   The graph
         v   -   A vertex_t pointer that will hold the next vertex
-        i   -   An unsigned int that will be modified for the loop */
+        i   -   A graph_id_t that will be modified for the loop */
 #define g_iterate_vertices(g, v, i)    for (i = 0; i < g_vertices_inserted(g); i++) if ((v = g_vertex_get(g, i)) != NULL)
 
 /*  Macro to easily iterate over the edges from a vertex
@@ -165,21 +388,589 @@ void g_edge_free_alt(edge_t e, bool free_metadata);
         i   -   An unsigned int that will be modified during the loop */
 #define g_iterate_edges(v, e, i)       for (i = 0; i < g_vertex_num_edges_out(v); i++) if ((e = g_vertex_edge(v, i)) != NULL)
 
+/*  Macro to easily iterate over the edges into a vertex
+    NOTE:
+        v   -   The vertex
+        e   -   An edge_t pointer that will hold the edges in the loop
+        i   -   An unsigned int that will be modified during the loop */
+#define g_iterate_edges_in(v, e, i)    for (i = 0; i < g_vertex_num_edges_in(v); i++) if ((e = g_vertex_edge_in(v, i)) != NULL)
+
+/*  Macro to iterate over the published edges out of a vertex while reading
+    with snapshots; see g_read_begin()
+    NOTE:
+        v   -   The vertex
+        es  -   A const edge_t pointer that will hold the published edges
+        n   -   An unsigned int that will hold the number of edges
+        e   -   An edge_t pointer that will hold the edges in the loop
+        i   -   An unsigned int that will be modified during the loop */
+#define g_iterate_edges_snapshot(v, es, n, e, i)   for (es = g_vertex_edges_snapshot(v, &(n)), i = 0; i < n; i++) if ((e = es[i]) != NULL)
+
 /*  Return an array with a listing of the vertices in breadth first fashion;
     this is useful for finding what order one should traverse the list starting
     at vertex v in a bredth first fashion.
     NOTE: Up to the caller to free the corresponding memory.
-    NOTE: size is set to the number of elements in the unsigned int array
+    NOTE: size is set to the number of elements in the array
     NOTE: The returned array contains the vertex ids of each vertex, in order */
-unsigned int* g_breadth_first_traverse(graph_t g, vertex_t v, unsigned int* size);
+graph_id_t* g_breadth_first_traverse(graph_t g, vertex_t v, graph_id_t* size);
 
 /*  Return an array with a listing of the vertices in depth first fashion;
     this is useful for finding what order one should traverse the graph
     starting at vertex v in a depth first fashion.
     NOTE: Up to the caller to free the corresponding memory
-    NOTE: size is set to the number of elements in the unsigned int array
+    NOTE: size is set to the number of elements in the array
     NOTE: The returned array contains the vertex ids of each vertex, in order */
-unsigned int* g_depth_first_traverse(graph_t g, vertex_t v, unsigned int* size);
+graph_id_t* g_depth_first_traverse(graph_t g, vertex_t v, graph_id_t* size);
+
+/*  A reusable workspace for traversals so that running many of them does not
+    allocate any memory. Visited vertices are marked with the number of the
+    traversal, so starting a new one is O(1) no matter how much of the graph
+    the last one touched. If the graph grows, the workspace grows with it.
+    NOTE: Up to the caller to free the workspace using g_workspace_free()
+    NOTE: Use a workspace per thread
+    NOTE: g may be NULL, such as when only used with a compressed graph */
+graph_workspace_t g_workspace_init(graph_t g);
+void g_workspace_free(graph_workspace_t w);
+
+/*  Return if the vertex id was reached by the last traversal using the
+    workspace */
+bool g_workspace_visited(graph_workspace_t w, graph_id_t id);
+
+/*  Breadth or depth first traversal starting at vertex v using the workspace;
+    visit is called with each vertex reached, in order, starting with v. The
+    traversal stops if visit returns false. Returns the number of vertices
+    visited. visit may be NULL to only mark the vertices reached */
+graph_id_t g_breadth_first_visit(graph_t g, vertex_t v, graph_workspace_t w, g_visit_t visit, void* data);
+graph_id_t g_depth_first_visit(graph_t g, vertex_t v, graph_workspace_t w, g_visit_t visit, void* data);
+
+/*  Same as g_breadth_first_traverse() and g_depth_first_traverse() but using
+    the workspace and writing the vertex ids into res, which holds len ids;
+    the traversal stops once res is full. Returns the number of ids written */
+graph_id_t g_breadth_first_traverse_alt(graph_t g, vertex_t v, graph_workspace_t w, graph_id_t* res, graph_id_t len);
+graph_id_t g_depth_first_traverse_alt(graph_t g, vertex_t v, graph_workspace_t w, graph_id_t* res, graph_id_t len);
+
+/*  Find a path with the fewest edges from src to dst using a bidirectional
+    breadth first search that follows the edges out of the vertices reached
+    from src and the edges into the vertices reached from dst, expanding the
+    smaller frontier until the two meet. Returns the ids of the vertices on
+    the path, starting with src and ending with dst, and sets len to the
+    number of ids; NULL with len set to 0 if there is no path
+    NOTE: It is up to the caller to free the returned array */
+graph_id_t* g_shortest_path(graph_t g, graph_id_t src, graph_id_t dst, graph_id_t* len);
+
+/*  Same as g_shortest_path() but uses the provided workspace instead of
+    allocating one for each query */
+graph_id_t* g_shortest_path_alt(graph_t g, graph_id_t src, graph_id_t dst, graph_workspace_t w, graph_id_t* len);
+
+/*  Find the hop distances from each of the source vertex ids at once using a
+    bit-parallel multi-source breadth first search; up to 64 searches share
+    each scan over the edges and the vertices are expanded in parallel when
+    using OpenMP. Returns an array of num_sources rows of
+    g_vertices_inserted() distances; row i is the distances from sources[i]
+    and vertices that are not reached (or sources that are not a vertex) are
+    GRAPH_INVALID_ID.
+    NOTE: Up to the caller to free the returned array */
+graph_id_t* g_multi_source_bfs(graph_t g, const graph_id_t* sources, graph_id_t num_sources);
+
+/*  Same as g_multi_source_bfs() but only keeps, for each source, the sum of the
+    distances to (sums) and number of (reached) the vertices it reaches,
+    itself included; either may be NULL. Uses memory for the vertices only,
+    not for each source. Returns false if the memory could not be allocated */
+bool g_multi_source_bfs_sums(graph_t g, const graph_id_t* sources, graph_id_t num_sources, unsigned long long* sums, graph_id_t* reached);
+
+/*******************************************************************************
+*   Weighted Shortest Paths
+*******************************************************************************/
+/*  Compute the shortest path from vertex v to all other vertices using
+    Dijkstra's algorithm. The weight of each edge is found using the weight
+    function; if it is NULL, each edge has a weight of 1. The _alt version
+    reads the weights from an array indexed by edge id.
+    NOTE: Up to the caller to free the returned array
+    NOTE: Returns an array of distances indexed by vertex id; vertices that
+          are not reachable (or not present) have a distance of INFINITY
+    NOTE: If previous is not NULL, it is set to an array, indexed by vertex
+          id, of the previous vertex on the shortest path; GRAPH_INVALID_ID
+          marks the start and unreachable vertices. Up to the caller to free
+    NOTE: Weights must be non-negative; NULL is returned otherwise */
+double* g_dijkstra(graph_t g, vertex_t v, g_edge_weight_t weight, graph_id_t** previous);
+double* g_dijkstra_alt(graph_t g, vertex_t v, const double* weights, graph_id_t** previous);
+
+/*  Compute the shortest path from vertex v to all other vertices using
+    delta-stepping; the relaxation of each bucket is done in parallel when
+    using OpenMP. Edges with a weight no greater than delta are relaxed
+    repeatedly within a bucket; a delta <= 0 uses the mean edge weight.
+    NOTE: Returns the same as g_dijkstra()
+    NOTE: delta may be raised to keep the number of buckets bounded */
+double* g_delta_stepping(graph_t g, vertex_t v, g_edge_weight_t weight, double delta, graph_id_t** previous);
+double* g_delta_stepping_alt(graph_t g, vertex_t v, const double* weights, double delta, graph_id_t** previous);
+
+/*******************************************************************************
+*   Components
+*******************************************************************************/
+/*  Find the weakly connected components of the graph (edge direction is
+    ignored) using a concurrent union-find over the edges; in parallel when
+    using OpenMP. Returns an array, indexed by vertex id, with the component
+    each vertex belongs to; components are numbered from 0 in the order of
+    their lowest vertex id and ids without a vertex are GRAPH_INVALID_ID.
+    NOTE: Up to the caller to free the returned array
+    NOTE: num_components is set to the number of components found
+    NOTE: If sizes is not NULL, it is set to an array with the number of
+          vertices in each component. Up to the caller to free */
+graph_id_t* g_connected_components(graph_t g, graph_id_t* num_components, graph_id_t** sizes);
+
+/*  Find the strongly connected components of the graph using an iterative
+    version of Tarjan's algorithm. Returns an array, indexed by vertex id, with
+    the component each vertex belongs to; components are numbered in a
+    topological order of the condensed graph and ids without a vertex are
+    GRAPH_INVALID_ID.
+    NOTE: Up to the caller to free the returned array
+    NOTE: num_components is set to the number of components found
+    NOTE: If condensation is not NULL, it is set to a new graph with a vertex
+          per component (vertex id is the component number) and one edge for
+          each pair of components connected by at least one edge. The
+          metadata is NULL; it is set to NULL if the graph could not be
+          built. Up to the caller to free using g_free() */
+graph_id_t* g_strongly_connected_components(graph_t g, graph_id_t* num_components, graph_t* condensation);
+
+/*  Return an array with the vertex ids in a topological order, found using
+    Kahn's algorithm; vertices without any dependencies are ordered by id.
+    NOTE: Up to the caller to free the corresponding memory
+    NOTE: size is set to the number of elements in the array
+    NOTE: If the graph has a cycle, NULL is returned and size is set to 0 */
+graph_id_t* g_topological_sort(graph_t g, graph_id_t* size);
+
+/*******************************************************************************
+*   Centrality
+*******************************************************************************/
+/*  Compute the betweenness centrality of each vertex, ignoring edge weights,
+    using Brandes' algorithm: a breadth first search from each source counting
+    the shortest paths, then the dependencies are accumulated in reverse. The
+    sources are spread over the threads when using OpenMP. If num_samples is 0
+    every vertex is a source; otherwise num_samples sources are picked at
+    random (using seed) and the scores are scaled up to estimate the exact
+    ones. Scores are not normalized.
+    NOTE: Up to the caller to free the returned array
+    NOTE: Returns an array indexed by vertex id; ids without a vertex are 0 */
+double* g_betweenness_centrality(graph_t g, graph_id_t num_samples, unsigned long long seed);
+
+/*  Compute the closeness centrality of each vertex from the hop distances to
+    the vertices it can reach: (r - 1) / s * (r - 1) / (n - 1), where r is the
+    number of vertices reached (including itself), s is the sum of their
+    distances, and n is the number of vertices, so that vertices that reach
+    little of the graph are not over rated. Runs 64 searches at a time using
+    g_multi_source_bfs_sums()
+    NOTE: Up to the caller to free the returned array
+    NOTE: Returns an array indexed by vertex id; ids without a vertex, or that
+          reach no other vertex, are 0 */
+double* g_closeness_centrality(graph_t g);
+
+/*******************************************************************************
+*   Spanning Trees
+*******************************************************************************/
+/*  Find a minimum spanning forest of the graph, treating each edge as
+    undirected, using Kruskal's algorithm: the edges are sorted by weight (in
+    parallel when using OpenMP) and added unless they join two vertices that
+    are already connected. The weight of each edge is found using the weight
+    function; if it is NULL, each edge has a weight of 1. The _alt version
+    reads the weights from an array indexed by edge id. Ties are broken by
+    edge id, so g_kruskal() and g_boruvka() pick the same edges.
+    NOTE: Up to the caller to free the returned array
+    NOTE: Returns the ids of the edges in the forest, by increasing weight;
+          num_edges is set to the number of ids
+    NOTE: If total is not NULL, it is set to the total weight of the forest */
+graph_id_t* g_kruskal(graph_t g, g_edge_weight_t weight, graph_id_t* num_edges, double* total);
+graph_id_t* g_kruskal_alt(graph_t g, const double* weights, graph_id_t* num_edges, double* total);
+
+/*  Find a minimum spanning forest using Boruvka's algorithm: each round, every
+    tree finds its lightest edge to another tree, in parallel when using OpenMP,
+    and the trees are joined along them until no edges between trees are left.
+    NOTE: Returns the same as g_kruskal() but the ids are in no particular order */
+graph_id_t* g_boruvka(graph_t g, g_edge_weight_t weight, graph_id_t* num_edges, double* total);
+graph_id_t* g_boruvka_alt(graph_t g, const double* weights, graph_id_t* num_edges, double* total);
+
+/*******************************************************************************
+*   Triangles and Cores
+*******************************************************************************/
+/*  Count the triangles that each vertex is part of, treating the edges as
+    undirected and ignoring self loops and repeated edges. Each edge is kept
+    only at its end of lower degree, so every triangle is found exactly once by
+    merging two short sorted lists; vertices are done in parallel when using
+    OpenMP. Returns an array indexed by vertex id; ids without a vertex are 0
+    NOTE: Up to the caller to free the returned array
+    NOTE: If total is not NULL, it is set to the number of triangles */
+unsigned long long* g_triangles(graph_t g, unsigned long long* total);
+
+/*  Find the core number of each vertex: the largest k for which it is in a
+    subgraph where every vertex has at least k neighbors. The edges are treated
+    as undirected, ignoring self loops and repeated edges. Vertices are peeled
+    off one at a time by increasing number of neighbors left, kept in buckets
+    by that number, so it takes O(n + m) time whatever the largest core; only
+    gathering the neighbors runs in parallel when using OpenMP. Returns an
+    array indexed by vertex id; ids without a vertex are 0
+    NOTE: Up to the caller to free the returned array
+    NOTE: If max_core is not NULL, it is set to the largest core number */
+unsigned int* g_core_numbers(graph_t g, unsigned int* max_core);
+
+/*******************************************************************************
+*   Subgraphs and Partitioning
+*******************************************************************************/
+/*  Return a new graph induced by the n vertex ids: vertex i of the new graph
+    is ids[i] and every edge between two of them is kept, numbered in the order
+    of its source in ids. The metadata and the property columns are carried
+    over. Returns NULL if an id has no vertex or is listed more than once
+    NOTE: The metadata pointers are shared with g; use g_free_alt(sub, false)
+          to free one of the graphs without freeing them */
+graph_t g_subgraph(graph_t g, const graph_id_t* ids, graph_id_t n);
+
+/*  Split the vertices into num_parts parts of about the same size with few
+    edges between them. The parts start as runs of a breadth first order (see
+    g_order_bfs()), then each round of label propagation moves every vertex to
+    the part holding most of its neighbors, either direction, as long as that
+    part stays within imbalance of the average size; it stops once a round
+    moves almost no vertices or after max_rounds. g_partition() allows an
+    imbalance of 0.03 and 20 rounds. Returns an array, indexed by vertex id,
+    with the part of each vertex; ids without a vertex are GRAPH_INVALID_ID
+    NOTE: Up to the caller to free the returned array
+    NOTE: If not NULL, cut is set to the number of edges between two parts
+          and balance to the size of the largest part over the average size
+    NOTE: Vertices are moved in parallel when using OpenMP, so the parts may
+          differ from run to run */
+graph_id_t* g_partition(graph_t g, graph_id_t num_parts, size_t* cut, double* balance);
+graph_id_t* g_partition_alt(graph_t g, graph_id_t num_parts, double imbalance, unsigned int max_rounds, size_t* cut, double* balance);
+
+/*******************************************************************************
+*   Compaction and Ordering
+*******************************************************************************/
+/*  Renumber the vertices so that the ids are 0 to g_num_vertices() - 1 with
+    no holes left by removed vertices; the relative order is kept. Edge ids do
+    not change but their source and destination are updated. Returns an array,
+    indexed by the old vertex id, with the new id of each vertex; ids without a
+    vertex are GRAPH_INVALID_ID. The _alt version takes the order to use as a
+    list of old vertex ids, such as from g_order_degree() or g_order_rcm(), and
+    returns NULL (leaving the graph unchanged) if it does not list every vertex
+    exactly once.
+    NOTE: Up to the caller to free the returned array
+    NOTE: Vertices and edges held by the caller stay valid; only ids change
+    NOTE: Vertex property columns are moved to the new ids
+    NOTE: The edge index, if any, is rebuilt in the same mode without
+          allocating, so it is never dropped
+    NOTE: not safe to call while other threads are using the graph */
+graph_id_t* g_compact(graph_t g);
+graph_id_t* g_compact_alt(graph_t g, const graph_id_t* order);
+
+/*  Orderings of the vertices that improve the cache locality of traversals
+    once applied using g_compact_alt(). Each returns an array of the
+    g_num_vertices() vertex ids in the new order.
+        g_order_degree: by decreasing degree (in plus out), ties by id
+        g_order_bfs:    breadth first, edge direction ignored, each
+                        component starting from its lowest id
+        g_order_rcm:    reverse Cuthill-McKee; breadth first from a lowest
+                        degree vertex, visiting neighbors by increasing degree,
+                        then reversed. Keeps the ids of neighbors close
+    NOTE: Up to the caller to free the returned array */
+graph_id_t* g_order_degree(graph_t g);
+graph_id_t* g_order_bfs(graph_t g);
+graph_id_t* g_order_rcm(graph_t g);
+
+/*******************************************************************************
+*   Frozen Adjacency (CSR)
+*******************************************************************************/
+/*  Build a read-only, contiguous (compressed sparse row) copy of the edges of
+    the graph, both out of and into each vertex. It is indexed by vertex id and
+    is not updated when the graph changes.
+    NOTE: Up to the caller to free the memory using g_csr_free() */
+graph_csr_t g_csr_init(graph_t g);
+void g_csr_free(graph_csr_t c);
+
+/*  Return the number of vertex ids (vertices inserted) in the frozen graph */
+graph_id_t g_csr_num_vertices(graph_csr_t c);
+
+/*  Return the number of edges in the frozen graph */
+graph_id_t g_csr_num_edges(graph_csr_t c);
+
+/*  Return if the vertex id was present when the graph was frozen */
+bool g_csr_vertex_exists(graph_csr_t c, graph_id_t id);
+
+/*  Return the vertex ids at the other end of the edges out of (or into) the
+    vertex id; len is set to the number of neighbors. The edge ids, in the same
+    order, are returned by the _alt versions.
+    NOTE: The memory is owned by the frozen graph; do not free */
+const graph_id_t* g_csr_neighbors_out(graph_csr_t c, graph_id_t id, unsigned int* len);
+const graph_id_t* g_csr_neighbors_in(graph_csr_t c, graph_id_t id, unsigned int* len);
+const graph_id_t* g_csr_edge_ids_out(graph_csr_t c, graph_id_t id, unsigned int* len);
+const graph_id_t* g_csr_edge_ids_in(graph_csr_t c, graph_id_t id, unsigned int* len);
+
+/*  Return the saved metadata bytes of a vertex (by vertex id) or of an edge
+    (by edge id) of a frozen graph loaded using g_csr_load(); len is set to the
+    number of bytes. NULL is returned if there is no metadata
+    NOTE: The memory is owned by the frozen graph; do not free */
+const void* g_csr_vertex_metadata(graph_csr_t c, graph_id_t id, size_t* len);
+const void* g_csr_edge_metadata(graph_csr_t c, graph_id_t id, size_t* len);
+
+/*  Pull based sparse matrix-vector multiply over the edges: for each vertex v,
+    y[v] is the sum of weights[e] * x[u] for every edge e from u into v. If
+    weights (indexed by edge id) is NULL, each edge has a weight of 1. Both x
+    and y are indexed by vertex id; run in parallel when using OpenMP */
+void g_csr_spmv(graph_csr_t c, const double* x, double* y, const double* weights);
+
+/*  Compute the PageRank of each vertex using the damping factor (usually
+    0.85); stops once the L1 change between iterations is below tolerance or
+    max_iterations is reached. Vertices without edges out spread their rank
+    evenly across all vertices. The g_pagerank() version builds and frees a
+    frozen copy of the graph.
+    NOTE: Up to the caller to free the returned array
+    NOTE: Returns an array indexed by vertex id; ids without a vertex are 0
+    NOTE: If iterations is not NULL, it is set to the iterations run */
+double* g_pagerank(graph_t g, double damping, double tolerance, unsigned int max_iterations, unsigned int* iterations);
+double* g_csr_pagerank(graph_csr_t c, double damping, double tolerance, unsigned int max_iterations, unsigned int* iterations);
+
+/*******************************************************************************
+*   Compressed Adjacency
+*******************************************************************************/
+/*  Build a read-only copy of the neighbors out of and into each vertex where
+    each list is sorted and stored as the differences between consecutive ids
+    as variable length (7 bits per byte) integers; most edges take one or two
+    bytes instead of the more than 40 used by the graph. The _alt version builds
+    it directly from arrays of num_edges edges from src[i] to dest[i] over the
+    vertex ids 0 to num_verts - 1, skipping edges outside of that range, so
+    that the graph never needs to be built.
+    NOTE: Edge ids and metadata are not kept
+    NOTE: Up to the caller to free the memory using g_compressed_free() */
+graph_compressed_t g_compressed_init(graph_t g);
+graph_compressed_t g_compressed_init_alt(graph_id_t num_verts, const graph_id_t* src, const graph_id_t* dest, size_t num_edges);
+void g_compressed_free(graph_compressed_t c);
+
+/*  Return the number of vertex ids in the compressed graph */
+graph_id_t g_compressed_num_vertices(graph_compressed_t c);
+
+/*  Return the number of edges in the compressed graph */
+graph_id_t g_compressed_num_edges(graph_compressed_t c);
+
+/*  Return the number of edges out of (or into) the vertex id */
+unsigned int g_compressed_degree_out(graph_compressed_t c, graph_id_t id);
+unsigned int g_compressed_degree_in(graph_compressed_t c, graph_id_t id);
+
+/*  Decode up to len of the neighbors out of (or into) the vertex id, in
+    increasing order, into res; returns the number decoded */
+unsigned int g_compressed_neighbors_out(graph_compressed_t c, graph_id_t id, graph_id_t* res, unsigned int len);
+unsigned int g_compressed_neighbors_in(graph_compressed_t c, graph_id_t id, graph_id_t* res, unsigned int len);
+
+/*  Start walking the neighbors out of (or into) the vertex id; each call to
+    g_compressed_iter_next() sets neighbor to the next one, in increasing order,
+    and returns false once there are no more */
+void g_compressed_iter_out(graph_compressed_t c, graph_id_t id, graph_compressed_iter_t* it);
+void g_compressed_iter_in(graph_compressed_t c, graph_id_t id, graph_compressed_iter_t* it);
+bool g_compressed_iter_next(graph_compressed_iter_t* it, graph_id_t* neighbor);
+
+/*  Breadth first traverse of the compressed graph from the vertex id, writing
+    up to len of the vertex ids visited to res in the order visited; returns
+    the number written */
+graph_id_t g_compressed_breadth_first_traverse(graph_compressed_t c, graph_id_t id, graph_workspace_t w, graph_id_t* res, graph_id_t len);
+
+/*  Return the number of bytes used by the compressed graph */
+size_t g_compressed_memory_usage(graph_compressed_t c);
+
+/*  Macros to easily iterate over the neighbors of a vertex of a compressed graph
+    NOTE:
+        c   -   The compressed graph
+        v   -   The vertex id
+        it  -   A graph_compressed_iter_t that will be modified during the loop
+        u   -   A graph_id_t that will hold the neighbors in the loop */
+#define g_compressed_iterate_out(c, v, it, u)   for (g_compressed_iter_out(c, v, &(it)); g_compressed_iter_next(&(it), &(u));)
+#define g_compressed_iterate_in(c, v, it, u)    for (g_compressed_iter_in(c, v, &(it)); g_compressed_iter_next(&(it), &(u));)
+
+/*******************************************************************************
+*   Dense Adjacency (Bit Matrix)
+*******************************************************************************/
+/*  Build an adjacency matrix of the graph where the neighbors out of each
+    vertex are a row of bits, one per vertex id. At one bit per pair of
+    vertices it is smaller than the graph once about 1 in 300 of the possible
+    edges are present, and set operations on neighbors work on 64 vertices at
+    a time. If undirected is true, each edge is also set in the opposite
+    direction. The _alt version builds an empty matrix over the vertex ids 0 to
+    num_verts - 1. Returns NULL if there are more than
+    GRAPH_BITMATRIX_MAX_VERTICES ids or the matrix can not be allocated
+    NOTE: Edge ids, metadata and repeated edges are not kept
+    NOTE: Up to the caller to free the memory using g_bitmatrix_free() */
+graph_bitmatrix_t g_bitmatrix_init(graph_t g, bool undirected);
+graph_bitmatrix_t g_bitmatrix_init_alt(graph_id_t num_verts, bool undirected);
+void g_bitmatrix_free(graph_bitmatrix_t m);
+
+/*  Build a new graph with the vertex ids of the matrix, without metadata, and
+    an edge for each bit set; an undirected matrix gives an edge each way */
+graph_t g_bitmatrix_to_graph(graph_bitmatrix_t m);
+
+/*  Return the number of vertex ids in the matrix */
+graph_id_t g_bitmatrix_num_vertices(graph_bitmatrix_t m);
+
+/*  Return the number of bits set; in an undirected matrix each edge between
+    two different vertices is counted once for each direction */
+size_t g_bitmatrix_num_edges(graph_bitmatrix_t m);
+
+/*  Set, clear or test the edge from src to dest (and from dest to src in an
+    undirected matrix); add and remove return false if either id is out of
+    range
+    NOTE: Adding and removing are not safe while other threads use the matrix */
+bool g_bitmatrix_edge_add(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest);
+bool g_bitmatrix_edge_remove(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest);
+bool g_bitmatrix_edge_exists(graph_bitmatrix_t m, graph_id_t src, graph_id_t dest);
+
+/*  Return the number of neighbors out of the vertex id */
+unsigned int g_bitmatrix_degree(graph_bitmatrix_t m, graph_id_t id);
+
+/*  Write up to len of the neighbors out of the vertex id, in increasing order,
+    into res; returns the number written */
+unsigned int g_bitmatrix_neighbors(graph_bitmatrix_t m, graph_id_t id, graph_id_t* res, unsigned int len);
+
+/*  Return the number of vertices that are neighbors out of both a and b */
+unsigned int g_bitmatrix_common_neighbors(graph_bitmatrix_t m, graph_id_t a, graph_id_t b);
+
+/*  Count the triangles of the matrix by intersecting the rows of the two ends
+    of each edge. Each triangle of an undirected matrix is counted once; for
+    a directed one, the triples u -> v, u -> w and v -> w with u < v < w are
+    counted, so build it undirected to count the triangles of the graph */
+unsigned long long g_bitmatrix_triangles(graph_bitmatrix_t m);
+
+/*  Breadth first search from the vertex id where each level is found as the
+    union of the rows of the frontier less the visited vertices. Returns the
+    number of hops to each vertex id, or GRAPH_INVALID_ID if it can not be
+    reached; NULL if id is out of range
+    NOTE: Up to the caller to free the returned array */
+graph_id_t* g_bitmatrix_bfs(graph_bitmatrix_t m, graph_id_t id);
+
+/*  Return the number of bytes used by the matrix */
+size_t g_bitmatrix_memory_usage(graph_bitmatrix_t m);
+
+/*******************************************************************************
+*   Saving and Loading
+*******************************************************************************/
+/*  Save the graph to a versioned binary file that holds the vertex table and
+    the edges out of and into each vertex (as in g_csr_init()), with vertex and
+    edge ids kept. The _alt version also saves the metadata of the vertices
+    and / or edges using the serialize functions (either may be NULL)
+    NOTE: The file uses the byte order and id size of the machine
+    NOTE: Returns true if the file was written successfully */
+bool g_save(graph_t g, const char* filename);
+bool g_save_alt(graph_t g, const char* filename, g_metadata_serialize_t vertex_metadata, g_metadata_serialize_t edge_metadata);
+
+/*  Load a file saved with g_save() as a frozen graph. The file is memory
+    mapped and used in place, without parsing, so it is ready to be queried
+    right away; returns NULL if the file is not a valid graph file
+    NOTE: Up to the caller to free the memory using g_csr_free() */
+graph_csr_t g_csr_load(const char* filename);
+
+/*  Load a file saved with g_save() into a new graph with the same vertex and
+    edge ids. The _alt version rebuilds the metadata of the vertices and / or
+    edges using the deserialize functions; otherwise the metadata is NULL.
+    Returns NULL if the file is not valid or not every vertex and edge in it
+    could be added
+    NOTE: Up to the caller to free the memory using g_free() */
+graph_t g_load(const char* filename);
+graph_t g_load_alt(const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata);
+
+/*  Load a text file with one edge per line as "src dest [weight]" into a new
+    graph; fields may be separated by spaces, tabs or commas and lines that
+    start with '#' or '%' are skipped, as are malformed lines and lines with an
+    id that does not fit in a graph_id_t. A vertex is added for every id up to
+    the largest one in the file. The file is split into chunks that are parsed in
+    parallel, when using OpenMP, and the edges are added in bulk in the order
+    of the file. opts may be NULL to use the defaults (directed, 0 based)
+    NOTE: Up to the caller to free the memory using g_free()
+    NOTE: If weights is not NULL, it is set to an array, indexed by edge id,
+          of the weight of each edge (1 if missing). Up to the caller to free */
+graph_t g_load_edge_list(const char* filename, const graph_edge_list_options* opts, double** weights);
+
+/*******************************************************************************
+*   Change Log
+*******************************************************************************/
+/*  Record every vertex and edge added to or removed from g, from now on, in an
+    append only log file so that only the changes are written as the graph is
+    updated; snapshot is the file the whole graph is saved to, using
+    g_save_alt(), when the log is compacted. Each record is an operation code
+    followed by the ids as varints and, for the _alt version, the metadata of
+    the added vertices and / or edges using the serialize functions (either
+    may be NULL). The records are buffered and written out as the buffer
+    fills, by g_log_flush() and when closing. A log file written the same way
+    that ends with a complete record is appended to; otherwise the log is
+    compacted right away. The _alt version also compacts from
+    g_log_checkpoint() once the log is larger than compact_bytes (0 to never
+    do so). Returns NULL if the log could not be started or g already has one
+    NOTE: g should be the graph loaded from the same files using g_log_load()
+    NOTE: Changes made from several threads at once take turns adding their
+          records; a change is recorded once it is done
+    NOTE: Updates to the metadata and the property columns are not recorded;
+          g_compact() renumbers the vertices so it also compacts the log
+    NOTE: Up to the caller to close the log, using g_log_close(), before
+          freeing g */
+graph_log_t g_log_open(graph_t g, const char* snapshot, const char* filename);
+graph_log_t g_log_open_alt(graph_t g, const char* snapshot, const char* filename, g_metadata_serialize_t vertex_metadata, g_metadata_serialize_t edge_metadata, size_t compact_bytes);
+
+/*  Write the buffered records to the log file; returns false if writing
+    failed
+    NOTE: The records are handed to the operating system, so they are kept if
+          the program stops but not necessarily if the machine does */
+bool g_log_flush(graph_log_t l);
+
+/*  Save the graph to the snapshot file and start a new, empty log. The
+    snapshot is written to a temporary file that then replaces the old one;
+    if stopped before the new log is started, replaying the old log onto the
+    new snapshot gives the same graph. Returns false if writing failed
+    NOTE: not safe to call while other threads are modifying the graph */
+bool g_log_compact(graph_log_t l);
+
+/*  Flush the log, or compact it once it is larger than the compact_bytes
+    passed to g_log_open_alt(); call it periodically, such as after each batch
+    of changes, so the cost of saving the graph follows the number of changes
+    NOTE: not safe to call while other threads are modifying the graph */
+bool g_log_checkpoint(graph_log_t l);
+
+/*  Return the size of the log in bytes, including the records not yet
+    written */
+size_t g_log_size(graph_log_t l);
+
+/*  Write the buffered records, stop recording the changes to the graph and
+    free the log; returns false if writing any record failed */
+bool g_log_close(graph_log_t l);
+
+/*  Apply the records of a log file to g, such as a graph loaded from the
+    snapshot the log was started from. Edges added one after another are added
+    in bulk. The _alt version rebuilds the metadata of the vertices and / or
+    edges using the deserialize functions; otherwise the metadata is NULL.
+    Records that no longer apply, such as adding an id that is in use or
+    removing one that is not, are skipped, as is a record cut short when the
+    program stopped while writing it. Returns false if the file is not a log
+    or a record could not be applied, such as when out of memory; the records
+    before it have been applied */
+bool g_log_replay(graph_t g, const char* filename);
+bool g_log_replay_alt(graph_t g, const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata);
+
+/*  Load the snapshot into a new graph, or start an empty one if there is no
+    snapshot file, and replay the log onto it if there is a log file. Returns
+    NULL if either file exists but could not be read
+    NOTE: Up to the caller to free the memory using g_free() */
+graph_t g_log_load(const char* snapshot, const char* filename);
+graph_t g_log_load_alt(const char* snapshot, const char* filename, g_metadata_deserialize_t vertex_metadata, g_metadata_deserialize_t edge_metadata);
+
+/*******************************************************************************
+*   Generators
+*******************************************************************************/
+/*  Generate synthetic graphs for testing and benchmarking; the same seed
+    always gives the same graph. The metadata is NULL.
+        g_generate_erdos_renyi: m edges between uniformly random pairs of the
+                                n vertices (no self loops; may repeat)
+        g_generate_rmat:        2^scale vertices and edge_factor * 2^scale
+                                edges using the recursive matrix (Kronecker)
+                                model with the Graph500 parameters; heavily
+                                skewed degrees
+        g_generate_grid:        rows * cols vertices, numbered row by row,
+                                with an edge each way between neighbors
+        g_generate_power_law:   n vertices added one at a time, each linking
+                                to k earlier vertices chosen by preferential
+                                attachment (Barabasi-Albert)
+    NOTE: Up to the caller to free the memory using g_free() */
+graph_t g_generate_erdos_renyi(graph_id_t n, graph_id_t m, unsigned long long seed);
+graph_t g_generate_rmat(unsigned int scale, unsigned int edge_factor, unsigned long long seed);
+graph_t g_generate_grid(unsigned int rows, unsigned int cols);
+graph_t g_generate_power_law(graph_id_t n, unsigned int k, unsigned long long seed);
 
 #ifdef __cplusplus
 } // extern "C"
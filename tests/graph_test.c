@@ -21,7 +21,13 @@ void test_teardown(void) {
 /* private functions */
 static char* __str_duplicate(const char* s);
 static void  __add_vertices(graph_t g, int num);
-static void  __add_edge(graph_t g, unsigned int src, unsigned int dest, int val);
+static void  __add_edge(graph_t g, graph_id_t src, graph_id_t dest, int val);
+static double __int_weight(edge_t e);
+static const void* __str_serialize(void* metadata, size_t* len);
+static void* __str_deserialize(const void* data, size_t len);
+static void  __add_weighted_graph(graph_t g);
+static bool  __stop_at_nine(vertex_t v, void* data);
+static bool  __same_graph(graph_t a, graph_t b);
 
 
 /*******************************************************************************
@@ -95,7 +101,7 @@ MU_TEST(test_remove_vertices) {
 
 MU_TEST(test_vertices_growth) {
     __add_vertices(g, 4000); /* add 4000 vertices! */
-    unsigned int i;
+    graph_id_t i;
     for (i = 0; i < 4000; i++) {  /* good for checking order when using openmp; only "check" if would fail */
         vertex_t v = g_vertex_get(g, i);
         if (g_vertex_id(v) != i) {
@@ -266,13 +272,381 @@ MU_TEST(test_edge_get_error) {
     mu_assert_null(g_edge_get(g, 2));
 }
 
+MU_TEST(test_edges_add_remove_parallel) {
+    /* start small so that the edge segments are added while inserting */
+    graph_t h = g_init_alt(2);
+    __add_vertices(h, 64);
+
+    int i;
+    #pragma omp parallel for
+    for (i = 0; i < 8192; i++)
+        g_edge_add(h, i % 64, (i * 7) % 64, NULL);
+    mu_assert_int_eq(8192, g_num_edges(h));
+
+    graph_id_t j, outs = 0, ins = 0;
+    for (j = 0; j < 64; j++) {
+        vertex_t v = g_vertex_get(h, j);
+        mu_assert_int_eq(128, g_vertex_num_edges_out(v));
+        outs += g_vertex_num_edges_out(v);
+        ins += g_vertex_num_edges_in(v);
+    }
+    mu_assert_int_eq(8192, outs);
+    mu_assert_int_eq(8192, ins);
+    graph_id_t found = 0;
+    for (j = 0; j < 8192; j++)
+        found += (g_edge_get(h, j) != NULL);
+    mu_assert_int_eq(8192, found);
+
+    /* every edge is removed exactly once, even when asked for twice */
+    graph_id_t removed = 0;
+    #pragma omp parallel for reduction(+:removed)
+    for (i = 0; i < 8192; i++) {
+        edge_t e = g_edge_remove(h, i / 2);
+        if (e != NULL) {
+            g_edge_free(e);
+            removed++;
+        }
+    }
+    mu_assert_int_eq(4096, removed);
+    mu_assert_int_eq(4096, g_num_edges(h));
+    outs = 0;
+    ins = 0;
+    for (j = 0; j < 64; j++) {
+        outs += g_vertex_num_edges_out(g_vertex_get(h, j));
+        ins += g_vertex_num_edges_in(g_vertex_get(h, j));
+    }
+    mu_assert_int_eq(4096, outs);
+    mu_assert_int_eq(4096, ins);
+    g_free(h);
+}
+
+MU_TEST(test_g_edge_find) {
+    __add_vertices(g, 5);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 2, 1);
+    __add_edge(g, 1, 2, 2);
+    __add_edge(g, 0, 2, 3);
+
+    mu_assert_int_eq(0, g_edge_id(g_edge_find(g, 0, 1)));
+    mu_assert_int_eq(2, g_edge_dest(g_edge_find(g, 0, 2)));
+    mu_assert_null(g_edge_find(g, 2, 0));
+    mu_assert_null(g_edge_find(g, 4, 0));
+    mu_assert_null(g_edge_find(g, 10, 0));
+    mu_check(g_edge_index(g, 3) == false);
+}
+
+MU_TEST(test_g_edge_find_hash) {
+    __add_vertices(g, 1000);
+    graph_id_t i;
+    for (i = 1; i < 1000; i++)
+        __add_edge(g, 0, i, i);
+    mu_check(g_edge_index(g, GRAPH_EDGE_INDEX_HASH));
+    for (i = 1000; i > 1; i--)  /* grows the index */
+        __add_edge(g, i - 1, 0, i);
+
+    for (i = 1; i < 1000; i++) {
+        mu_assert_int_eq(i - 1, g_edge_id(g_edge_find(g, 0, i)));
+        mu_assert_int_eq(i, g_edge_src(g_edge_find(g, i, 0)));
+    }
+    mu_assert_null(g_edge_find(g, 1, 2));
+
+    /* removing one of two edges between the same vertices keeps the other */
+    __add_edge(g, 0, 5, 0);
+    g_edge_free(g_edge_remove(g, 4));
+    mu_assert_int_eq(1998, g_edge_id(g_edge_find(g, 0, 5)));
+    g_edge_free(g_edge_remove(g, 1998));
+    mu_assert_null(g_edge_find(g, 0, 5));
+    g_edge_free(g_edge_remove(g, 5));
+    mu_assert_null(g_edge_find(g, 0, 6));
+    mu_assert_int_eq(6, g_edge_id(g_edge_find(g, 0, 7)));
+
+    /* compacting renumbers the keys */
+    g_vertex_free(g_vertex_remove(g, 0));
+    free(g_compact(g));
+    mu_assert_null(g_edge_find(g, 0, 1));
+    __add_edge(g, 0, 1, 0);
+    mu_assert_int_eq(0, g_edge_src(g_edge_find(g, 0, 1)));
+
+    mu_check(g_edge_index(g, GRAPH_EDGE_INDEX_NONE));
+    mu_assert_int_eq(1, g_edge_dest(g_edge_find(g, 0, 1)));
+}
+
+MU_TEST(test_g_edge_find_sorted) {
+    __add_vertices(g, 10);
+    __add_edge(g, 0, 5, 0);
+    __add_edge(g, 0, 3, 1);
+    __add_edge(g, 0, 9, 2);
+    __add_edge(g, 0, 3, 3);
+    mu_check(g_edge_index(g, GRAPH_EDGE_INDEX_SORTED));
+    __add_edge(g, 0, 4, 4);
+    __add_edge(g, 0, 3, 5);
+
+    graph_id_t dests[] = {3, 3, 3, 4, 5, 9};
+    graph_id_t ids[] = {1, 3, 5, 4, 0, 2};
+    vertex_t v = g_vertex_get(g, 0);
+    graph_id_t i;
+    for (i = 0; i < 6; i++) {
+        mu_assert_int_eq(dests[i], g_edge_dest(g_vertex_edge(v, i)));
+        mu_assert_int_eq(ids[i], g_edge_id(g_vertex_edge(v, i)));
+    }
+    mu_assert_int_eq(1, g_edge_id(g_edge_find(g, 0, 3)));
+    mu_assert_null(g_edge_find(g, 0, 6));
+
+    /* removing keeps the order */
+    g_edge_free(g_edge_remove(g, 1));
+    g_edge_free(g_edge_remove(g, 4));
+    graph_id_t left[] = {3, 5, 0, 2};
+    for (i = 0; i < 4; i++)
+        mu_assert_int_eq(left[i], g_edge_id(g_vertex_edge(v, i)));
+    mu_assert_int_eq(3, g_edge_id(g_edge_find(g, 0, 3)));
+    mu_assert_null(g_edge_find(g, 0, 4));
+
+    /* bulk adds are sorted too */
+    graph_id_t src[] = {0, 0};
+    graph_id_t dest[] = {8, 1};
+    g_edges_add_batch(g, src, dest, NULL, 2);
+    mu_assert_int_eq(1, g_edge_dest(g_vertex_edge(v, 0)));
+    mu_assert_int_eq(8, g_edge_dest(g_vertex_edge(v, 4)));
+    mu_assert_int_eq(7, g_edge_id(g_edge_find(g, 0, 1)));
+}
+
+MU_TEST(test_g_edge_find_hash_parallel) {
+    __add_vertices(g, 64);
+    g_edge_index(g, GRAPH_EDGE_INDEX_HASH);
+
+    int i;
+    #pragma omp parallel for
+    for (i = 0; i < 4096; i++)
+        g_edge_add(g, i % 64, i / 64, NULL);
+
+    graph_id_t found = 0;
+    for (i = 0; i < 4096; i++) {
+        edge_t e = g_edge_find(g, i % 64, i / 64);
+        found += (e != NULL && g_edge_src(e) == (graph_id_t)(i % 64) && g_edge_dest(e) == (graph_id_t)(i / 64));
+    }
+    mu_assert_int_eq(4096, found);
+
+    #pragma omp parallel for
+    for (i = 0; i < 4096; i += 2)
+        g_edge_free(g_edge_remove(g, g_edge_id(g_edge_find(g, i % 64, i / 64))));
+    found = 0;
+    for (i = 0; i < 4096; i++)
+        found += (g_edge_find(g, i % 64, i / 64) != NULL);
+    mu_assert_int_eq(2048, found);
+}
+
+MU_TEST(test_g_edge_find_parallel) {
+    /* lookups while other threads grow and shift the same edge lists */
+    unsigned int modes[] = {GRAPH_EDGE_INDEX_NONE, GRAPH_EDGE_INDEX_SORTED};
+    int i, k;
+    __add_vertices(g, 16);
+    for (i = 0; i < 16; i++)
+        g_edge_add(g, i, (i + 1) % 16, NULL);
+    for (k = 0; k < 2; k++) {
+        g_edge_index(g, modes[k]);
+        graph_id_t found = 0;
+        #pragma omp parallel for reduction(+:found)
+        for (i = 0; i < 4096; i++) {
+            if (i % 2 == 0)
+                g_edge_add(g, i % 16, (i / 16) % 16, NULL);
+            else
+                found += (g_edge_find(g, i % 16, (i % 16 + 1) % 16) != NULL);
+        }
+        mu_assert_int_eq(2048, found);
+    }
+}
+
+
+/*******************************************************************************
+*   Test adding edges in bulk
+*******************************************************************************/
+MU_TEST(test_edges_add_batch) {
+    __add_vertices(g, 5);
+    graph_id_t src[] = {0, 0, 1, 3, 0, 4};
+    graph_id_t dest[] = {1, 2, 2, 4, 3, 0};
+    void* metadata[6];
+    graph_id_t i;
+    for (i = 0; i < 6; i++) {
+        int* q = (int*)calloc(1, sizeof(int));
+        *q = i;
+        metadata[i] = q;
+    }
+
+    mu_assert_int_eq(6, g_edges_add_batch(g, src, dest, metadata, 6));
+    mu_assert_int_eq(6, g_num_edges(g));
+
+    /* ids follow the input order */
+    for (i = 0; i < 6; i++) {
+        edge_t e = g_edge_get(g, i);
+        mu_assert_int_eq(src[i], g_edge_src(e));
+        mu_assert_int_eq(dest[i], g_edge_dest(e));
+        mu_assert_int_eq(i, *(int*)g_edge_metadata(e));
+    }
+
+    /* edges out of a vertex keep the input order */
+    vertex_t v = g_vertex_get(g, 0);
+    mu_assert_int_eq(3, g_vertex_num_edges_out(v));
+    mu_assert_int_eq(1, g_vertex_num_edges_in(v));
+    mu_assert_int_eq(0, g_edge_id(g_vertex_edge(v, 0)));
+    mu_assert_int_eq(1, g_edge_id(g_vertex_edge(v, 1)));
+    mu_assert_int_eq(4, g_edge_id(g_vertex_edge(v, 2)));
+    mu_assert_int_eq(2, g_vertex_num_edges_in(g_vertex_get(g, 2)));
+}
+
+MU_TEST(test_edges_add_batch_after_add) {
+    __add_vertices(g, 5);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 2, 1);
+
+    graph_id_t src[] = {0, 2};
+    graph_id_t dest[] = {4, 3};
+    mu_assert_int_eq(2, g_edges_add_batch(g, src, dest, NULL, 2));
+    mu_assert_int_eq(4, g_num_edges(g));
+
+    edge_t e = g_edge_get(g, 2);
+    mu_assert_int_eq(0, g_edge_src(e));
+    mu_assert_int_eq(4, g_edge_dest(e));
+    mu_assert_null(g_edge_metadata(e));
+
+    vertex_t v = g_vertex_get(g, 0);
+    mu_assert_int_eq(3, g_vertex_num_edges_out(v));
+    mu_assert_int_eq(2, g_edge_id(g_vertex_edge(v, 2)));
+
+    /* make sure a normal add still works after the batch */
+    __add_edge(g, 4, 0, 4);
+    mu_assert_int_eq(4, g_edge_id(g_vertex_edge(g_vertex_get(g, 4), 0)));
+    mu_assert_int_eq(5, g_num_edges(g));
+}
+
+MU_TEST(test_edges_add_batch_invalid) {
+    __add_vertices(g, 5);
+    vertex_t v = g_vertex_remove(g, 3);
+    g_vertex_free(v);
+
+    graph_id_t src[] = {0, 7, 1, 3, 2};
+    graph_id_t dest[] = {1, 0, 9, 1, 4};
+    mu_assert_int_eq(2, g_edges_add_batch(g, src, dest, NULL, 5));
+    mu_assert_int_eq(2, g_num_edges(g));
+    mu_assert_int_eq(2, g_edge_src(g_edge_get(g, 1)));
+    mu_assert_null(g_edge_get(g, 2));
+
+    mu_assert_int_eq(0, g_edges_add_batch(g, src, dest, NULL, 0));
+}
+
+MU_TEST(test_edges_add_batch_large) {
+    __add_vertices(g, 3000);
+    graph_id_t n = 3000 * 4, i;
+    graph_id_t* src = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    for (i = 0; i < n; i++) {
+        src[i] = (i * 7) % 3000;
+        dest[i] = (i * 13 + 1) % 3000;
+    }
+    src[5] = 0; /* make vertex 0 a little busier */
+
+    mu_assert_int_eq(n, g_edges_add_batch(g, src, dest, NULL, n));
+    mu_assert_int_eq(n, g_num_edges(g));
+
+    graph_id_t outs = 0, ins = 0;
+    vertex_t v;
+    g_iterate_vertices(g, v, i) {
+        outs += g_vertex_num_edges_out(v);
+        ins += g_vertex_num_edges_in(v);
+    }
+    mu_assert_int_eq(n, outs);
+    mu_assert_int_eq(n, ins);
+    for (i = 0; i < n; i++) {
+        edge_t e = g_edge_get(g, i);
+        if (g_edge_src(e) != src[i] || g_edge_dest(e) != dest[i]) {
+            mu_assert_int_eq(src[i], g_edge_src(e));
+            mu_assert_int_eq(dest[i], g_edge_dest(e));
+        }
+    }
+    free(src);
+    free(dest);
+}
+
+
+/*******************************************************************************
+*   Test memory and statistics
+*******************************************************************************/
+MU_TEST(test_g_stats) {
+    __add_weighted_graph(g);
+    __add_edge(g, 4, 0, 0);
+    g_edge_free(g_edge_remove(g, 6));
+    g_vertex_free(g_vertex_remove(g, 5));
+
+    graph_stats_t stats;
+    g_stats(g, &stats);
+    mu_check(stats.bytes_total == g_memory_usage(g));
+    mu_check(stats.bytes_total == stats.bytes_graph + stats.bytes_tables + stats.bytes_vertices + stats.bytes_edges +
+             stats.bytes_edge_lists + stats.bytes_snapshots + stats.bytes_index + stats.bytes_props);
+    mu_check(stats.bytes_wasted > 0 && stats.bytes_wasted < stats.bytes_total);
+    mu_check(stats.bytes_snapshots == 0 && stats.bytes_index == 0 && stats.bytes_props == 0);
+    mu_assert_int_eq(1, stats.vertex_holes);
+    mu_assert_int_eq(1, stats.edge_holes);
+    mu_assert_int_eq(2, stats.max_degree_out);
+    mu_assert_int_eq(2, stats.max_degree_in);
+
+    /* out degrees are 2, 1, 2, 1, 0 and in degrees 0, 2, 1, 2, 1 */
+    mu_assert_int_eq(1, stats.degree_out[0]);
+    mu_assert_int_eq(2, stats.degree_out[1]);
+    mu_assert_int_eq(2, stats.degree_out[2]);
+    mu_assert_int_eq(1, stats.degree_in[0]);
+    mu_assert_int_eq(2, stats.degree_in[1]);
+    mu_assert_int_eq(2, stats.degree_in[2]);
+    mu_assert_int_eq(0, stats.degree_in[3]);
+
+    g_vertex_prop_double(g, "score");
+    g_stats(g, &stats);
+    mu_check(stats.bytes_props > 0);
+}
+
+MU_TEST(test_g_shrink_to_fit) {
+    const graph_id_t n = 5000;
+    graph_id_t i;
+    __add_vertices(g, n);
+    for (i = 0; i < n; i++)
+        __add_edge(g, i, (i + 1) % n, i);
+    for (i = 1000; i < n; i++)
+        g_vertex_free(g_vertex_remove(g, i));
+    g_vertex_prop_uint(g, "label")[5] = 3;
+    g_snapshots_enable(g, true);
+
+    graph_stats_t before, after;
+    g_stats(g, &before);
+    size_t freed = g_shrink_to_fit(g);
+    g_stats(g, &after);
+    mu_check(freed > 0);
+    mu_check(before.bytes_total - freed == after.bytes_total);
+    mu_check(after.bytes_edge_lists < before.bytes_edge_lists);
+    mu_check(after.bytes_wasted < before.bytes_wasted);
+    mu_assert_int_eq(0, g_shrink_to_fit(g));
+
+    /* everything is still there and the graph can grow again */
+    mu_assert_int_eq(1000, g_num_vertices(g));
+    mu_assert_int_eq(999, g_num_edges(g));
+    mu_assert_int_eq(3, g_vertex_prop_uint(g, "label")[5]);
+    mu_assert_int_eq(7, g_edge_dest(g_vertex_edge(g_vertex_get(g, 6), 0)));
+    for (i = 0; i < 100; i++) {
+        __add_edge(g, 6, i, i);
+        __add_edge(g, i, 7, i);
+    }
+    mu_assert_int_eq(102, g_vertex_num_edges_out(g_vertex_get(g, 6)));
+    mu_assert_int_eq(102, g_vertex_num_edges_in(g_vertex_get(g, 7)));
+    mu_check(g_vertex_add_alt(g, 2 * n, NULL) != NULL);
+    mu_check(g_vertex_get(g, 2 * n) != NULL);
+    g_edge_add(g, 2 * n, 0, NULL);
+    mu_assert_int_eq(1200, g_num_edges(g));
+}
+
 
 /*******************************************************************************
 *   Test iterating over the vertices
 *******************************************************************************/
 MU_TEST(test_iterate_vertices_all_there) {
     __add_vertices(g, 5);
-    unsigned int i;
+    graph_id_t i;
     vertex_t v;
     g_iterate_vertices(g,v,i) {
         mu_assert_int_eq(i, *(int*)g_vertex_metadata(v));
@@ -285,7 +659,7 @@ MU_TEST(test_iterate_vertices_some_removed) {
     vertex_t t = g_vertex_remove(g, 2);
     g_vertex_free(t);
 
-    unsigned int i;
+    graph_id_t i;
     vertex_t v;
     g_iterate_vertices(g,v,i) {
         mu_assert_int_eq(i, *(int*)g_vertex_metadata(v));
@@ -299,7 +673,7 @@ MU_TEST(test_iterate_edges) {
     __add_edge(g, 0, 3, 2);
     __add_edge(g, 0, 4, 3);
 
-    unsigned int i, j = 0;
+    graph_id_t i, j = 0;
     edge_t e;
     vertex_t v = g_vertex_get(g, 0);
     g_iterate_edges(v, e, i) {
@@ -309,9 +683,40 @@ MU_TEST(test_iterate_edges) {
     mu_assert_int_eq(4, j);
 }
 
+MU_TEST(test_iterate_edges_in) {
+    __add_vertices(g, 5);
+    __add_edge(g, 1, 0, 0);
+    __add_edge(g, 2, 0, 1);
+    __add_edge(g, 0, 0, 2);
+    __add_edge(g, 0, 3, 3);
+    graph_id_t src[] = {3, 4};
+    graph_id_t dest[] = {0, 0};
+    mu_assert_int_eq(2, g_edges_add_batch(g, src, dest, NULL, 2));
+
+    graph_id_t i, j = 0, sum = 0;
+    edge_t e;
+    vertex_t v = g_vertex_get(g, 0);
+    g_iterate_edges_in(v, e, i) {
+        j += (g_edge_dest(e) == 0);
+        sum += g_edge_src(e);
+    }
+    mu_assert_int_eq(5, j);
+    mu_assert_int_eq(10, sum);
+    mu_check(g_vertex_edge_in(v, 5) == NULL);
+
+    /* removing edges and vertices keeps the edges in up to date */
+    g_edge_free(g_edge_remove(g, 1));
+    mu_assert_int_eq(4, g_vertex_num_edges_in(v));
+    g_vertex_free(g_vertex_remove(g, 3));
+    mu_assert_int_eq(3, g_vertex_num_edges_in(v));
+    g_vertex_free(g_vertex_remove(g, 0));
+    mu_assert_int_eq(0, g_num_edges(g));
+    mu_assert_int_eq(0, g_vertex_num_edges_out(g_vertex_get(g, 1)));
+}
+
 MU_TEST(test_iterate_edges_large) {
     __add_vertices(g, 5);
-    unsigned int i, j = 0;
+    graph_id_t i, j = 0;
     for (i = 0; i < 65; i++) { /* add 64 edges to the same vertex */
         __add_edge(g, 0, i % 5, i);
     }
@@ -339,7 +744,7 @@ MU_TEST(test_iterate_edges_some_removed) {
     g_edge_free(t);
     t = g_edge_remove(g, 2);
     g_edge_free(t);
-    unsigned int i, j = 0;
+    graph_id_t i, j = 0;
     edge_t e;
     vertex_t v = g_vertex_get(g, 0);
     /* wierd test, but should be true since we should have vals 0 and 3 left */
@@ -363,7 +768,7 @@ MU_TEST(test_iterate_edges_some_removed_add_back) {
     g_edge_free(t);
 
     __add_edge(g, 0, 4, 6); /* this function just turns the last int into a pointer for metadata */
-    unsigned int i, j = 0;
+    graph_id_t i, j = 0;
     edge_t e;
     vertex_t v = g_vertex_get(g, 0);
     /* wierd test, but should be true since we should have vals 0, 3, and 6 left */
@@ -402,8 +807,8 @@ MU_TEST(test_g_breadth_first_traverse) {
     __add_edge(g, 9, 1, 0);
 
     int answers[] = {0, 1, 3, 2, 4, 5, 10, 9, 8, 12, 6, 13, 14};
-    unsigned int len, i;
-    unsigned int* res = g_breadth_first_traverse(g, g_vertex_get(g, 0), &len);
+    graph_id_t len, i;
+    graph_id_t* res = g_breadth_first_traverse(g, g_vertex_get(g, 0), &len);
 
     mu_assert_int_eq(13, len);
     for (i = 0; i < len; i++) {
@@ -430,8 +835,8 @@ MU_TEST(test_g_depth_first_traverse) {
     __add_edge(g, 9, 1, 0);
 
     int answers[] = {0, 1, 4, 8, 12, 5, 3, 10, 6, 14, 2, 9, 13};
-    unsigned int len, i;
-    unsigned int* res = g_depth_first_traverse(g, g_vertex_get(g, 0), &len);
+    graph_id_t len, i;
+    graph_id_t* res = g_depth_first_traverse(g, g_vertex_get(g, 0), &len);
     mu_assert_int_eq(13, len);
     for (i = 0; i < len; i++) {
         mu_assert_int_eq(answers[i], res[i]);
@@ -439,6 +844,1762 @@ MU_TEST(test_g_depth_first_traverse) {
     free(res);
 }
 
+MU_TEST(test_g_traverse_workspace) {
+    __add_vertices(g, 15);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 3, 0);
+    __add_edge(g, 0, 2, 0);
+    __add_edge(g, 1, 4, 0);
+    __add_edge(g, 1, 5, 0);
+    __add_edge(g, 2, 9, 0);
+    __add_edge(g, 3, 10, 0);
+    __add_edge(g, 10, 6, 0);
+    __add_edge(g, 4, 8, 0);
+    __add_edge(g, 4, 12, 0);
+    __add_edge(g, 6, 14, 0);
+    __add_edge(g, 9, 13, 0);
+    __add_edge(g, 9, 1, 0);
+
+    graph_workspace_t w = g_workspace_init(g);
+    graph_id_t res[16], len, i, count;
+    graph_id_t* expected = g_breadth_first_traverse(g, g_vertex_get(g, 0), &len);
+    mu_assert_int_eq(len, g_breadth_first_traverse_alt(g, g_vertex_get(g, 0), w, res, 16));
+    for (i = 0; i < len; i++)
+        mu_assert_int_eq(expected[i], res[i]);
+    free(expected);
+
+    expected = g_depth_first_traverse(g, g_vertex_get(g, 0), &len);
+    mu_assert_int_eq(len, g_depth_first_traverse_alt(g, g_vertex_get(g, 0), w, res, 16));
+    for (i = 0; i < len; i++)
+        mu_assert_int_eq(expected[i], res[i]);
+    free(expected);
+
+    /* stops once the buffer is full */
+    mu_assert_int_eq(3, g_depth_first_traverse_alt(g, g_vertex_get(g, 0), w, res, 3));
+    mu_assert_int_eq(4, res[2]);
+
+    /* the visit function can stop the traversal */
+    count = 0;
+    mu_assert_int_eq(8, g_breadth_first_visit(g, g_vertex_get(g, 0), w, __stop_at_nine, &count));
+    mu_assert_int_eq(8, count);
+
+    /* only the last traversal counts as visited */
+    mu_assert_int_eq(3, g_breadth_first_visit(g, g_vertex_get(g, 10), w, NULL, NULL));
+    mu_check(g_workspace_visited(w, 14));
+    mu_check(g_workspace_visited(w, 0) == false);
+    mu_check(g_workspace_visited(w, 100) == false);
+
+    /* the workspace grows with the graph */
+    g_vertex_add(g, NULL);
+    __add_edge(g, 14, 15, 0);
+    mu_assert_int_eq(4, g_depth_first_visit(g, g_vertex_get(g, 10), w, NULL, NULL));
+    mu_check(g_workspace_visited(w, 15));
+    mu_assert_int_eq(0, g_depth_first_visit(g, NULL, w, NULL, NULL));
+    g_workspace_free(w);
+}
+MU_TEST(test_g_multi_source_bfs) {
+    __add_vertices(g, 6);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 4, 5, 0);
+    __add_edge(g, 3, 1, 0);
+
+    graph_id_t sources[] = {0, 2, 4, 99, 0};
+    graph_id_t* dist = g_multi_source_bfs(g, sources, 5);
+    graph_id_t X = GRAPH_INVALID_ID;
+    graph_id_t expected[] = {
+        0, 1, 2, 3, X, X,
+        X, 2, 0, 1, X, X,
+        X, X, X, X, 0, 1,
+        X, X, X, X, X, X,
+        0, 1, 2, 3, X, X
+    };
+    graph_id_t i;
+    for (i = 0; i < 30; i++)
+        mu_assert_int_eq(expected[i], dist[i]);
+    free(dist);
+
+    unsigned long long sums[5];
+    graph_id_t reached[5];
+    mu_check(g_multi_source_bfs_sums(g, sources, 5, sums, reached));
+    mu_assert_int_eq(6, sums[0]);
+    mu_assert_int_eq(4, reached[0]);
+    mu_assert_int_eq(3, sums[1]);
+    mu_assert_int_eq(3, reached[1]);
+    mu_assert_int_eq(1, sums[2]);
+    mu_assert_int_eq(0, reached[3]);
+}
+
+MU_TEST(test_g_multi_source_bfs_batches) {
+    /* more sources than fit in one batch, checked against single searches */
+    graph_id_t i, j, sources[70];
+    unsigned long long state = 7;
+    __add_vertices(g, 100);
+    for (i = 0; i < 300; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % 100, (graph_id_t)(state >> 45) % 100, 0);
+    }
+    for (i = 0; i < 70; i++)
+        sources[i] = (i * 37) % 100;
+
+    graph_id_t* dist = g_multi_source_bfs(g, sources, 70);
+    unsigned long long sums[70];
+    g_multi_source_bfs_sums(g, sources, 70, sums, NULL);
+    graph_id_t wrong = 0;
+    for (i = 0; i < 70; i++) {
+        double* d = g_dijkstra(g, g_vertex_get(g, sources[i]), NULL, NULL);
+        unsigned long long sum = 0;
+        for (j = 0; j < 100; j++) {
+            graph_id_t hops = (d[j] == INFINITY) ? GRAPH_INVALID_ID : (graph_id_t)d[j];
+            wrong += (hops != dist[i * 100 + j]);
+            sum += (hops == GRAPH_INVALID_ID) ? 0 : hops;
+        }
+        wrong += (sum != sums[i]);
+        free(d);
+    }
+    mu_assert_int_eq(0, wrong);
+    free(dist);
+}
+
+MU_TEST(test_g_shortest_path) {
+    __add_vertices(g, 8);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 3, 4, 0);
+    __add_edge(g, 0, 5, 0);
+    __add_edge(g, 5, 3, 0);
+    __add_edge(g, 4, 0, 0);
+
+    graph_id_t len, i;
+    graph_id_t expected[] = {0, 5, 3, 4};
+    graph_id_t* path = g_shortest_path(g, 0, 4, &len);
+    mu_assert_int_eq(4, len);
+    for (i = 0; i < len; i++)
+        mu_assert_int_eq(expected[i], path[i]);
+    free(path);
+
+    /* edges are only followed forwards */
+    path = g_shortest_path(g, 4, 5, &len);
+    mu_assert_int_eq(3, len);
+    mu_assert_int_eq(4, path[0]);
+    mu_assert_int_eq(0, path[1]);
+    mu_assert_int_eq(5, path[2]);
+    free(path);
+
+    path = g_shortest_path(g, 2, 2, &len);
+    mu_assert_int_eq(1, len);
+    mu_assert_int_eq(2, path[0]);
+    free(path);
+
+    /* unreachable and missing vertices */
+    mu_check(g_shortest_path(g, 0, 6, &len) == NULL);
+    mu_assert_int_eq(0, len);
+    mu_check(g_shortest_path(g, 6, 0, &len) == NULL);
+    mu_check(g_shortest_path(g, 0, 100, &len) == NULL);
+    mu_assert_int_eq(0, len);
+}
+
+MU_TEST(test_g_shortest_path_random) {
+    /* the path lengths match a single search and every step is an edge */
+    graph_id_t i, j, len, wrong = 0;
+    unsigned long long state = 11;
+    __add_vertices(g, 200);
+    for (i = 0; i < 500; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % 200, (graph_id_t)(state >> 45) % 200, 0);
+    }
+
+    graph_workspace_t w = g_workspace_init(g);
+    for (i = 0; i < 20; i++) {
+        double* d = g_dijkstra(g, g_vertex_get(g, i), NULL, NULL);
+        for (j = 0; j < 200; j += 7) {
+            graph_id_t* path = g_shortest_path_alt(g, i, j, w, &len);
+            if (d[j] == INFINITY) {
+                wrong += (path != NULL);
+                continue;
+            }
+            wrong += (path == NULL || len != (graph_id_t)d[j] + 1 || path[0] != i || path[len - 1] != j);
+            graph_id_t k;
+            for (k = 1; path != NULL && k < len; k++)
+                wrong += (g_edge_find(g, path[k - 1], path[k]) == NULL);
+            free(path);
+        }
+        free(d);
+    }
+    g_workspace_free(w);
+    mu_assert_int_eq(0, wrong);
+}
+
+
+/*******************************************************************************
+*   Test weighted shortest paths
+*******************************************************************************/
+MU_TEST(test_g_dijkstra) {
+    __add_weighted_graph(g);
+    graph_id_t* prev;
+    double* dist = g_dijkstra(g, g_vertex_get(g, 0), __int_weight, &prev);
+
+    double answers[] = {0, 3, 1, 4, 7};
+    graph_id_t prev_answers[] = {GRAPH_INVALID_ID, 2, 0, 1, 3, GRAPH_INVALID_ID};
+    graph_id_t i;
+    for (i = 0; i < 5; i++)
+        mu_assert_double_eq(answers[i], dist[i]);
+    mu_check(dist[5] == INFINITY);
+    for (i = 0; i < 6; i++)
+        mu_assert_int_eq(prev_answers[i], prev[i]);
+    free(dist);
+    free(prev);
+}
+
+MU_TEST(test_g_dijkstra_alt) {
+    __add_weighted_graph(g);
+    double weights[] = {4, 1, 2, 1, 5, 1};  /* make 3 -> 4 cheaper */
+    double* dist = g_dijkstra_alt(g, g_vertex_get(g, 2), weights, NULL);
+    mu_check(dist[0] == INFINITY);
+    mu_assert_double_eq(2, dist[1]);
+    mu_assert_double_eq(0, dist[2]);
+    mu_assert_double_eq(3, dist[3]);
+    mu_assert_double_eq(4, dist[4]);
+    free(dist);
+}
+
+MU_TEST(test_g_dijkstra_unweighted) {
+    __add_weighted_graph(g);
+    double* dist = g_dijkstra(g, g_vertex_get(g, 0), NULL, NULL);
+    mu_assert_double_eq(1, dist[1]);
+    mu_assert_double_eq(2, dist[3]);
+    mu_assert_double_eq(3, dist[4]);
+    free(dist);
+}
+
+MU_TEST(test_g_dijkstra_negative) {
+    __add_weighted_graph(g);
+    __add_edge(g, 4, 0, -1);
+    graph_id_t tmp;
+    graph_id_t* prev = &tmp;  /* should be reset to NULL */
+    mu_assert_null(g_dijkstra(g, g_vertex_get(g, 0), __int_weight, &prev));
+    mu_assert_null(prev);
+    mu_assert_null(g_delta_stepping(g, g_vertex_get(g, 0), __int_weight, 1.0, NULL));
+}
+
+MU_TEST(test_g_delta_stepping) {
+    __add_weighted_graph(g);
+    graph_id_t* prev;
+    double* dist = g_delta_stepping(g, g_vertex_get(g, 0), __int_weight, 1.5, &prev);
+
+    double answers[] = {0, 3, 1, 4, 7};
+    graph_id_t prev_answers[] = {GRAPH_INVALID_ID, 2, 0, 1, 3, GRAPH_INVALID_ID};
+    graph_id_t i;
+    for (i = 0; i < 5; i++)
+        mu_assert_double_eq(answers[i], dist[i]);
+    mu_check(dist[5] == INFINITY);
+    for (i = 0; i < 6; i++)
+        mu_assert_int_eq(prev_answers[i], prev[i]);
+    free(dist);
+    free(prev);
+}
+
+MU_TEST(test_g_delta_stepping_matches_dijkstra) {
+    __add_vertices(g, 500);
+    graph_id_t i;
+    for (i = 0; i < 4000; i++)
+        __add_edge(g, (i * 7919) % 500, (i * 104729 + 3) % 500, (i * 31) % 97);
+
+    double* expected = g_dijkstra(g, g_vertex_get(g, 1), __int_weight, NULL);
+    double* dist = g_delta_stepping(g, g_vertex_get(g, 1), __int_weight, 0.0, NULL);
+    graph_id_t* prev;
+    double* dist2 = g_delta_stepping(g, g_vertex_get(g, 1), __int_weight, 10.0, &prev);
+    for (i = 0; i < 500; i++) {
+        if (expected[i] != dist[i] || expected[i] != dist2[i]) {
+            mu_assert_double_eq(expected[i], dist[i]);
+            mu_assert_double_eq(expected[i], dist2[i]);
+        }
+        /* every predecessor must be on a shortest path */
+        if (prev[i] != GRAPH_INVALID_ID && expected[prev[i]] > expected[i]) {
+            mu_fail("predecessor is further away than the vertex");
+        }
+    }
+    free(expected);
+    free(dist);
+    free(dist2);
+    free(prev);
+}
+
+/*******************************************************************************
+*   Test components
+*******************************************************************************/
+MU_TEST(test_g_connected_components) {
+    __add_vertices(g, 10);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 2, 1, 0);
+    __add_edge(g, 4, 3, 0);
+    __add_edge(g, 6, 5, 0);
+    __add_edge(g, 5, 9, 0);
+    __add_edge(g, 9, 6, 0);
+    vertex_t v = g_vertex_remove(g, 8);
+    g_vertex_free(v);
+
+    graph_id_t num, *sizes;
+    graph_id_t* comps = g_connected_components(g, &num, &sizes);
+    graph_id_t answers[] = {0, 0, 0, 1, 1, 2, 2, 3, GRAPH_INVALID_ID, 2};
+    graph_id_t size_answers[] = {3, 2, 3, 1};
+    mu_assert_int_eq(4, num);
+    graph_id_t i;
+    for (i = 0; i < 10; i++)
+        mu_assert_int_eq(answers[i], comps[i]);
+    for (i = 0; i < num; i++)
+        mu_assert_int_eq(size_answers[i], sizes[i]);
+    free(comps);
+    free(sizes);
+}
+
+MU_TEST(test_g_connected_components_large) {
+    __add_vertices(g, 1000);
+    graph_id_t i;
+    for (i = 0; i < 999; i++) {
+        if (i % 10 != 9)  /* chains of 10, half pointing backwards */
+            __add_edge(g, (i % 2 == 0) ? i : i + 1, (i % 2 == 0) ? i + 1 : i, 0);
+    }
+
+    graph_id_t num;
+    graph_id_t* comps = g_connected_components(g, &num, NULL);
+    mu_assert_int_eq(100, num);
+    for (i = 0; i < 1000; i++) {
+        if (comps[i] != i / 10)
+            mu_assert_int_eq(i / 10, comps[i]);
+    }
+    free(comps);
+}
+
+MU_TEST(test_g_connected_components_empty) {
+    graph_id_t num = 5;
+    graph_id_t* comps = g_connected_components(g, &num, NULL);
+    mu_assert_int_eq(0, num);
+    free(comps);
+}
+
+MU_TEST(test_g_strongly_connected_components) {
+    __add_vertices(g, 9);
+    __add_edge(g, 0, 1, 0);  /* {0, 1, 2} */
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 0, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 1, 3, 0);
+    __add_edge(g, 3, 4, 0);  /* {3, 4} */
+    __add_edge(g, 4, 3, 0);
+    __add_edge(g, 4, 5, 0);  /* {5} */
+    __add_edge(g, 6, 7, 0);  /* {6, 7} */
+    __add_edge(g, 7, 6, 0);
+    __add_edge(g, 7, 5, 0);
+    __add_edge(g, 8, 8, 0);  /* {8} */
+    vertex_t v = g_vertex_remove(g, 8);
+    g_vertex_free(v);
+
+    graph_id_t num;
+    graph_t c;
+    graph_id_t* comps = g_strongly_connected_components(g, &num, &c);
+    mu_assert_int_eq(4, num);
+    mu_assert_int_eq(comps[0], comps[1]);
+    mu_assert_int_eq(comps[0], comps[2]);
+    mu_assert_int_eq(comps[3], comps[4]);
+    mu_assert_int_eq(comps[6], comps[7]);
+    mu_check(comps[8] == GRAPH_INVALID_ID);
+    mu_assert_int_not_eq(comps[0], comps[3]);
+    mu_assert_int_not_eq(comps[3], comps[5]);
+    mu_assert_int_not_eq(comps[6], comps[0]);
+
+    /* the components are in topological order */
+    mu_check(comps[0] < comps[3]);
+    mu_check(comps[3] < comps[5]);
+    mu_check(comps[6] < comps[5]);
+
+    /* the two edges from {0, 1, 2} to {3, 4} become a single edge */
+    mu_assert_int_eq(4, g_num_vertices(c));
+    mu_assert_int_eq(3, g_num_edges(c));
+    mu_assert_int_eq(1, g_vertex_num_edges_out(g_vertex_get(c, comps[0])));
+    mu_assert_int_eq(2, g_vertex_num_edges_in(g_vertex_get(c, comps[5])));
+    free(comps);
+    g_free(c);
+}
+
+MU_TEST(test_g_strongly_connected_components_deep) {
+    /* a long cycle would overflow the stack with a recursive version */
+    graph_id_t i, n = 200000, num;
+    __add_vertices(g, n);
+    graph_id_t* src = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    graph_id_t* dest = (graph_id_t*)malloc(n * sizeof(graph_id_t));
+    for (i = 0; i < n; i++) {
+        src[i] = i;
+        dest[i] = (i + 1) % n;
+    }
+    g_edges_add_batch(g, src, dest, NULL, n);
+    graph_id_t* comps = g_strongly_connected_components(g, &num, NULL);
+    mu_assert_int_eq(1, num);
+    mu_assert_int_eq(0, comps[n - 1]);
+    free(comps);
+
+    edge_t e = g_edge_remove(g, n - 1);
+    g_edge_free(e);
+    comps = g_strongly_connected_components(g, &num, NULL);
+    mu_assert_int_eq(n, num);
+    mu_assert_int_eq(0, comps[0]);
+    mu_assert_int_eq(n - 1, comps[n - 1]);
+    free(comps);
+    free(src);
+    free(dest);
+}
+
+MU_TEST(test_g_topological_sort) {
+    __add_vertices(g, 7);
+    __add_edge(g, 5, 2, 0);
+    __add_edge(g, 5, 0, 0);
+    __add_edge(g, 4, 0, 0);
+    __add_edge(g, 4, 1, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 3, 1, 0);
+    __add_edge(g, 6, 3, 0);
+
+    graph_id_t answers[] = {4, 5, 6, 2, 0, 3, 1};
+    graph_id_t len, i;
+    graph_id_t* res = g_topological_sort(g, &len);
+    mu_assert_int_eq(7, len);
+    for (i = 0; i < len; i++)
+        mu_assert_int_eq(answers[i], res[i]);
+    free(res);
+
+    /* add a cycle */
+    __add_edge(g, 1, 5, 0);
+    res = g_topological_sort(g, &len);
+    mu_assert_null(res);
+    mu_assert_int_eq(0, len);
+}
+
+/*******************************************************************************
+*   Test centrality
+*******************************************************************************/
+MU_TEST(test_g_betweenness_centrality) {
+    /* a chain and a diamond; vertex 8 is removed */
+    __add_vertices(g, 9);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 4, 5, 0);
+    __add_edge(g, 4, 6, 0);
+    __add_edge(g, 5, 7, 0);
+    __add_edge(g, 6, 7, 0);
+    __add_edge(g, 2, 2, 0);
+    g_vertex_free(g_vertex_remove(g, 8));
+
+    double expected[] = {0, 2, 2, 0, 0, 0.5, 0.5, 0, 0};
+    double* bc = g_betweenness_centrality(g, 0, 0);
+    graph_id_t i;
+    for (i = 0; i < 9; i++)
+        mu_assert_double_eq(expected[i], bc[i]);
+    free(bc);
+
+    /* asking for as many samples as vertices is exact */
+    bc = g_betweenness_centrality(g, 100, 1);
+    for (i = 0; i < 9; i++)
+        mu_assert_double_eq(expected[i], bc[i]);
+    free(bc);
+}
+
+MU_TEST(test_g_betweenness_centrality_sampled) {
+    /*  in a directed cycle every source adds 36 in total, so the scaled up
+        total of any sample is exact */
+    graph_id_t i;
+    __add_vertices(g, 10);
+    for (i = 0; i < 10; i++)
+        __add_edge(g, i, (i + 1) % 10, 0);
+
+    double* bc = g_betweenness_centrality(g, 0, 0);
+    for (i = 0; i < 10; i++)
+        mu_assert_double_eq(36, bc[i]);
+    free(bc);
+
+    bc = g_betweenness_centrality(g, 4, 12345);
+    double total = 0.0;
+    for (i = 0; i < 10; i++)
+        total += bc[i];
+    mu_assert_double_eq(360, total);
+    free(bc);
+}
+
+MU_TEST(test_g_closeness_centrality) {
+    __add_vertices(g, 5);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 0, 1, 0);
+    g_vertex_free(g_vertex_remove(g, 4));
+
+    double* cc = g_closeness_centrality(g);
+    mu_assert_double_eq(0.5, cc[0]);
+    mu_assert_double_eq(4.0 / 9.0, cc[1]);
+    mu_assert_double_eq(1.0 / 3.0, cc[2]);
+    mu_assert_double_eq(0, cc[3]);
+    mu_assert_double_eq(0, cc[4]);
+    free(cc);
+}
+
+/*******************************************************************************
+*   Test spanning trees
+*******************************************************************************/
+MU_TEST(test_g_kruskal) {
+    __add_weighted_graph(g);
+    __add_edge(g, 4, 4, 0);  /* self loops are never used */
+
+    graph_id_t num, i;
+    double total;
+    graph_id_t expected[] = {1, 3, 2, 5};
+    graph_id_t* ids = g_kruskal(g, __int_weight, &num, &total);
+    mu_assert_int_eq(4, num);
+    mu_assert_double_eq(7, total);
+    for (i = 0; i < num; i++)
+        mu_assert_int_eq(expected[i], ids[i]);
+    free(ids);
+
+    /* weights from an array; 2 -> 3 is now the cheaper way to reach 3 */
+    double weights[] = {4, 1, 2, 1, 0.5, 3, 1};
+    ids = g_kruskal_alt(g, weights, &num, &total);
+    mu_assert_int_eq(4, num);
+    mu_assert_double_eq(5.5, total);
+    mu_assert_int_eq(4, ids[0]);
+    free(ids);
+
+    /* without weights, any spanning forest will do */
+    ids = g_kruskal(g, NULL, &num, NULL);
+    mu_assert_int_eq(4, num);
+    free(ids);
+}
+
+MU_TEST(test_g_boruvka) {
+    __add_weighted_graph(g);
+    graph_id_t num, i, sum = 0;
+    double total;
+    graph_id_t* ids = g_boruvka(g, __int_weight, &num, &total);
+    mu_assert_int_eq(4, num);
+    mu_assert_double_eq(7, total);
+    for (i = 0; i < num; i++)
+        sum += ids[i];
+    mu_assert_int_eq(11, sum);  /* 1, 2, 3 and 5 in any order */
+    free(ids);
+
+    graph_t h = g_init();
+    ids = g_boruvka(h, NULL, &num, &total);
+    mu_assert_int_eq(0, num);
+    mu_assert_double_eq(0, total);
+    free(ids);
+    g_free(h);
+}
+
+MU_TEST(test_g_spanning_forest_random) {
+    /*  both pick the same edges, with many equal (and negative) weights to
+        break ties on; large enough to be radix sorted */
+    graph_id_t i, num_k, num_b;
+    unsigned long long state = 5;
+    __add_vertices(g, 3000);
+    for (i = 0; i < 70000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % 3000, (graph_id_t)(state >> 45) % 3000, (int)(state >> 58) - 32);
+    }
+    double total_k, total_b;
+    graph_id_t* k = g_kruskal(g, __int_weight, &num_k, &total_k);
+    graph_id_t* b = g_boruvka(g, __int_weight, &num_b, &total_b);
+    mu_assert_int_eq(num_k, num_b);
+    mu_assert_double_eq(total_k, total_b);
+
+    graph_id_t num_components;
+    graph_id_t* comps = g_connected_components(g, &num_components, NULL);
+    mu_assert_int_eq(3000 - num_components, num_k);
+
+    char* picked = (char*)calloc(70000, sizeof(char));
+    graph_id_t wrong = 0;
+    for (i = 0; i < num_k; i++)
+        picked[k[i]] = 1;
+    for (i = 0; i < num_b; i++)
+        wrong += (picked[b[i]] != 1);
+    mu_assert_int_eq(0, wrong);
+    free(picked);
+    free(comps);
+    free(k);
+    free(b);
+}
+
+/*******************************************************************************
+*   Test triangles and cores
+*******************************************************************************/
+MU_TEST(test_g_triangles) {
+    __add_weighted_graph(g);
+    __add_edge(g, 1, 0, 0);  /* repeated the other way */
+    __add_edge(g, 2, 2, 0);  /* self loop */
+    unsigned long long total = 0;
+    unsigned long long* counts = g_triangles(g, &total);
+    unsigned long long expected[] = {1, 2, 2, 1, 0, 0};
+    graph_id_t i;
+    mu_check(total == 2);
+    for (i = 0; i < 6; i++)
+        mu_check(counts[i] == expected[i]);
+    free(counts);
+
+    /* every vertex of a 5 clique is in 6 triangles */
+    graph_t h = g_init();
+    graph_id_t j;
+    __add_vertices(h, 5);
+    for (i = 0; i < 5; i++)
+        for (j = i + 1; j < 5; j++)
+            __add_edge(h, i, j, 0);
+    counts = g_triangles(h, NULL);
+    for (i = 0; i < 5; i++)
+        mu_check(counts[i] == 6);
+    free(counts);
+    g_free(h);
+}
+
+MU_TEST(test_g_core_numbers) {
+    __add_weighted_graph(g);
+    __add_edge(g, 3, 2, 0);  /* repeated the other way */
+    __add_edge(g, 4, 4, 0);  /* self loop */
+    unsigned int max_core = 0;
+    unsigned int* core = g_core_numbers(g, &max_core);
+    graph_id_t expected[] = {2, 2, 2, 2, 1, 0};
+    graph_id_t i, j;
+    mu_assert_int_eq(2, max_core);
+    for (i = 0; i < 6; i++)
+        mu_assert_int_eq(expected[i], core[i]);
+    free(core);
+
+    /* a 5 clique with a tail; removed vertices are 0 */
+    graph_t h = g_init();
+    __add_vertices(h, 8);
+    for (i = 0; i < 5; i++)
+        for (j = i + 1; j < 5; j++)
+            __add_edge(h, j, i, 0);
+    __add_edge(h, 4, 5, 0);
+    __add_edge(h, 5, 6, 0);
+    g_vertex_free(g_vertex_remove(h, 7));
+    core = g_core_numbers(h, &max_core);
+    graph_id_t expected_h[] = {4, 4, 4, 4, 4, 1, 1, 0};
+    mu_assert_int_eq(4, max_core);
+    for (i = 0; i < 8; i++)
+        mu_assert_int_eq(expected_h[i], core[i]);
+    free(core);
+    g_free(h);
+}
+
+MU_TEST(test_g_triangles_cores_random) {
+    const graph_id_t n = 120;
+    unsigned long long state = 11;
+    graph_id_t i, j, k;
+    __add_vertices(g, n);
+    for (i = 0; i < 1500; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % n, (graph_id_t)(state >> 13) % n, 0);
+    }
+
+    /* triangles match checking every triple of the undirected bit matrix */
+    graph_bitmatrix_t m = g_bitmatrix_init(g, true);
+    unsigned long long total = 0, check = 0;
+    unsigned long long* counts = g_triangles(g, &total);
+    for (i = 0; i < n; i++) {
+        unsigned long long found = 0;
+        for (j = 0; j < n; j++)
+            for (k = j + 1; k < n; k++)
+                found += i != j && i != k && g_bitmatrix_edge_exists(m, i, j) && g_bitmatrix_edge_exists(m, i, k) && g_bitmatrix_edge_exists(m, j, k);
+        mu_check(found == counts[i]);
+        check += found;
+    }
+    mu_check(total > 0);
+    mu_check(check == 3 * total);
+    mu_check(total == g_bitmatrix_triangles(m));
+    free(counts);
+
+    /* cores match removing a vertex with the fewest neighbors left one at a time */
+    unsigned int* core = g_core_numbers(g, NULL);
+    unsigned int left[120];
+    char done[120];
+    graph_id_t level = 0;
+    for (i = 0; i < n; i++) {
+        left[i] = g_bitmatrix_degree(m, i) - g_bitmatrix_edge_exists(m, i, i);
+        done[i] = 0;
+    }
+    for (k = 0; k < n; k++) {
+        graph_id_t v = GRAPH_INVALID_ID;
+        for (i = 0; i < n; i++)
+            if (!done[i] && (v == GRAPH_INVALID_ID || left[i] < left[v]))
+                v = i;
+        if (left[v] > level)
+            level = left[v];
+        mu_assert_int_eq(level, core[v]);
+        done[v] = 1;
+        for (i = 0; i < n; i++)
+            if (!done[i] && i != v && g_bitmatrix_edge_exists(m, v, i))
+                left[i]--;
+    }
+    free(core);
+    g_bitmatrix_free(m);
+}
+
+/*******************************************************************************
+*   Test subgraphs and partitioning
+*******************************************************************************/
+MU_TEST(test_g_subgraph) {
+    __add_weighted_graph(g);
+    double* score = g_vertex_prop_double(g, "score");
+    unsigned int* hops = g_edge_prop_uint(g, "hops");
+    graph_id_t i;
+    for (i = 0; i < 6; i++)
+        score[i] = 0.5 * i;
+    for (i = 0; i < 6; i++)
+        hops[i] = 10 + i;
+
+    /* the edges between 3, 1 and 2, numbered in that order of their sources */
+    graph_id_t ids[] = {3, 1, 2};
+    graph_t sub = g_subgraph(g, ids, 3);
+    mu_assert_int_eq(3, g_num_vertices(sub));
+    mu_assert_int_eq(3, g_num_edges(sub));
+    graph_id_t src[] = {1, 2, 2};
+    graph_id_t dest[] = {0, 1, 0};
+    int weights[] = {1, 2, 5};
+    unsigned int from[] = {3, 2, 4};
+    score = g_vertex_prop_double(sub, "score");
+    hops = g_edge_prop_uint(sub, "hops");
+    for (i = 0; i < 3; i++) {
+        edge_t e = g_edge_get(sub, i);
+        mu_assert_int_eq(src[i], g_edge_src(e));
+        mu_assert_int_eq(dest[i], g_edge_dest(e));
+        mu_assert_int_eq(weights[i], *(int*)g_edge_metadata(e));
+        mu_assert_int_eq(10 + from[i], hops[i]);
+        mu_assert_int_eq(ids[i], *(int*)g_vertex_metadata(g_vertex_get(sub, i)));
+        mu_assert_double_eq(0.5 * ids[i], score[i]);
+    }
+    g_free_alt(sub, false);
+
+    /* every id must have a vertex and be listed once */
+    graph_id_t repeated[] = {1, 2, 1};
+    graph_id_t missing[] = {1, 6};
+    mu_check(g_subgraph(g, repeated, 3) == NULL);
+    mu_check(g_subgraph(g, missing, 2) == NULL);
+    sub = g_subgraph(g, ids, 0);
+    mu_assert_int_eq(0, g_num_vertices(sub));
+    g_free(sub);
+}
+
+MU_TEST(test_g_partition) {
+    /* two cliques joined by a single edge come apart */
+    graph_id_t i, j;
+    __add_vertices(g, 20);
+    for (i = 0; i < 10; i++) {
+        for (j = 0; j < 10; j++) {
+            if (i != j) {
+                __add_edge(g, i, j, 0);
+                __add_edge(g, 10 + i, 10 + j, 0);
+            }
+        }
+    }
+    __add_edge(g, 9, 10, 0);
+    size_t cut = 0;
+    double balance = 0.0;
+    graph_id_t* parts = g_partition(g, 2, &cut, &balance);
+    mu_check(cut == 1);
+    mu_assert_double_eq(1.0, balance);
+    for (i = 1; i < 10; i++) {
+        mu_assert_int_eq(parts[0], parts[i]);
+        mu_assert_int_eq(parts[10], parts[10 + i]);
+    }
+    mu_check(parts[0] != parts[10]);
+    free(parts);
+    mu_check(g_partition(g, 0, &cut, &balance) == NULL);
+
+    /* a grid cuts far fewer edges than dealing out the ids would (760) */
+    graph_t h = g_generate_grid(20, 20);
+    parts = g_partition(h, 4, &cut, &balance);
+    size_t check = 0, sizes[4] = {0, 0, 0, 0};
+    for (i = 0; i < 400; i++) {
+        vertex_t v = g_vertex_get(h, i);
+        edge_t e;
+        unsigned int k;
+        mu_check(parts[i] < 4);
+        sizes[parts[i]]++;
+        g_iterate_edges(v, e, k)
+            check += parts[i] != parts[g_edge_dest(e)];
+    }
+    mu_check(cut == check);
+    mu_check(cut < 760 / 2);
+    mu_check(balance <= 1.03 + 1e-9);
+    for (i = 0; i < 4; i++)
+        mu_check(sizes[i] <= 103);
+    free(parts);
+
+    /* ids without a vertex have no part */
+    g_vertex_free(g_vertex_remove(h, 7));
+    parts = g_partition_alt(h, 3, 0.0, 5, NULL, &balance);
+    mu_check(parts[7] == GRAPH_INVALID_ID);
+    mu_check(balance <= 399.0 / 3 / 133 + 1e-9);
+    free(parts);
+    g_free(h);
+}
+
+/*******************************************************************************
+*   Test compaction and ordering
+*******************************************************************************/
+MU_TEST(test_g_compact) {
+    __add_vertices(g, 10);
+    __add_edge(g, 1, 3, 0);
+    __add_edge(g, 3, 9, 1);
+    __add_edge(g, 9, 1, 2);
+    __add_edge(g, 5, 5, 3);
+    g_vertex_free(g_vertex_remove(g, 0));
+    g_vertex_free(g_vertex_remove(g, 2));
+    g_vertex_free(g_vertex_remove(g, 4));
+
+    graph_id_t* map = g_compact(g);
+    graph_id_t expected[] = {GRAPH_INVALID_ID, 0, GRAPH_INVALID_ID, 1, GRAPH_INVALID_ID, 2, 3, 4, 5, 6};
+    graph_id_t i;
+    for (i = 0; i < 10; i++)
+        mu_assert_int_eq(expected[i], map[i]);
+    free(map);
+
+    mu_assert_int_eq(7, g_num_vertices(g));
+    mu_assert_int_eq(7, g_vertices_inserted(g));
+    for (i = 0; i < 7; i++)
+        mu_assert_int_eq(i, g_vertex_id(g_vertex_get(g, i)));
+    mu_assert_int_eq(3, *(int*)g_vertex_metadata(g_vertex_get(g, 1)));
+
+    /* edge ids stay the same */
+    mu_assert_int_eq(0, g_edge_src(g_edge_get(g, 0)));
+    mu_assert_int_eq(1, g_edge_dest(g_edge_get(g, 0)));
+    mu_assert_int_eq(6, g_edge_dest(g_edge_get(g, 1)));
+    mu_assert_int_eq(2, g_edge_src(g_edge_get(g, 3)));
+
+    /* new vertices are added after the compacted ones */
+    mu_assert_int_eq(7, g_vertex_id(g_vertex_add(g, NULL)));
+}
+
+MU_TEST(test_g_compact_alt_degree) {
+    __add_vertices(g, 5);
+    __add_edge(g, 3, 0, 0);
+    __add_edge(g, 3, 1, 0);
+    __add_edge(g, 3, 2, 0);
+    __add_edge(g, 4, 3, 0);
+
+    graph_id_t* order = g_order_degree(g);
+    graph_id_t expected[] = {3, 0, 1, 2, 4};
+    graph_id_t i;
+    for (i = 0; i < 5; i++)
+        mu_assert_int_eq(expected[i], order[i]);
+
+    /* orders that miss or repeat a vertex are rejected */
+    graph_id_t bad[] = {3, 0, 1, 2, 3};
+    mu_assert_null(g_compact_alt(g, bad));
+    mu_assert_int_eq(0, *(int*)g_vertex_metadata(g_vertex_get(g, 0)));
+
+    /* the hash index is rebuilt on the new ids */
+    mu_check(g_edge_index(g, GRAPH_EDGE_INDEX_HASH));
+    graph_id_t* map = g_compact_alt(g, order);
+    mu_assert_int_eq(0, map[3]);
+    mu_assert_int_eq(4, map[4]);
+    mu_check(g_edge_find(g, 0, 2) == g_edge_get(g, 1));
+    mu_assert_null(g_edge_find(g, 3, 1));
+    mu_assert_int_eq(3, *(int*)g_vertex_metadata(g_vertex_get(g, 0)));
+    mu_assert_int_eq(3, g_vertex_num_edges_out(g_vertex_get(g, 0)));
+    mu_assert_int_eq(0, g_edge_dest(g_edge_get(g, 3)));
+    free(map);
+    free(order);
+}
+
+MU_TEST(test_g_order_bfs_rcm) {
+    /* a path with shuffled ids */
+    graph_id_t path[] = {3, 7, 0, 9, 5, 1, 8, 2, 6, 4};
+    graph_id_t i;
+    __add_vertices(g, 10);
+    for (i = 0; i < 9; i++)
+        __add_edge(g, path[i], path[i + 1], 0);
+
+    graph_id_t* order = g_order_bfs(g);
+    graph_id_t expected[] = {0, 9, 7, 5, 3, 1, 8, 2, 6, 4};
+    for (i = 0; i < 10; i++)
+        mu_assert_int_eq(expected[i], order[i]);
+    free(order);
+
+    /* starts from the lowest degree vertex (3) and the result is reversed */
+    order = g_order_rcm(g);
+    for (i = 0; i < 10; i++)
+        mu_assert_int_eq(path[9 - i], order[i]);
+
+    free(g_compact_alt(g, order));
+    free(order);
+    for (i = 0; i < 9; i++) {
+        edge_t e = g_edge_get(g, i);
+        mu_assert_int_eq(g_edge_src(e), g_edge_dest(e) + 1);
+    }
+}
+
+
+/*******************************************************************************
+*   Test frozen adjacency and pagerank
+*******************************************************************************/
+MU_TEST(test_g_csr_init) {
+    __add_vertices(g, 5);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 2, 0);
+    __add_edge(g, 3, 2, 0);
+    __add_edge(g, 2, 4, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 4, 0, 0);
+
+    graph_csr_t c = g_csr_init(g);
+    mu_assert_int_eq(5, g_csr_num_vertices(c));
+    mu_assert_int_eq(6, g_csr_num_edges(c));
+    mu_check(g_csr_vertex_exists(c, 4));
+    mu_check(!g_csr_vertex_exists(c, 5));
+
+    unsigned int len;
+    const graph_id_t* n = g_csr_neighbors_out(c, 0, &len);
+    mu_assert_int_eq(2, len);
+    mu_assert_int_eq(1, n[0]);
+    mu_assert_int_eq(2, n[1]);
+    n = g_csr_edge_ids_out(c, 0, &len);
+    mu_assert_int_eq(0, n[0]);
+    mu_assert_int_eq(1, n[1]);
+
+    /* edges in are sorted by the source */
+    n = g_csr_neighbors_in(c, 2, &len);
+    mu_assert_int_eq(3, len);
+    mu_assert_int_eq(0, n[0]);
+    mu_assert_int_eq(1, n[1]);
+    mu_assert_int_eq(3, n[2]);
+    n = g_csr_edge_ids_in(c, 2, &len);
+    mu_assert_int_eq(1, n[0]);
+    mu_assert_int_eq(4, n[1]);
+    mu_assert_int_eq(2, n[2]);
+
+    mu_assert_null(g_csr_neighbors_in(c, 3, &len));
+    mu_assert_int_eq(0, len);
+    mu_assert_null(g_csr_neighbors_out(c, 12, &len));
+    mu_assert_int_eq(0, len);
+    g_csr_free(c);
+}
+
+MU_TEST(test_g_csr_spmv) {
+    __add_weighted_graph(g);
+    double weights[] = {4, 1, 2, 1, 5, 3};
+    double x[] = {1, 2, 3, 4, 5, 6};
+    double y[6];
+    graph_csr_t c = g_csr_init(g);
+
+    g_csr_spmv(c, x, y, NULL);
+    mu_assert_double_eq(0, y[0]);
+    mu_assert_double_eq(4, y[1]);  /* 0 -> 1, 2 -> 1 */
+    mu_assert_double_eq(5, y[3]);  /* 1 -> 3, 2 -> 3 */
+    mu_assert_double_eq(4, y[4]);
+
+    g_csr_spmv(c, x, y, weights);
+    mu_assert_double_eq(10, y[1]);
+    mu_assert_double_eq(17, y[3]);
+    mu_assert_double_eq(12, y[4]);
+    mu_assert_double_eq(0, y[5]);
+    g_csr_free(c);
+}
+
+MU_TEST(test_g_pagerank_cycle) {
+    __add_vertices(g, 4);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    __add_edge(g, 3, 0, 0);
+
+    unsigned int iters, i;
+    double* pr = g_pagerank(g, 0.85, 1e-10, 100, &iters);
+    for (i = 0; i < 4; i++)
+        mu_assert_double_eq(0.25, pr[i]);
+    mu_assert_int_eq(1, iters);
+    free(pr);
+}
+
+MU_TEST(test_g_pagerank) {
+    __add_vertices(g, 6);
+    __add_edge(g, 1, 0, 0);
+    __add_edge(g, 2, 0, 0);
+    __add_edge(g, 3, 0, 0);
+    __add_edge(g, 4, 0, 0);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 4, 3, 0);
+    vertex_t v = g_vertex_remove(g, 5);
+    g_vertex_free(v);
+
+    unsigned int iters, i;
+    double* pr = g_pagerank(g, 0.85, 1e-12, 1000, &iters);
+    double total = 0.0;
+    for (i = 0; i < 6; i++)
+        total += pr[i];
+    mu_assert_double_eq(1.0, total);
+    mu_assert_double_eq(0.0, pr[5]);
+    mu_assert_double_eq(pr[2], pr[4]);
+    mu_check(pr[0] > pr[1]);
+    mu_check(pr[1] > pr[3]);
+    mu_check(pr[3] > pr[4]);
+    mu_check(iters > 1 && iters < 1000);
+    free(pr);
+
+    /* capped at the max iterations */
+    pr = g_pagerank(g, 0.85, 1e-12, 3, &iters);
+    mu_assert_int_eq(3, iters);
+    free(pr);
+}
+
+/*******************************************************************************
+*   Test property columns
+*******************************************************************************/
+MU_TEST(test_g_prop_columns) {
+    __add_weighted_graph(g);
+    double* w = g_edge_prop_double(g, "weight");
+    mu_check(w != NULL);
+    graph_id_t i;
+    for (i = 0; i < g_num_edges(g); i++)
+        mu_assert_double_eq(0, w[i]);
+    for (i = 0; i < g_num_edges(g); i++)
+        w[i] = *(int*)g_edge_metadata(g_edge_get(g, i));
+    w[5] = 1;  /* make 3 -> 4 cheaper */
+
+    /* the same column comes back; another type is an error */
+    mu_check(g_edge_prop_double(g, "weight") == w);
+    mu_check(g_edge_prop_int(g, "weight") == NULL);
+    mu_check(g_edge_prop(g, "weight", 42) == NULL);
+
+    double* dist = g_dijkstra_alt(g, g_vertex_get(g, 2), w, NULL);
+    mu_assert_double_eq(2, dist[1]);
+    mu_assert_double_eq(3, dist[3]);
+    mu_assert_double_eq(4, dist[4]);
+    free(dist);
+
+    /* vertex and edge columns are separate */
+    long long* rank = g_vertex_prop_int(g, "weight");
+    mu_check(rank != NULL);
+    rank[5] = -7;
+    unsigned int* label = g_vertex_prop_uint(g, "label");
+    label[3] = 9;
+
+    /* growing keeps the values and zeroes the new ones */
+    for (i = 0; i < 100; i++)
+        g_vertex_add(g, NULL);
+    label = g_vertex_prop_uint(g, "label");
+    rank = g_vertex_prop_int(g, "weight");
+    mu_assert_int_eq(9, label[3]);
+    mu_assert_int_eq(0, label[105]);
+    mu_check(rank[5] == -7);
+    mu_assert_double_eq(4, g_edge_prop_double(g, "weight")[0]);
+
+    mu_assert_int_eq(true, g_vertex_prop_remove(g, "label"));
+    mu_assert_int_eq(false, g_vertex_prop_remove(g, "label"));
+    mu_assert_int_eq(false, g_edge_prop_remove(g, "label"));
+    mu_assert_int_eq(0, g_vertex_prop_uint(g, "label")[3]);
+    mu_assert_int_eq(true, g_edge_prop_remove(g, "weight"));
+}
+
+MU_TEST(test_g_prop_columns_compact) {
+    __add_vertices(g, 5);
+    __add_edge(g, 1, 3, 0);
+    double* score = g_vertex_prop_double(g, "score");
+    graph_id_t i;
+    for (i = 0; i < 5; i++)
+        score[i] = i * 10;
+    size_t before = g_memory_usage(g);
+    mu_check(g_edge_prop_uint(g, "label") != NULL);
+    mu_check(g_memory_usage(g) > before);
+
+    g_vertex_free(g_vertex_remove(g, 0));
+    g_vertex_free(g_vertex_remove(g, 2));
+    free(g_compact(g));
+
+    score = g_vertex_prop_double(g, "score");
+    mu_assert_double_eq(10, score[0]);
+    mu_assert_double_eq(30, score[1]);
+    mu_assert_double_eq(40, score[2]);
+    mu_assert_int_eq(0, g_edge_prop_uint(g, "label")[0]);
+
+    /* the column follows a reordering too */
+    graph_id_t order[] = {2, 0, 1};
+    free(g_compact_alt(g, order));
+    score = g_vertex_prop_double(g, "score");
+    mu_assert_double_eq(40, score[0]);
+    mu_assert_double_eq(10, score[1]);
+    mu_assert_double_eq(30, score[2]);
+}
+
+/*******************************************************************************
+*   Test snapshot reads
+*******************************************************************************/
+MU_TEST(test_g_snapshots) {
+    __add_vertices(g, 4);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 2, 1);
+    __add_edge(g, 3, 0, 2);
+    mu_check(g_snapshots_enable(g, true));
+
+    unsigned int len, len_in, i, j = 0;
+    vertex_t v = g_vertex_get(g, 0);
+    graph_id_t reader = g_read_begin(g);
+    mu_check(reader != GRAPH_INVALID_ID);
+    const edge_t* es = g_vertex_edges_snapshot(v, &len);
+    const edge_t* ins = g_vertex_edges_in_snapshot(v, &len_in);
+    mu_assert_int_eq(2, len);
+    mu_assert_int_eq(1, len_in);
+
+    /* the reader keeps seeing what it started with */
+    g_edge_retire(g, g_edge_remove(g, 0), true);
+    for (i = 0; i < 20; i++)
+        __add_edge(g, 0, 3, i);
+    g_vertex_retire(g, g_vertex_remove(g, 3), true);
+    mu_assert_int_eq(0, g_reclaim(g));
+    mu_assert_int_eq(1, g_edge_dest(es[0]));
+    mu_assert_int_eq(2, g_edge_dest(es[1]));
+    mu_assert_int_eq(3, g_edge_src(ins[0]));
+    mu_assert_int_eq(2, *(int*)g_edge_metadata(ins[0]));
+    g_read_end(g, reader);
+    mu_check(g_reclaim(g) > 0);
+
+    edge_t e;
+    g_iterate_edges_snapshot(v, es, len, e, i) {
+        mu_assert_int_eq(2, g_edge_dest(e));
+        ++j;
+    }
+    mu_assert_int_eq(1, j);
+    mu_check(g_vertex_edges_in_snapshot(v, &len_in) == NULL);
+    mu_assert_int_eq(0, len_in);
+
+    /* readers are limited; turning snapshots off frees the copies */
+    graph_id_t readers[GRAPH_MAX_READERS];
+    for (i = 0; i < GRAPH_MAX_READERS; i++)
+        readers[i] = g_read_begin(g);
+    mu_check(g_read_begin(g) == GRAPH_INVALID_ID);
+    for (i = 0; i < GRAPH_MAX_READERS; i++)
+        g_read_end(g, readers[i]);
+    mu_check(g_snapshots_enable(g, false));
+    mu_check(g_vertex_edges_snapshot(v, &len) == NULL);
+}
+
+MU_TEST(test_g_snapshots_parallel) {
+    /* one in four iterations updates the graph while the rest read it */
+    __add_vertices(g, 16);
+    mu_check(g_snapshots_enable(g, true));
+
+    int i;
+    graph_id_t wrong = 0;
+    #pragma omp parallel for schedule(dynamic, 1) reduction(+:wrong)
+    for (i = 0; i < 4000; i++) {
+        graph_id_t v = (graph_id_t)(i * 7) % 16;
+        if (i % 4 == 0) {
+            edge_t e = g_edge_add(g, v, (v + 1) % 16, NULL);
+            if (i % 8 == 0)
+                g_edge_retire(g, g_edge_remove(g, g_edge_id(e)), true);
+            continue;
+        }
+        graph_id_t reader = g_read_begin(g);
+        unsigned int len, j;
+        if (reader == GRAPH_INVALID_ID)
+            continue;
+        const edge_t* es;
+        edge_t e;
+        g_iterate_edges_snapshot(g_vertex_get(g, v), es, len, e, j) {
+            wrong += (g_edge_src(e) != v || g_edge_dest(e) != (v + 1) % 16);
+        }
+        g_read_end(g, reader);
+    }
+    mu_assert_int_eq(0, wrong);
+    mu_assert_int_eq(500, g_num_edges(g));
+
+    /* once the readers are done, the snapshots match the graph */
+    g_reclaim(g);
+    unsigned int j, len, total = 0;
+    for (j = 0; j < 16; j++) {
+        g_vertex_edges_snapshot(g_vertex_get(g, j), &len);
+        total += len;
+        g_vertex_edges_in_snapshot(g_vertex_get(g, j), &len);
+        total += len;
+    }
+    mu_assert_int_eq(1000, total);
+}
+
+/*******************************************************************************
+*   Test compressed adjacency
+*******************************************************************************/
+MU_TEST(test_g_compressed_init) {
+    __add_vertices(g, 6);
+    __add_edge(g, 0, 4, 0);
+    __add_edge(g, 0, 1, 1);
+    __add_edge(g, 0, 4, 2);
+    __add_edge(g, 2, 0, 3);
+    __add_edge(g, 3, 0, 4);
+    __add_edge(g, 4, 2, 5);
+    g_vertex_free(g_vertex_remove(g, 5));
+
+    graph_compressed_t c = g_compressed_init(g);
+    mu_assert_int_eq(6, g_compressed_num_vertices(c));
+    mu_assert_int_eq(6, g_compressed_num_edges(c));
+    mu_assert_int_eq(3, g_compressed_degree_out(c, 0));
+    mu_assert_int_eq(2, g_compressed_degree_in(c, 0));
+    mu_assert_int_eq(0, g_compressed_degree_out(c, 5));
+    mu_assert_int_eq(0, g_compressed_degree_in(c, 10));
+
+    /* neighbors come back sorted */
+    graph_id_t res[6];
+    mu_assert_int_eq(3, g_compressed_neighbors_out(c, 0, res, 6));
+    mu_assert_int_eq(1, res[0]);
+    mu_assert_int_eq(4, res[1]);
+    mu_assert_int_eq(4, res[2]);
+    mu_assert_int_eq(2, g_compressed_neighbors_out(c, 0, res, 2));
+    mu_assert_int_eq(0, g_compressed_neighbors_out(c, 10, res, 6));
+
+    graph_compressed_iter_t it;
+    graph_id_t u, sum = 0, num = 0;
+    g_compressed_iterate_in(c, 0, it, u) {
+        sum += u;
+        ++num;
+    }
+    mu_assert_int_eq(2, num);
+    mu_assert_int_eq(5, sum);
+
+    graph_workspace_t w = g_workspace_init(NULL);
+    mu_assert_int_eq(4, g_compressed_breadth_first_traverse(c, 0, w, res, 6));
+    mu_assert_int_eq(0, res[0]);
+    mu_assert_int_eq(1, res[1]);
+    mu_assert_int_eq(4, res[2]);
+    mu_assert_int_eq(2, res[3]);
+    mu_assert_int_eq(2, g_compressed_breadth_first_traverse(c, 0, w, res, 2));
+    mu_assert_int_eq(5, g_compressed_breadth_first_traverse(c, 3, w, res, 6));
+    g_workspace_free(w);
+    g_compressed_free(c);
+}
+
+MU_TEST(test_g_compressed_init_alt) {
+    /* ids far apart take several bytes; edges out of range are skipped */
+    graph_id_t src[] = {0, 0, 0, 70000, 70000, 5, 80000};
+    graph_id_t dest[] = {70000, 3, 200, 0, 70001, 80000, 1};
+    graph_compressed_t c = g_compressed_init_alt(70002, src, dest, 7);
+    mu_assert_int_eq(5, g_compressed_num_edges(c));
+
+    graph_id_t res[4], i, wrong = 0;
+    mu_assert_int_eq(3, g_compressed_neighbors_out(c, 0, res, 4));
+    mu_assert_int_eq(3, res[0]);
+    mu_assert_int_eq(200, res[1]);
+    mu_assert_int_eq(70000, res[2]);
+    mu_assert_int_eq(2, g_compressed_neighbors_out(c, 70000, res, 4));
+    mu_assert_int_eq(0, res[0]);
+    mu_assert_int_eq(70001, res[1]);
+    mu_assert_int_eq(1, g_compressed_neighbors_in(c, 70001, res, 4));
+    mu_assert_int_eq(70000, res[0]);
+    mu_assert_int_eq(0, g_compressed_degree_out(c, 5));
+    g_compressed_free(c);
+
+    /* matches the graph it was built from and takes far less memory */
+    __add_vertices(g, 1000);
+    unsigned long long state = 3;
+    for (i = 0; i < 8000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % 1000, (graph_id_t)(state >> 45) % 1000, 0);
+    }
+    c = g_compressed_init(g);
+    graph_csr_t csr = g_csr_init(g);
+    for (i = 0; i < 1000; i++) {
+        unsigned int len;
+        graph_id_t j, prev = 0, sum = 0;
+        const graph_id_t* n = g_csr_neighbors_in(csr, i, &len);
+        graph_compressed_iter_t it;
+        graph_id_t u;
+        g_compressed_iterate_in(c, i, it, u) {
+            wrong += (u < prev);
+            prev = u;
+            sum += u;
+        }
+        for (j = 0; j < len; j++)
+            sum -= n[j];
+        wrong += (sum != 0) + (len != g_compressed_degree_in(c, i));
+    }
+    mu_assert_int_eq(0, wrong);
+    mu_check(g_compressed_memory_usage(c) * 4 < g_memory_usage(g));
+    g_csr_free(csr);
+    g_compressed_free(c);
+}
+
+/*******************************************************************************
+*   Test dense adjacency (bit matrix)
+*******************************************************************************/
+MU_TEST(test_g_bitmatrix_init) {
+    __add_weighted_graph(g);
+    graph_bitmatrix_t m = g_bitmatrix_init(g, false);
+    mu_assert_int_eq(6, g_bitmatrix_num_vertices(m));
+    mu_assert_int_eq(6, g_bitmatrix_num_edges(m));
+    mu_assert_int_eq(true, g_bitmatrix_edge_exists(m, 0, 1));
+    mu_assert_int_eq(false, g_bitmatrix_edge_exists(m, 1, 0));
+    mu_assert_int_eq(false, g_bitmatrix_edge_exists(m, 0, 6));
+    mu_assert_int_eq(2, g_bitmatrix_degree(m, 2));
+    mu_assert_int_eq(0, g_bitmatrix_degree(m, 5));
+
+    graph_id_t res[6];
+    mu_assert_int_eq(2, g_bitmatrix_neighbors(m, 2, res, 6));
+    mu_assert_int_eq(1, res[0]);
+    mu_assert_int_eq(3, res[1]);
+    mu_assert_int_eq(1, g_bitmatrix_neighbors(m, 2, res, 1));
+    mu_assert_int_eq(1, g_bitmatrix_common_neighbors(m, 0, 2));
+    mu_assert_int_eq(0, g_bitmatrix_triangles(m));
+
+    graph_id_t* dist = g_bitmatrix_bfs(m, 0);
+    graph_id_t expected[] = {0, 1, 1, 2, 3, GRAPH_INVALID_ID};
+    graph_id_t i;
+    for (i = 0; i < 6; i++)
+        mu_assert_int_eq(expected[i], dist[i]);
+    free(dist);
+    mu_check(g_bitmatrix_bfs(m, 6) == NULL);
+
+    /* and back to a graph */
+    graph_t h = g_bitmatrix_to_graph(m);
+    mu_assert_int_eq(6, g_num_vertices(h));
+    mu_assert_int_eq(6, g_num_edges(h));
+    mu_check(g_edge_find(h, 2, 1) != NULL);
+    mu_check(g_edge_find(h, 1, 2) == NULL);
+    g_free(h);
+    g_bitmatrix_free(m);
+
+    m = g_bitmatrix_init(g, true);
+    mu_assert_int_eq(12, g_bitmatrix_num_edges(m));
+    mu_assert_int_eq(true, g_bitmatrix_edge_exists(m, 1, 0));
+    mu_assert_int_eq(2, g_bitmatrix_common_neighbors(m, 0, 3));
+    mu_assert_int_eq(2, g_bitmatrix_triangles(m));
+    mu_check(g_bitmatrix_memory_usage(m) > 6 * sizeof(unsigned long long));
+    g_bitmatrix_free(m);
+}
+
+MU_TEST(test_g_bitmatrix_edges) {
+    graph_bitmatrix_t m = g_bitmatrix_init_alt(200, true);
+    mu_assert_int_eq(false, g_bitmatrix_edge_add(m, 0, 200));
+    mu_assert_int_eq(true, g_bitmatrix_edge_add(m, 3, 130));
+    mu_assert_int_eq(true, g_bitmatrix_edge_add(m, 130, 199));
+    mu_assert_int_eq(true, g_bitmatrix_edge_add(m, 199, 3));
+    mu_assert_int_eq(true, g_bitmatrix_edge_exists(m, 130, 3));
+    mu_assert_int_eq(6, g_bitmatrix_num_edges(m));
+    mu_assert_int_eq(1, g_bitmatrix_triangles(m));
+    mu_assert_int_eq(1, g_bitmatrix_common_neighbors(m, 3, 130));
+
+    mu_assert_int_eq(true, g_bitmatrix_edge_remove(m, 199, 130));
+    mu_assert_int_eq(false, g_bitmatrix_edge_exists(m, 130, 199));
+    mu_assert_int_eq(0, g_bitmatrix_triangles(m));
+    graph_id_t* dist = g_bitmatrix_bfs(m, 130);
+    mu_assert_int_eq(2, dist[199]);
+    mu_check(dist[0] == GRAPH_INVALID_ID);
+    free(dist);
+    g_bitmatrix_free(m);
+
+    mu_check(g_bitmatrix_init_alt(GRAPH_BITMATRIX_MAX_VERTICES + 1, false) == NULL);
+}
+
+MU_TEST(test_g_bitmatrix_random) {
+    const graph_id_t n = 150;
+    unsigned long long state = 7;
+    graph_id_t i, j, k;
+    __add_vertices(g, n);
+    for (i = 0; i < 2000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        __add_edge(g, (graph_id_t)(state >> 33) % n, (graph_id_t)(state >> 13) % n, 0);
+    }
+
+    /* distances match a breadth first search of the graph */
+    graph_bitmatrix_t m = g_bitmatrix_init(g, false);
+    graph_id_t src = 17;
+    graph_id_t* dist = g_bitmatrix_bfs(m, src);
+    graph_id_t* expected = g_multi_source_bfs(g, &src, 1);
+    for (i = 0; i < n; i++)
+        mu_assert_int_eq(expected[i], dist[i]);
+    free(dist);
+    free(expected);
+    g_bitmatrix_free(m);
+
+    /* triangles match checking every triple */
+    m = g_bitmatrix_init(g, true);
+    unsigned long long triangles = 0;
+    for (i = 0; i < n; i++)
+        for (j = i + 1; j < n; j++)
+            for (k = j + 1; k < n; k++)
+                triangles += g_bitmatrix_edge_exists(m, i, j) && g_bitmatrix_edge_exists(m, i, k) && g_bitmatrix_edge_exists(m, j, k);
+    mu_check(triangles > 0);
+    mu_check(triangles == g_bitmatrix_triangles(m));
+    g_bitmatrix_free(m);
+}
+
+/*******************************************************************************
+*   Test saving and loading
+*******************************************************************************/
+MU_TEST(test_g_save_load) {
+    __add_vertices(g, 6);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 0, 2, 1);
+    __add_edge(g, 2, 4, 2);
+    __add_edge(g, 3, 0, 3);
+    __add_edge(g, 5, 4, 4);
+    __add_edge(g, 4, 1, 5);
+    edge_t e = g_edge_remove(g, 2);
+    g_edge_free(e);
+    vertex_t v = g_vertex_remove(g, 5);
+    g_vertex_free(v);
+
+    mu_check(g_save(g, "./graph_test.bin"));
+    graph_t l = g_load("./graph_test.bin");
+    remove("./graph_test.bin");
+
+    mu_assert_int_eq(5, g_num_vertices(l));
+    mu_assert_int_eq(4, g_num_edges(l));
+    mu_assert_null(g_vertex_get(l, 5));
+    mu_assert_null(g_edge_get(l, 2));
+    mu_assert_null(g_edge_get(l, 4));
+
+    e = g_edge_get(l, 3);
+    mu_assert_int_eq(3, g_edge_src(e));
+    mu_assert_int_eq(0, g_edge_dest(e));
+    mu_assert_null(g_edge_metadata(e));
+
+    v = g_vertex_get(l, 0);
+    mu_assert_int_eq(2, g_vertex_num_edges_out(v));
+    mu_assert_int_eq(1, g_vertex_num_edges_in(v));
+    mu_assert_int_eq(1, g_edge_dest(g_vertex_edge(v, 0)));
+    mu_assert_int_eq(2, g_edge_dest(g_vertex_edge(v, 1)));
+    mu_assert_int_eq(2, g_vertex_num_edges_in(g_vertex_get(l, 1)));
+
+    /* new edges pick up after the saved ids */
+    e = g_edge_add(l, 1, 2, NULL);
+    mu_assert_int_eq(6, g_edge_id(e));
+    g_free(l);
+}
+
+MU_TEST(test_g_save_load_metadata) {
+    g_vertex_add(g, __str_duplicate("a"));
+    g_vertex_add(g, __str_duplicate("bb"));
+    g_vertex_add(g, NULL);
+    g_edge_add(g, 0, 1, __str_duplicate("a-bb"));
+    g_edge_add(g, 1, 2, NULL);
+    g_edge_add(g, 2, 0, __str_duplicate("-a"));
+
+    mu_check(g_save_alt(g, "./graph_test.bin", __str_serialize, __str_serialize));
+
+    /* use it right from the mapped file */
+    graph_csr_t c = g_csr_load("./graph_test.bin");
+    size_t len;
+    mu_assert_int_eq(3, g_csr_num_vertices(c));
+    mu_assert_int_eq(3, g_csr_num_edges(c));
+    mu_assert_string_eq("bb", (const char*)g_csr_vertex_metadata(c, 1, &len));
+    mu_assert_int_eq(3, len);
+    mu_assert_null(g_csr_vertex_metadata(c, 2, &len));
+    mu_assert_string_eq("-a", (const char*)g_csr_edge_metadata(c, 2, &len));
+    mu_assert_null(g_csr_edge_metadata(c, 1, &len));
+
+    unsigned int num;
+    const graph_id_t* n = g_csr_neighbors_in(c, 0, &num);
+    mu_assert_int_eq(1, num);
+    mu_assert_int_eq(2, n[0]);
+    g_csr_free(c);
+
+    graph_t l = g_load_alt("./graph_test.bin", __str_deserialize, __str_deserialize);
+    remove("./graph_test.bin");
+    mu_assert_string_eq("a", (char*)g_vertex_metadata(g_vertex_get(l, 0)));
+    mu_assert_string_eq("bb", (char*)g_vertex_metadata(g_vertex_get(l, 1)));
+    mu_assert_null(g_vertex_metadata(g_vertex_get(l, 2)));
+    mu_assert_string_eq("a-bb", (char*)g_edge_metadata(g_edge_get(l, 0)));
+    mu_assert_null(g_edge_metadata(g_edge_get(l, 1)));
+    mu_assert_string_eq("-a", (char*)g_edge_metadata(g_edge_get(l, 2)));
+    g_free(l);
+}
+
+MU_TEST(test_g_load_errors) {
+    mu_assert_null(g_load("./this-file-does-not-exist.bin"));
+    mu_assert_null(g_csr_load("./this-file-does-not-exist.bin"));
+
+    FILE* fp = fopen("./graph_test.bin", "wb");
+    fprintf(fp, "src dest\n0 1\n1 2\n");
+    fclose(fp);
+    mu_assert_null(g_load("./graph_test.bin"));
+    remove("./graph_test.bin");
+
+    /*  a saved graph with one value changed: the header is 64 bytes and each
+        array is padded to 8 bytes; 4 vertices so offsets, targets and edge ids
+        each take 5, 3 and 3 ids */
+    __add_vertices(g, 4);
+    __add_edge(g, 0, 1, 0);
+    __add_edge(g, 1, 2, 0);
+    __add_edge(g, 2, 3, 0);
+    mu_check(g_save(g, "./graph_test.bin"));
+    fp = fopen("./graph_test.bin", "rb");
+    unsigned char data[1024];
+    size_t size = fread(data, 1, sizeof(data), fp);
+    fclose(fp);
+    unsigned int len;
+    graph_csr_t c = g_csr_load("./graph_test.bin");  /* unchanged it loads */
+    mu_assert_int_eq(2, g_csr_neighbors_out(c, 1, &len)[0]);
+    g_csr_free(c);
+    size_t ids = sizeof(graph_id_t);
+    size_t offsets = 64 + 8, targets = offsets + ((5 * ids + 7) & ~7u), edge_ids = targets + ((3 * ids + 7) & ~7u);
+    size_t at[] = {offsets + ids, targets, edge_ids + ids, 24, 32};
+    graph_id_t values[] = {100, 50, 0, GRAPH_INVALID_ID, GRAPH_INVALID_ID - 1};
+    int i;
+    for (i = 0; i < 5; i++) {
+        unsigned char patched[1024];
+        memcpy(patched, data, size);
+        if (at[i] < 64) {  /* the counts in the header are 64 bits */
+            unsigned long long value = values[i];
+            memcpy(patched + at[i], &value, sizeof(value));
+        } else {
+            memcpy(patched + at[i], &values[i], ids);
+        }
+        fp = fopen("./graph_test.bin", "wb");
+        fwrite(patched, 1, size, fp);
+        fclose(fp);
+        mu_assert_null(g_csr_load("./graph_test.bin"));
+        mu_assert_null(g_load("./graph_test.bin"));
+    }
+    remove("./graph_test.bin");
+}
+
+MU_TEST(test_g_load_edge_list) {
+    FILE* fp = fopen("./graph_test.txt", "w");
+    fprintf(fp, "# a comment\n0 1 4\n0\t2\t0.3\n\n%% another comment\n2,1,2e1\r\n1 3\nnot an edge\n99999999999999999999 1\n3 5 -0.25");
+    fclose(fp);
+
+    double* weights;
+    graph_t l = g_load_edge_list("./graph_test.txt", NULL, &weights);
+    remove("./graph_test.txt");
+    mu_assert_int_eq(6, g_num_vertices(l));
+    mu_assert_int_eq(5, g_num_edges(l));
+    mu_assert_int_eq(0, g_vertex_num_edges_in(g_vertex_get(l, 4)));
+
+    graph_id_t src[] = {0, 0, 2, 1, 3};
+    graph_id_t dest[] = {1, 2, 1, 3, 5};
+    double w[] = {4, 0.3, 20, 1, -0.25};
+    graph_id_t i;
+    for (i = 0; i < 5; ++i) {
+        edge_t e = g_edge_get(l, i);
+        mu_assert_int_eq(src[i], g_edge_src(e));
+        mu_assert_int_eq(dest[i], g_edge_dest(e));
+        mu_assert_double_eq(w[i], weights[i]);
+    }
+    mu_check(weights[1] == 0.3);  /* rounded the same as strtod */
+    free(weights);
+    g_free(l);
+}
+
+MU_TEST(test_g_load_edge_list_undirected) {
+    FILE* fp = fopen("./graph_test.txt", "w");
+    fprintf(fp, "1 2\n2 3\n0 3\n");
+    fclose(fp);
+
+    graph_edge_list_options opts;
+    opts.undirected = true;
+    opts.one_based = true;
+    graph_t l = g_load_edge_list("./graph_test.txt", &opts, NULL);
+    remove("./graph_test.txt");
+    mu_assert_int_eq(3, g_num_vertices(l));
+    mu_assert_int_eq(4, g_num_edges(l));  /* the 0 based line is dropped */
+    mu_assert_int_eq(0, g_edge_src(g_edge_get(l, 0)));
+    mu_assert_int_eq(1, g_edge_dest(g_edge_get(l, 0)));
+    mu_assert_int_eq(1, g_edge_src(g_edge_get(l, 2)));
+    mu_assert_int_eq(0, g_edge_dest(g_edge_get(l, 2)));
+    mu_assert_int_eq(2, g_vertex_num_edges_out(g_vertex_get(l, 1)));
+    g_free(l);
+
+    mu_assert_null(g_load_edge_list("./this-file-does-not-exist.txt", NULL, NULL));
+}
+
+/*******************************************************************************
+*   Test change log
+*******************************************************************************/
+MU_TEST(test_g_log) {
+    remove("./graph_test.bin");
+    remove("./graph_test.log");
+
+    /* nothing saved yet is an empty graph */
+    graph_t l = g_log_load_alt("./graph_test.bin", "./graph_test.log", __str_deserialize, __str_deserialize);
+    mu_assert_int_eq(0, g_num_vertices(l));
+    graph_log_t log = g_log_open_alt(l, "./graph_test.bin", "./graph_test.log", __str_serialize, __str_serialize, 0);
+    mu_check(log != NULL);
+    mu_check(g_log_open(l, "./graph_test.bin", "./graph_test.log") == NULL);  /* one at a time */
+    g_vertex_add(l, __str_duplicate("a"));
+    g_vertex_add(l, __str_duplicate("bb"));
+    g_vertex_add(l, NULL);
+    g_vertex_add_alt(l, 5, __str_duplicate("f"));
+    g_edge_add(l, 0, 1, __str_duplicate("a-bb"));
+    g_edge_add(l, 1, 2, NULL);
+    graph_id_t src[] = {2, 5, 0};
+    graph_id_t dest[] = {0, 1, 5};
+    void* md[] = {NULL, NULL, NULL};
+    md[1] = __str_duplicate("f-bb");
+    mu_assert_int_eq(3, g_edges_add_batch(l, src, dest, md, 3));
+    g_edge_free(g_edge_remove(l, 1));
+    g_vertex_free(g_vertex_remove(l, 2));
+    mu_check(g_log_flush(log));
+    size_t size = g_log_size(log);
+    mu_check(g_log_close(log));
+
+    /* only the log was written */
+    graph_t r = g_log_load_alt("./graph_test.bin", "./graph_test.log", __str_deserialize, __str_deserialize);
+    mu_check(__same_graph(l, r));
+    mu_assert_int_eq(3, g_num_vertices(r));
+    mu_assert_string_eq("bb", (char*)g_vertex_metadata(g_vertex_get(r, 1)));
+    mu_assert_string_eq("f", (char*)g_vertex_metadata(g_vertex_get(r, 5)));
+    mu_assert_string_eq("a-bb", (char*)g_edge_metadata(g_edge_get(r, 0)));
+    mu_assert_null(g_edge_metadata(g_edge_get(r, 4)));
+    mu_assert_int_eq(3, g_num_edges(r));
+    mu_assert_string_eq("f-bb", (char*)g_edge_metadata(g_edge_get(r, 3)));
+    mu_assert_int_eq(5, g_edge_id(g_edge_add(r, 5, 5, NULL)));
+    g_free(r);
+
+    /* a complete log is appended to; compacting starts it over */
+    log = g_log_open_alt(l, "./graph_test.bin", "./graph_test.log", __str_serialize, __str_serialize, 0);
+    mu_check(g_log_size(log) == size);
+    g_edge_add(l, 5, 0, __str_duplicate("f-a"));
+    mu_check(g_log_size(log) > size);
+    mu_check(g_log_compact(log));
+    mu_check(g_log_size(log) < size);
+    g_vertex_add(l, __str_duplicate("g"));
+    g_edge_add(l, 6, 6, NULL);
+    g_edge_free(g_edge_remove(l, 0));
+    mu_check(g_log_close(log));
+
+    r = g_log_load_alt("./graph_test.bin", "./graph_test.log", __str_deserialize, __str_deserialize);
+    mu_check(__same_graph(l, r));
+    mu_assert_string_eq("g", (char*)g_vertex_metadata(g_vertex_get(r, 6)));
+    g_free(r);
+
+    /* replaying the old log again changes nothing */
+    r = g_log_load_alt("./graph_test.bin", "./graph_test.log", __str_deserialize, __str_deserialize);
+    mu_check(g_log_replay_alt(r, "./graph_test.log", __str_deserialize, __str_deserialize));
+    mu_check(__same_graph(l, r));
+    g_free(r);
+    remove("./graph_test.bin");
+    remove("./graph_test.log");
+    g_free(l);
+}
+
+MU_TEST(test_g_log_recovery) {
+    remove("./graph_test.bin");
+    remove("./graph_test.log");
+    __add_weighted_graph(g);
+    graph_log_t log = g_log_open_alt(g, "./graph_test.bin", "./graph_test.log", NULL, NULL, 128);
+    size_t size = g_log_size(log);  /* started from a snapshot */
+    graph_id_t i;
+    for (i = 0; i < 10; i++)
+        __add_edge(g, i % 6, (i * 7) % 6, 0);
+    mu_check(g_log_checkpoint(log));
+    mu_check(g_log_size(log) > size);
+    for (i = 0; i < 20; i++)
+        __add_edge(g, i % 6, (i * 5) % 6, 0);
+    mu_check(g_log_checkpoint(log));  /* past 128 bytes */
+    mu_check(g_log_size(log) == size);
+    __add_edge(g, 4, 5, 0);
+
+    /* edges added from several threads at once are all recorded */
+    int k;
+    #pragma omp parallel for
+    for (k = 0; k < 200; k++)
+        __add_edge(g, k % 6, (k * 11) % 6, k);
+    mu_check(g_log_close(log));
+
+    /* a record cut short is skipped */
+    FILE* fp = fopen("./graph_test.log", "ab");
+    fputc(3, fp);
+    fputc(9, fp);
+    fclose(fp);
+    graph_t r = g_log_load("./graph_test.bin", "./graph_test.log");
+    mu_check(__same_graph(g, r));
+    g_free(r);
+
+    /* and then the log is started over */
+    log = g_log_open(g, "./graph_test.bin", "./graph_test.log");
+    mu_check(g_log_size(log) == size);
+    g_log_close(log);
+
+    /* compacting renumbers the ids */
+    log = g_log_open(g, "./graph_test.bin", "./graph_test.log");
+    g_vertex_free(g_vertex_remove(g, 1));
+    free(g_compact(g));
+    g_edge_add(g, 4, 0, NULL);
+    g_log_close(log);
+    r = g_log_load("./graph_test.bin", "./graph_test.log");
+    mu_check(__same_graph(g, r));
+    g_free(r);
+
+    /* anything but a log is an error */
+    fp = fopen("./graph_test.log", "wb");
+    fprintf(fp, "src dest\n0 1\n");
+    fclose(fp);
+    mu_assert_null(g_log_load("./graph_test.bin", "./graph_test.log"));
+    mu_check(g_log_replay(g, "./graph_test.log") == false);
+    mu_check(g_log_replay(g, "./this-file-does-not-exist.log") == false);
+    remove("./graph_test.bin");
+    remove("./graph_test.log");
+}
+
+/*******************************************************************************
+*   Test generators
+*******************************************************************************/
+MU_TEST(test_g_generate_erdos_renyi) {
+    graph_t h = g_generate_erdos_renyi(100, 1000, 42);
+    mu_assert_int_eq(100, g_num_vertices(h));
+    mu_assert_int_eq(1000, g_num_edges(h));
+    graph_id_t i, loops = 0;
+    for (i = 0; i < 1000; i++)
+        loops += (g_edge_src(g_edge_get(h, i)) == g_edge_dest(g_edge_get(h, i)));
+    mu_assert_int_eq(0, loops);
+
+    /* the same seed gives the same graph */
+    graph_t k = g_generate_erdos_renyi(100, 1000, 42);
+    graph_id_t same = 0;
+    for (i = 0; i < 1000; i++)
+        same += (g_edge_src(g_edge_get(h, i)) == g_edge_src(g_edge_get(k, i)) && g_edge_dest(g_edge_get(h, i)) == g_edge_dest(g_edge_get(k, i)));
+    mu_assert_int_eq(1000, same);
+    g_free(k);
+    g_free(h);
+}
+
+MU_TEST(test_g_generate_rmat) {
+    graph_t h = g_generate_rmat(10, 8, 1);
+    mu_assert_int_eq(1024, g_num_vertices(h));
+    mu_assert_int_eq(8192, g_num_edges(h));
+
+    /* the skew puts far more than the average number of edges on vertex 0 */
+    mu_check(g_vertex_num_edges_out(g_vertex_get(h, 0)) > 80);
+    g_free(h);
+}
+
+MU_TEST(test_g_generate_grid) {
+    graph_t h = g_generate_grid(3, 4);
+    mu_assert_int_eq(12, g_num_vertices(h));
+    mu_assert_int_eq(34, g_num_edges(h));
+    mu_assert_int_eq(2, g_vertex_num_edges_out(g_vertex_get(h, 0)));
+    mu_assert_int_eq(3, g_vertex_num_edges_out(g_vertex_get(h, 1)));
+    mu_assert_int_eq(4, g_vertex_num_edges_in(g_vertex_get(h, 5)));
+    mu_assert_not_null(g_edge_find(h, 6, 10));
+    mu_assert_null(g_edge_find(h, 3, 4));  /* no wrapping to the next row */
+    g_free(h);
+}
+
+MU_TEST(test_g_generate_power_law) {
+    graph_t h = g_generate_power_law(2000, 3, 5);
+    mu_assert_int_eq(2000, g_num_vertices(h));
+    mu_assert_int_eq(3 * 1997, g_num_edges(h));
+
+    graph_id_t i, max_in = 0, outs = 0;
+    for (i = 0; i < 2000; i++) {
+        vertex_t v = g_vertex_get(h, i);
+        outs += (i >= 3 && g_vertex_num_edges_out(v) == 3);
+        if (g_vertex_num_edges_in(v) > max_in)
+            max_in = g_vertex_num_edges_in(v);
+    }
+    mu_assert_int_eq(1997, outs);
+    mu_check(max_in > 50);  /* hubs form */
+    mu_check(g_memory_usage(h) > g_num_edges(h) * sizeof(void*));
+    g_free(h);
+}
+
+
 /*******************************************************************************
 *    Test Suite Setup
 *******************************************************************************/
@@ -464,12 +2625,29 @@ MU_TEST_SUITE(test_suite) {
     MU_RUN_TEST(test_edge_add_error);
     MU_RUN_TEST(test_edge_remove_error);
     MU_RUN_TEST(test_edge_get_error);
+    MU_RUN_TEST(test_edges_add_remove_parallel);
+    MU_RUN_TEST(test_g_edge_find);
+    MU_RUN_TEST(test_g_edge_find_hash);
+    MU_RUN_TEST(test_g_edge_find_sorted);
+    MU_RUN_TEST(test_g_edge_find_hash_parallel);
+    MU_RUN_TEST(test_g_edge_find_parallel);
     MU_RUN_TEST(test_g_vertex_edge_error);
 
+    /* bulk add edges */
+    MU_RUN_TEST(test_edges_add_batch);
+    MU_RUN_TEST(test_edges_add_batch_after_add);
+    MU_RUN_TEST(test_edges_add_batch_invalid);
+    MU_RUN_TEST(test_edges_add_batch_large);
+
+    /* memory and statistics */
+    MU_RUN_TEST(test_g_stats);
+    MU_RUN_TEST(test_g_shrink_to_fit);
+
     /* Iteration tests */
     MU_RUN_TEST(test_iterate_vertices_all_there);
     MU_RUN_TEST(test_iterate_vertices_some_removed);
     MU_RUN_TEST(test_iterate_edges);
+    MU_RUN_TEST(test_iterate_edges_in);
     MU_RUN_TEST(test_iterate_edges_large);
     MU_RUN_TEST(test_updating_edge_metadata);
     MU_RUN_TEST(test_iterate_edges_some_removed);
@@ -478,6 +2656,91 @@ MU_TEST_SUITE(test_suite) {
     /* Traversals */
     MU_RUN_TEST(test_g_breadth_first_traverse);
     MU_RUN_TEST(test_g_depth_first_traverse);
+    MU_RUN_TEST(test_g_traverse_workspace);
+    MU_RUN_TEST(test_g_multi_source_bfs);
+    MU_RUN_TEST(test_g_multi_source_bfs_batches);
+    MU_RUN_TEST(test_g_shortest_path);
+    MU_RUN_TEST(test_g_shortest_path_random);
+
+    /* weighted shortest paths */
+    MU_RUN_TEST(test_g_dijkstra);
+    MU_RUN_TEST(test_g_dijkstra_alt);
+    MU_RUN_TEST(test_g_dijkstra_unweighted);
+    MU_RUN_TEST(test_g_dijkstra_negative);
+    MU_RUN_TEST(test_g_delta_stepping);
+    MU_RUN_TEST(test_g_delta_stepping_matches_dijkstra);
+
+    /* components */
+    MU_RUN_TEST(test_g_connected_components);
+    MU_RUN_TEST(test_g_connected_components_large);
+    MU_RUN_TEST(test_g_connected_components_empty);
+    MU_RUN_TEST(test_g_strongly_connected_components);
+    MU_RUN_TEST(test_g_strongly_connected_components_deep);
+    MU_RUN_TEST(test_g_topological_sort);
+
+    /* centrality */
+    MU_RUN_TEST(test_g_betweenness_centrality);
+    MU_RUN_TEST(test_g_betweenness_centrality_sampled);
+    MU_RUN_TEST(test_g_closeness_centrality);
+
+    /* spanning trees */
+    MU_RUN_TEST(test_g_kruskal);
+    MU_RUN_TEST(test_g_boruvka);
+    MU_RUN_TEST(test_g_spanning_forest_random);
+
+    /* triangles and cores */
+    MU_RUN_TEST(test_g_triangles);
+    MU_RUN_TEST(test_g_core_numbers);
+    MU_RUN_TEST(test_g_triangles_cores_random);
+
+    /* subgraphs and partitioning */
+    MU_RUN_TEST(test_g_subgraph);
+    MU_RUN_TEST(test_g_partition);
+
+    /* compaction and ordering */
+    MU_RUN_TEST(test_g_compact);
+    MU_RUN_TEST(test_g_compact_alt_degree);
+    MU_RUN_TEST(test_g_order_bfs_rcm);
+
+    /* frozen adjacency */
+    MU_RUN_TEST(test_g_csr_init);
+    MU_RUN_TEST(test_g_csr_spmv);
+    MU_RUN_TEST(test_g_pagerank_cycle);
+    MU_RUN_TEST(test_g_pagerank);
+
+    /* property columns */
+    MU_RUN_TEST(test_g_prop_columns);
+    MU_RUN_TEST(test_g_prop_columns_compact);
+
+    /* snapshot reads */
+    MU_RUN_TEST(test_g_snapshots);
+    MU_RUN_TEST(test_g_snapshots_parallel);
+
+    /* compressed adjacency */
+    MU_RUN_TEST(test_g_compressed_init);
+    MU_RUN_TEST(test_g_compressed_init_alt);
+
+    /* dense adjacency (bit matrix) */
+    MU_RUN_TEST(test_g_bitmatrix_init);
+    MU_RUN_TEST(test_g_bitmatrix_edges);
+    MU_RUN_TEST(test_g_bitmatrix_random);
+
+    /* saving and loading */
+    MU_RUN_TEST(test_g_save_load);
+    MU_RUN_TEST(test_g_save_load_metadata);
+    MU_RUN_TEST(test_g_load_errors);
+    MU_RUN_TEST(test_g_load_edge_list);
+    MU_RUN_TEST(test_g_load_edge_list_undirected);
+
+    /* change log */
+    MU_RUN_TEST(test_g_log);
+    MU_RUN_TEST(test_g_log_recovery);
+
+    /* generators */
+    MU_RUN_TEST(test_g_generate_erdos_renyi);
+    MU_RUN_TEST(test_g_generate_rmat);
+    MU_RUN_TEST(test_g_generate_grid);
+    MU_RUN_TEST(test_g_generate_power_law);
 }
 
 
@@ -511,8 +2774,57 @@ static void  __add_vertices(graph_t g, int num) {
     }
 }
 
-static void __add_edge(graph_t g, unsigned int src, unsigned int dest, int val) {
+static void __add_edge(graph_t g, graph_id_t src, graph_id_t dest, int val) {
     int* q = (int*)calloc(1, sizeof(int));
     *q = val;
     g_edge_add(g, src, dest, q);
 }
+
+static double __int_weight(edge_t e) {
+    return *(int*)g_edge_metadata(e);
+}
+
+static void __add_weighted_graph(graph_t g) {
+    __add_vertices(g, 6);
+    __add_edge(g, 0, 1, 4);
+    __add_edge(g, 0, 2, 1);
+    __add_edge(g, 2, 1, 2);
+    __add_edge(g, 1, 3, 1);
+    __add_edge(g, 2, 3, 5);
+    __add_edge(g, 3, 4, 3);
+}
+
+static const void* __str_serialize(void* metadata, size_t* len) {
+    *len = strlen((char*)metadata) + 1;
+    return metadata;
+}
+
+static void* __str_deserialize(const void* data, size_t len) {
+    char* buf = (char*)malloc(len);
+    memcpy(buf, data, len);
+    return buf;
+}
+
+static bool __stop_at_nine(vertex_t v, void* data) {
+    ++*(graph_id_t*)data;
+    return g_vertex_id(v) != 9;
+}
+
+/* same vertex ids and the same edges, by id, between them */
+static bool __same_graph(graph_t a, graph_t b) {
+    if (g_num_vertices(a) != g_num_vertices(b) || g_num_edges(a) != g_num_edges(b))
+        return false;
+    vertex_t v;
+    edge_t e;
+    graph_id_t i, j;
+    g_iterate_vertices(a, v, i) {
+        if (g_vertex_get(b, i) == NULL)
+            return false;
+        g_iterate_edges(v, e, j) {
+            edge_t f = g_edge_get(b, g_edge_id(e));
+            if (f == NULL || g_edge_src(f) != i || g_edge_dest(f) != g_edge_dest(e))
+                return false;
+        }
+    }
+    return true;
+}